@@ -0,0 +1,158 @@
+#pragma once
+
+#include <alpaka/alpaka.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Run.hpp"
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+
+// Shared implementation of the backend binding modules.
+// Every backend is compiled from this header in its own translation unit, with the
+// alpaka backend chosen through the `alpaka_SELECT_*` compile definition, and only
+// differs in the name of the module and in the backend name reported to Python.
+namespace clue::bindings {
+
+  namespace py = pybind11;
+
+  inline constexpr uint8_t max_dimensions = 10;
+
+  inline void listDevices(const std::string& backend) {
+    const char tab = '\t';
+    const auto devices = clue::DevicePool::devices();
+    if (devices.empty()) {
+      std::cout << "No devices found for the " << backend << " backend." << std::endl;
+      return;
+    } else {
+      std::cout << backend << " devices found: \n";
+      for (auto i = 0u; i < devices.size(); ++i) {
+        std::cout << tab << "device " << i << ": " << alpaka::onHost::getName(devices[i]) << '\n';
+      }
+    }
+  }
+
+  template <typename Kernel>
+  void mainRun(float dc,
+               float rhoc,
+               float dm,
+               float seed_dc,
+               int pPBin,
+               std::vector<uint8_t> wrapped,
+               py::array_t<float> data,
+               py::array_t<int> results,
+               py::array_t<float> rho,
+               py::array_t<float> delta,
+               const Kernel& kernel,
+               int Ndim,
+               int32_t n_points,
+               std::size_t block_size,
+               std::size_t device_id) {
+    auto rData = data.request();
+    auto* pData = static_cast<float*>(rData.ptr);
+    auto rResults = results.request();
+    auto* pResults = static_cast<int*>(rResults.ptr);
+    // the decision graph is only stored when the arrays for it are not empty
+    auto rRho = rho.request();
+    auto rDelta = delta.request();
+    const bool decision_graph = rRho.size > 0 && rDelta.size > 0;
+    auto* pRho = decision_graph ? static_cast<float*>(rRho.ptr) : nullptr;
+    auto* pDelta = decision_graph ? static_cast<float*>(rDelta.ptr) : nullptr;
+
+    // the buffers have been acquired, so the GIL can be released for the rest of the call,
+    // allowing other Python threads to run while the clustering is in progress
+    py::gil_scoped_release release;
+
+    // every calling thread works on its own queue, so concurrent calls don't serialize
+    auto queue = clue::get_queue(device_id);
+
+    // Running the clustering algorithm, instantiated for all the supported dimensions
+    const bool dispatched = [&]<uint8_t... Dims>(std::integer_sequence<uint8_t, Dims...>) {
+      return ((Ndim == Dims + 1 && (::run<Dims + 1, Kernel>(dc,
+                                                            rhoc,
+                                                            dm,
+                                                            seed_dc,
+                                                            pPBin,
+                                                            std::move(wrapped),
+                                                            std::make_tuple(pData, pResults),
+                                                            std::make_tuple(pRho, pDelta),
+                                                            n_points,
+                                                            kernel,
+                                                            queue,
+                                                            block_size),
+                                    true)) ||
+              ...);
+    }(std::make_integer_sequence<uint8_t, max_dimensions>{});
+    if (!dispatched) [[unlikely]] {
+      std::cout << "This library only works up to " << +max_dimensions << " dimensions\n";
+    }
+  }
+
+  inline void writeOutput(py::array_t<float> data,
+                          py::array_t<int> results,
+                          int Ndim,
+                          int32_t n_points,
+                          const std::string& file_path) {
+    auto rData = data.request();
+    auto* pData = static_cast<const float*>(rData.ptr);
+    auto rResults = results.request();
+    auto* pResults = static_cast<const int*>(rResults.ptr);
+
+    py::gil_scoped_release release;
+
+    std::vector<clue::detail::CsvColumn> columns;
+    for (auto dim = 0; dim < Ndim; ++dim) {
+      columns.push_back({"x" + std::to_string(dim), pData + dim * n_points});
+    }
+    columns.push_back({"weight", pData + Ndim * n_points});
+    columns.push_back({"cluster_ids", nullptr, pResults});
+    clue::detail::write_csv_columns(file_path, columns, n_points);
+  }
+
+  template <typename Kernel>
+  void defineMainRun(py::module_& m) {
+    m.def("mainRun",
+          pybind11::overload_cast<float,
+                                  float,
+                                  float,
+                                  float,
+                                  int,
+                                  std::vector<uint8_t>,
+                                  py::array_t<float>,
+                                  py::array_t<int>,
+                                  py::array_t<float>,
+                                  py::array_t<float>,
+                                  const Kernel&,
+                                  int,
+                                  int32_t,
+                                  size_t,
+                                  size_t>(&mainRun<Kernel>),
+          "mainRun");
+  }
+
+  /// @brief Register the functions of a backend module
+  ///
+  /// @param m The module to register the functions in
+  /// @param backend The name of the backend, as used in the Python interface
+  inline void registerBackend(py::module_& m, const char* backend) {
+    m.attr("backend") = backend;
+    m.attr("max_dimensions") = max_dimensions;
+
+    m.def("listDevices",
+          &listDevices,
+          (std::string{"List the available devices for the "} + backend + " backend").c_str());
+    m.def("writeOutput", &writeOutput, "Write the results of the clustering to a CSV file");
+    defineMainRun<clue::FlatKernel>(m);
+    defineMainRun<clue::ExponentialKernel>(m);
+    defineMainRun<clue::GaussianKernel>(m);
+  }
+
+}  // namespace clue::bindings
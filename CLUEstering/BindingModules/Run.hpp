@@ -2,6 +2,8 @@
 #pragma once
 
 #include "CLUEstering/CLUEstering.hpp"
+#include <algorithm>
+#include <tuple>
 #include <vector>
 
 template <uint8_t Ndim, typename Kernel>
@@ -12,6 +14,7 @@ void run(float dc,
          int pPBin,
          std::vector<uint8_t>&& wrapped,
          std::tuple<float*, int*>&& pData,
+         std::tuple<float*, float*>&& pDecisionGraph,
          int32_t n_points,
          const Kernel& kernel,
          clue::concepts::Queue auto queue,
@@ -20,9 +23,15 @@ void run(float dc,
   auto dim=clue::Dim<Ndim>{};
   clue::Clusterer algo(queue, dim, dc, rhoc, dm, seed_dc, pPBin);
   algo.setWrappedCoordinates(std::move(wrapped));
+  const auto [pRho, pDelta] = pDecisionGraph;
+  algo.setDecisionGraph(pRho != nullptr);
   // Create the host and device points
   clue::PointsHost h_points(dim, n_points, std::get<0>(pData), std::get<1>(pData));
   clue::PointsDevice d_points(device,dim, n_points);
 
   algo.make_clusters(queue, h_points, d_points, clue::EuclideanMetric<Ndim>{}, kernel, block_size);
+  if (pRho != nullptr) {
+    std::ranges::copy(h_points.rho(), pRho);
+    std::ranges::copy(h_points.delta(), pDelta);
+  }
 }
@@ -20,42 +20,128 @@ path = dirname(__file__)
 sys.path.insert(1, join(path, 'lib'))
 import CLUE_Convolutional_Kernels as clue_kernels
 import argparse
-backends = []
-
-# CPU Serial
-matches = glob(join(path, "lib", "CLUE_CPU_Serial*.so"))
-cpu_serial_found = bool(matches) and exists(matches[0])
-if cpu_serial_found:
-    import CLUE_CPU_Serial as cpu_serial
-    backends.append("cpu serial")
-
-# CPU TBB
-matches = glob(join(path, "lib", "CLUE_CPU_TBB*.so"))
-tbb_found = bool(matches) and exists(matches[0])
-if tbb_found:
-    import CLUE_CPU_TBB as cpu_tbb
-    backends.append("cpu tbb")
-
-# CPU OpenMP
-matches = glob(join(path, "lib", "CLUE_CPU_OMP*.so"))
-omp_found = bool(matches) and exists(matches[0])
-if omp_found:
-    import CLUE_CPU_OMP as cpu_omp
-    backends.append("cpu openmp")
-
-# GPU CUDA
-matches = glob(join(path, "lib", "CLUE_GPU_CUDA*.so"))
-cuda_found = bool(matches) and exists(matches[0])
-if cuda_found:
-    import CLUE_GPU_CUDA as gpu_cuda
-    backends.append("gpu cuda")
-
-# GPU HIP
-matches = glob(join(path, "lib", "CLUE_GPU_HIP*.so"))
-hip_found = bool(matches) and exists(matches[0])
-if hip_found:
-    import CLUE_GPU_HIP as gpu_hip
-    backends.append("gpu hip")
+import importlib
+# The backend modules found in the lib folder.
+# They are imported the first time they are used, so that importing CLUEstering doesn't
+# pay for loading and initializing the backends that are never run.
+_backend_modules = {
+    "cpu serial": "CLUE_CPU_Serial",
+    "cpu tbb": "CLUE_CPU_TBB",
+    "cpu openmp": "CLUE_CPU_OMP",
+    "gpu cuda": "CLUE_GPU_CUDA",
+    "gpu hip": "CLUE_GPU_HIP",
+}
+_backend_not_found = {
+    "cpu serial": "CPU Serial not found. Please re-compile the library and try again.",
+    "cpu tbb": "TBB module not found. Please re-compile the library and try again.",
+    "cpu openmp": "OpenMP module not found. Please re-compile the library and try again.",
+    "gpu cuda": "CUDA module not found. Please re-compile the library and try again.",
+    "gpu hip": "HIP module not found. Please re-compile the library and try again.",
+}
+backends = [backend for backend, module in _backend_modules.items()
+            if any(exists(match) for match in glob(join(path, "lib", f"{module}*.so")))]
+cpu_serial_found = "cpu serial" in backends
+tbb_found = "cpu tbb" in backends
+omp_found = "cpu openmp" in backends
+cuda_found = "gpu cuda" in backends
+hip_found = "gpu hip" in backends
+_loaded_backends = {}
+
+
+def _load_backend(backend: str):
+    """
+    Return the module implementing a backend, importing it on first use.
+
+    :param backend: Name of the backend.
+    :type backend: str
+
+    :returns: The backend module, or None if the backend has not been compiled.
+    """
+    if backend not in backends:
+        return None
+    if backend not in _loaded_backends:
+        _loaded_backends[backend] = importlib.import_module(_backend_modules[backend])
+    return _loaded_backends[backend]
+
+
+# Minimum number of points from which a backend is preferred by the automatic backend
+# selection, where None excludes the backend from the selection. Small inputs run faster
+# serially, because the parallel backends have to start their thread pools or move the
+# data to the accelerator first.
+# The default values are not measurements, but rough estimates of the sizes at which these
+# costs become negligible, and are only meant to give a sensible order of the backends.
+# They should be replaced with the ones measured on the current machine by running
+# `calibrate_backends`.
+backend_crossover = {
+    "cpu serial": 0,
+    "cpu openmp": 20_000,
+    "cpu tbb": 20_000,
+    "gpu cuda": 200_000,
+    "gpu hip": 200_000,
+}
+
+
+def select_backend(n_points: int) -> str:
+    """
+    Select the backend to use for a given input size, according to the crossover table.
+
+    :param n_points: Number of points to cluster.
+    :type n_points: int
+
+    :returns: The available backend with the largest crossover threshold not exceeding
+              the number of points.
+    :rtype: str
+    """
+    candidates = [(threshold, backend) for backend, threshold in backend_crossover.items()
+                  if backend in backends and threshold is not None and n_points >= threshold]
+    if not candidates:
+        return backends[0]
+    return max(candidates, key=lambda candidate: candidate[0])[1]
+
+
+def calibrate_backends(sizes: Union[list, None] = None, n_dim: int = 2,
+                       repeats: int = 3) -> dict:
+    """
+    Measure the crossover table on the current machine.
+
+    Every available backend clusters blob datasets of increasing size, and each backend
+    is assigned as threshold the smallest size at which it is the fastest one.
+    Backends that are never the fastest get None as threshold, which excludes them
+    from the automatic selection.
+
+    :param sizes: Sizes of the datasets used for the measurement.
+    :type sizes: list[int] or None, optional
+    :param n_dim: Number of dimensions of the datasets. Defaults to 2.
+    :type n_dim: int, optional
+    :param repeats: Number of repetitions of each measurement, of which the fastest is kept.
+    :type repeats: int, optional
+
+    :returns: The measured time in ms, for each size and backend.
+    :rtype: dict
+    """
+    if sizes is None:
+        sizes = [500, 2_000, 10_000, 50_000, 200_000, 1_000_000]
+    timings = {}
+    for size in sizes:
+        clust = clusterer(0.8, 5., 1.)
+        clust.read_data(test_blobs(n_samples=size, n_dim=n_dim))
+        timings[size] = {}
+        for backend in backends:
+            elapsed = []
+            for _ in range(repeats):
+                clust.run_clue(backend=backend)
+                elapsed.append(clust._elapsed_time)
+            timings[size][backend] = min(elapsed)
+
+    fastest = [min(timings[size], key=timings[size].get) for size in sizes]
+    for backend in backends:
+        backend_crossover[backend] = next(
+            (size for size, winner in zip(sizes, fastest) if winner == backend), None)
+    if "cpu serial" in backends:
+        backend_crossover["cpu serial"] = 0
+    return timings
+
+
 def all_backends():
     return backends
 """ The Alpaka3 port currently makes cluster labels dependent on execution order.
@@ -87,7 +173,7 @@ def clue_args() -> argparse.ArgumentParser:
     parser.add_argument(
         "--backend",
         default="cpu serial",
-        choices=["cpu serial", "cpu tbb", "cpu openmp", "gpu cuda", "gpu hip", "all"],
+        choices=["auto", "cpu serial", "cpu tbb", "cpu openmp", "gpu cuda", "gpu hip", "all"],
         help="Backend to use (must be available in your build)",
     )
     parser.add_argument("--dimension", type=list, default = None, help="The dimension that will be used for the clustering algorithm.")
@@ -253,6 +339,11 @@ class cluster_properties:
     :type points_per_cluster: np.ndarray
     :param output_df: DataFrame containing the cluster_ids.
     :type output_df: pd.DataFrame
+    :param rho: Local density of each point, if the decision graph has been stored.
+    :type rho: np.ndarray or None
+    :param delta: Distance of each point from its nearest higher, if the decision graph
+                  has been stored.
+    :type delta: np.ndarray or None
     """
 
     n_clusters : int
@@ -260,6 +351,8 @@ class cluster_properties:
     cluster_points : np.ndarray
     points_per_cluster : np.ndarray
     output_df : pd.DataFrame
+    rho : Union[np.ndarray, None] = None
+    delta : Union[np.ndarray, None] = None
 
     def __eq__(self, other):
         if self.n_clusters != other.n_clusters:
@@ -319,6 +412,8 @@ class clusterer:
         ## Output attributes
         self.clust_prop = None
         self._elapsed_time = 0.
+        ## Backend used by the last clustering
+        self._backend = None
     def set_params(self, dc: float, rhoc: float,
                    dm: [float, None] = None, seed_dc: [float, None] = None, ppbin: int = 128) -> None:
         """
@@ -576,41 +671,14 @@ class clusterer:
         :returns: None
         """
         if backend == "all":
-            if cpu_serial_found:
-                cpu_serial.listDevices('cpu serial')
-            if tbb_found:
-                cpu_tbb.listDevices('cpu tbb')
-            if omp_found:
-                cpu_omp.listDevices('cpu openmp')
-            if cuda_found:
-                gpu_cuda.listDevices('gpu cuda')
-            if hip_found:
-                gpu_hip.listDevices('gpu hip')
-        elif backend == "cpu serial":
-            if cpu_serial_found:
-                cpu_serial.listDevices(backend)
-            else:
-                print("CPU Serial not found. Please re-compile the library and try again.")
-        elif backend == "cpu tbb":
-            if tbb_found:
-                cpu_tbb.listDevices(backend)
+            for available in backends:
+                _load_backend(available).listDevices(available)
+        elif backend in _backend_modules:
+            module = _load_backend(backend)
+            if module is not None:
+                module.listDevices(backend)
             else:
-                print("TBB module not found. Please re-compile the library and try again.")
-        elif backend == "cpu openmp":
-            if omp_found:
-                cpu_omp.listDevices(backend)
-            else:
-                print("OpenMP module not found. Please re-compile the library and try again.")
-        elif backend == "gpu cuda":
-            if cuda_found:
-                gpu_cuda.listDevices(backend)
-            else:
-                print("CUDA module not found. Please re-compile the library and try again.")
-        elif backend == "gpu hip":
-            if hip_found:
-                gpu_hip.listDevices(backend)
-            else:
-                print("HIP module not found. Please re-compile the library and try again.")
+                print(_backend_not_found[backend])
         else:
             raise ValueError("Invalid backend. Allowed choices are: all, cpu serial, cpu tbb, cpu openmp, gpu cuda, gpu hip.")
 
@@ -638,11 +706,14 @@ class clusterer:
                  block_size: int = 1024,
                  device_id: int = 0,
                  verbose: bool = False,
-                 dimensions: Union[list, None] = None) -> None:
+                 dimensions: Union[list, None] = None,
+                 decision_graph: bool = False) -> None:
         """
         Execute the CLUE clustering algorithm.
 
-        :param backend: Backend to use for execution. Defaults to 'cpu serial'.
+        :param backend: Backend to use for execution. With 'auto' the backend is chosen
+                        according to the number of points, using the `backend_crossover`
+                        table. Defaults to 'cpu serial'.
         :type backend: str, optional
         :param block_size: Size of blocks for parallel execution. Defaults to 1024.
         :type block_size: int, optional
@@ -652,6 +723,10 @@ class clusterer:
         :type verbose: bool, optional
         :param dimensions: Optional list of dimensions to consider. Defaults to None.
         :type dimensions: list[int] or None, optional
+        :param decision_graph: If True, stores the local density of each point and its
+                               distance from the nearest higher, which are then available
+                               through `rho` and `delta`. Defaults to False.
+        :type decision_graph: bool, optional
 
         :returns: None
         """
@@ -664,47 +739,27 @@ class clusterer:
             data.n_dim = len(dimensions)
             data.n_points = self.clust_data.n_points
 
+        if backend == "auto":
+            backend = select_backend(data.n_points)
+        elif backend not in _backend_modules:
+            raise ValueError("Invalid backend. Allowed choices are: auto, cpu serial, cpu tbb, "
+                             "cpu openmp, gpu cuda, gpu hip.")
+
+        # empty arrays disable the decision graph
+        n_graph = data.n_points if decision_graph else 0
+        rho = np.zeros(n_graph, dtype=np.float32)
+        delta = np.zeros(n_graph, dtype=np.float32)
+
         start = time.time_ns()
-        if backend == "cpu serial":
-            if cpu_serial_found:
-                cluster_id_is_seed = cpu_serial.mainRun(self._dc, self._rhoc, self._dm, self._seed_dc,
-                                                    self._ppbin, self.wrapped, data.coords, data.results,
-                                                    self._kernel, data.n_dim,
-                                                    data.n_points, block_size, device_id)
-            else:
-                print("CPU Serial not found. Please re-compile the library and try again.")
-        elif backend == "cpu tbb":
-            if tbb_found:
-                cluster_id_is_seed = cpu_tbb.mainRun(self._dc, self._rhoc, self._dm, self._seed_dc,
-                                                     self._ppbin, self.wrapped, data.coords, data.results,
-                                                     self._kernel, data.n_dim,
-                                                     data.n_points, block_size, device_id)
-            else:
-                print("TBB module not found. Please re-compile the library and try again.")
-        elif backend == "cpu openmp":
-            if omp_found:
-                cluster_id_is_seed = cpu_omp.mainRun(self._dc, self._rhoc, self._dm, self._seed_dc,
-                                                     self._ppbin, self.wrapped, data.coords, data.results,
-                                                     self._kernel, data.n_dim,
-                                                     data.n_points, block_size, device_id)
-            else:
-                print("OpenMP module not found. Please re-compile the library and try again.")
-        elif backend == "gpu cuda":
-            if cuda_found:
-                cluster_id_is_seed = gpu_cuda.mainRun(self._dc, self._rhoc, self._dm, self._seed_dc,
-                                                      self._ppbin, self.wrapped, data.coords, data.results,
-                                                      self._kernel, data.n_dim,
-                                                      data.n_points, block_size, device_id)
-            else:
-                print("CUDA module not found. Please re-compile the library and try again.")
-        elif backend == "gpu hip":
-            if hip_found:
-                cluster_id_is_seed = gpu_hip.mainRun(self._dc, self._rhoc, self._dm, self._seed_dc,
-                                                     self._ppbin, self.wrapped, data.coords, data.results,
-                                                     self._kernel, data.n_dim,
-                                                     data.n_points, block_size, device_id)
-            else:
-                print("HIP module not found. Please re-compile the library and try again.")
+        module = _load_backend(backend)
+        if module is not None:
+            module.mainRun(self._dc, self._rhoc, self._dm, self._seed_dc,
+                           self._ppbin, self.wrapped, data.coords, data.results,
+                           rho, delta, self._kernel, data.n_dim,
+                           data.n_points, block_size, device_id)
+            self._backend = backend
+        else:
+            print(_backend_not_found[backend])
 
         finish = time.time_ns()
         cluster_ids = data.results
@@ -722,10 +777,12 @@ class clusterer:
                                              cluster_ids,
                                              np.asarray(cluster_points, dtype=object),
                                              points_per_cluster,
-                                             output_df)
+                                             output_df,
+                                             rho if decision_graph else None,
+                                             delta if decision_graph else None)
         self._elapsed_time = (finish - start) / 1e6
         if verbose:
-            print(f'CLUE executed in {self._elapsed_time} ms')
+            print(f'CLUE executed in {self._elapsed_time} ms with the {backend} backend')
             print(f'Number of clusters found: {self.clust_prop.n_clusters}')
     def run_clue_from_args(self,args):
         return self.run_clue(
@@ -742,7 +799,8 @@ class clusterer:
             block_size: int = 1024,
             device_id: int = 0,
             verbose: bool = False,
-            dimensions: Union[list, None] = None) -> 'Clusterer':
+            dimensions: Union[list, None] = None,
+            decision_graph: bool = False) -> 'Clusterer':
         """
         Run the CLUE clustering algorithm on the input data.
 
@@ -760,6 +818,8 @@ class clusterer:
         :type verbose: bool, optional
         :param dimensions: List of dimensions to consider. If None, all are used.
         :type dimensions: list or None, optional
+        :param decision_graph: If True, stores the data of the decision graph.
+        :type decision_graph: bool, optional
 
         :return: Returns the clusterer object itself.
         :rtype: Clusterer
@@ -768,7 +828,7 @@ class clusterer:
         """
 
         self.read_data(data)
-        self.run_clue(backend, block_size, device_id, verbose, dimensions)
+        self.run_clue(backend, block_size, device_id, verbose, dimensions, decision_graph)
         return self
 
     def fit_predict(self,
@@ -829,6 +889,30 @@ class clusterer:
 
         return self.clust_prop.cluster_ids
 
+    @property
+    def rho(self) -> Union[np.ndarray, None]:
+        """
+        Local density of each point.
+
+        :return: Array of the densities, or None if the decision graph has not been stored.
+        :rtype: np.ndarray or None
+        """
+
+        return self.clust_prop.rho
+
+    @property
+    def delta(self) -> Union[np.ndarray, None]:
+        """
+        Distance of each point from its nearest higher, which together with the density
+        forms the decision graph. The points without a nearest higher have the largest
+        float32 value as distance.
+
+        :return: Array of the distances, or None if the decision graph has not been stored.
+        :rtype: np.ndarray or None
+        """
+
+        return self.clust_prop.delta
+
     @property
     def labels(self) -> np.ndarray:
         """
@@ -1217,6 +1301,15 @@ class clusterer:
         if file_name[-4:] != '.csv':
             file_name += '.csv' 
         out_path = output_folder + file_name
+        if self._backend is not None:
+            # the compiled writer of the backend used for the clustering formats the lines
+            # in parallel, without building a dataframe
+            _load_backend(self._backend).writeOutput(
+                np.ascontiguousarray(self.clust_data.coords, dtype=np.float32),
+                np.ascontiguousarray(self.clust_prop.cluster_ids, dtype=np.int32),
+                self.clust_data.n_dim, self.clust_data.n_points, out_path)
+            return
+
         data = {}
         for i in range(self.clust_data.n_dim):
             data['x' + str(i)] = self.clust_data.coords[i]
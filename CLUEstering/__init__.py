@@ -2,4 +2,7 @@ from CLUEstering.CLUEstering import clusterer
 from CLUEstering.CLUEstering import test_blobs
 from CLUEstering.CLUEstering import backends
 from CLUEstering.CLUEstering import all_backends
+from CLUEstering.CLUEstering import backend_crossover
+from CLUEstering.CLUEstering import select_backend
+from CLUEstering.CLUEstering import calibrate_backends
 __version__ = "2.9.0"
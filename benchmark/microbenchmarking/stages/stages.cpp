@@ -0,0 +1,392 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+#include "utils/generation.hpp"
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+// Benchmarks of the single stages of the clustering, run in the same order and with the same
+// buffers as in Clusterer::make_clusters. Each benchmark runs the stages preceding the one
+// it measures once, outside of the timed loop, and then repeats the measured stage,
+// waiting for the queue at the end of each iteration.
+//
+// The arguments of the benchmarks are the number of points and their density, given as the
+// number of points in each cluster. The clusters are gaussian blobs with unit standard
+// deviation, spread over a domain large enough to keep them apart, so that the number of
+// neighbours of the points grows with the points per cluster and not with their number.
+
+namespace {
+
+  using Queue = ALPAKA_TYPEOF(clue::get_queue(std::declval<clue::Device&>()));
+  using TDev = clue::DevType<Queue>;
+
+  constexpr float noisiness = .1f;
+  constexpr float rhoc = 10.f;
+  constexpr int points_per_tile = 128;
+  constexpr std::size_t block_size = 256;
+
+  // The critical distance grows with the typical distance between the points of a cluster
+  template <std::size_t Ndim>
+  inline float critical_distance() {
+    return std::sqrt(static_cast<float>(Ndim));
+  }
+
+  template <std::size_t Ndim>
+  class StagePipeline {
+  public:
+    StagePipeline(Queue& queue, int32_t n_points, int32_t points_per_cluster)
+        : m_queue{queue},
+          m_hostPoints{clue::Dim<Ndim>{}, n_points},
+          m_devPoints{clue::DevicePool::deviceAt(0U), clue::Dim<Ndim>{}, n_points},
+          m_dc{critical_distance<Ndim>()} {
+      const auto n_clusters = std::max<std::size_t>(
+          static_cast<std::size_t>(n_points * (1 - noisiness) / points_per_cluster), 1);
+      const auto half_width =
+          5.f * static_cast<float>(std::ceil(std::pow(n_clusters, 1. / Ndim)));
+      clue::utils::generateRandomData<Ndim>(
+          m_hostPoints, n_clusters, std::make_pair(-half_width, half_width), 1.f, noisiness);
+    }
+
+    auto size() const { return m_hostPoints.size(); }
+    auto& hostPoints() { return m_hostPoints; }
+
+    void setup_tiles() {
+      clue::detail::setup_tiles(
+          m_queue, m_tiles, m_hostPoints, points_per_tile, m_wrappedCoordinates);
+    }
+    void copy_to_device() { clue::copyToDevice(m_queue, m_devPoints, m_hostPoints); }
+    void copy_to_host() { clue::copyToHost(m_queue, m_hostPoints, m_devPoints); }
+    // Copy back only the results of the clustering, without waiting for the copy
+    void copy_results_to_host() {
+      const auto extent = alpaka::Vec{static_cast<std::size_t>(size())};
+      alpaka::onHost::memcpy(
+          m_queue,
+          alpaka::makeView(alpaka::api::host, m_hostPoints.view().cluster_index, extent),
+          alpaka::makeView(m_queue, m_devPoints.view().cluster_index, extent));
+    }
+    void fill_tiles() { m_tiles->fill(m_queue, m_arena, m_devPoints, size()); }
+    template <typename Kernel, typename DistanceMetric>
+    void local_density(const Kernel& kernel, const DistanceMetric& metric) {
+      auto view = m_devPoints.view();
+      clue::detail::computeLocalDensity(
+          m_queue, frame_spec(), m_tiles->view(), view, kernel, m_dc, metric, size());
+    }
+    template <typename DistanceMetric>
+    void nearest_highers(const DistanceMetric& metric) {
+      auto view = m_devPoints.view();
+      clue::detail::computeNearestHighers(m_queue,
+                                          frame_spec(),
+                                          m_tiles->view(),
+                                          view,
+                                          m_dc,
+                                          metric,
+                                          m_arena,
+                                          m_seedCandidates,
+                                          size());
+    }
+    template <typename DistanceMetric>
+    void find_seeds(const DistanceMetric& metric) {
+      auto view = m_devPoints.view();
+      clue::detail::setup_seeds(m_queue, m_seeds, m_arena, m_seedCandidates);
+      clue::detail::findClusterSeeds(
+          m_queue, frame_spec(), m_seeds.value(), view, m_dc, metric, rhoc, size());
+    }
+    void fill_followers() {
+      clue::detail::setup_followers(m_queue, m_followers, size());
+      m_followers->fill(m_queue, m_devPoints);
+    }
+    void assign_clusters() {
+      clue::detail::assignPointsToClusters(
+          m_queue, block_size, m_seeds.value(), m_followers->view(), m_devPoints.view());
+    }
+    const auto& device_clusters() {
+      return m_followers->clusters(m_queue, m_devPoints, m_seeds->size(m_queue));
+    }
+
+    auto frame_spec() const {
+      const auto n_points = static_cast<std::size_t>(size());
+      return alpaka::onHost::FrameSpec{alpaka::divCeil(n_points, block_size), block_size};
+    }
+
+    // The temporary buffers of the stages are only released at the end of a clustering, so
+    // the arena is reset before repeating a stage which allocates them
+    void reset_arena() { m_arena.reset(); }
+    void wait() { alpaka::onHost::wait(m_queue); }
+
+    enum class Stage {
+      SetupTiles,
+      FillTiles,
+      LocalDensity,
+      NearestHighers,
+      Seeds,
+      Followers,
+      Assignment,
+      Done
+    };
+
+    // Run all the stages preceding the given one, with the default kernel and metric
+    void run_until(Stage stage) {
+      const auto metric = clue::EuclideanMetric<Ndim>{};
+      setup_tiles();
+      copy_to_device();
+      wait();
+      if (stage > Stage::FillTiles) {
+        fill_tiles();
+        wait();
+      }
+      if (stage > Stage::LocalDensity) {
+        local_density(clue::FlatKernel{.5f}, metric);
+        wait();
+      }
+      if (stage > Stage::NearestHighers) {
+        nearest_highers(metric);
+      }
+      if (stage > Stage::Seeds) {
+        find_seeds(metric);
+        wait();
+      }
+      if (stage > Stage::Followers) {
+        fill_followers();
+        wait();
+      }
+      if (stage > Stage::Assignment) {
+        assign_clusters();
+        wait();
+      }
+    }
+
+  private:
+    Queue& m_queue;
+    clue::PointsHost<Ndim> m_hostPoints;
+    clue::PointsDevice<TDev, Ndim> m_devPoints;
+    float m_dc;
+    std::array<uint8_t, Ndim> m_wrappedCoordinates{};
+    std::size_t m_seedCandidates = 0;
+    std::optional<clue::internal::Tiles<Ndim, TDev>> m_tiles;
+    std::optional<clue::internal::SeedArray<TDev>> m_seeds;
+    std::optional<clue::Followers<TDev>> m_followers;
+    clue::internal::Arena<TDev> m_arena;
+  };
+
+  template <std::size_t Ndim>
+  using Stage = typename StagePipeline<Ndim>::Stage;
+
+  template <std::size_t Ndim>
+  StagePipeline<Ndim> make_pipeline(const benchmark::State& state) {
+    auto& queue = clue::get_queue(clue::DevicePool::deviceAt(0U));
+    return StagePipeline<Ndim>(
+        queue, static_cast<int32_t>(state.range(0)), static_cast<int32_t>(state.range(1)));
+  }
+
+  // Report the throughput of a stage, where the bytes are the ones each point has to read and
+  // write at least once, not counting the repeated reads of the coordinates of the neighbours
+  inline void set_throughput(benchmark::State& state, std::size_t bytes_per_point) {
+    const auto points = state.iterations() * state.range(0);
+    state.SetItemsProcessed(points);
+    state.SetBytesProcessed(points * static_cast<int64_t>(bytes_per_point));
+  }
+
+  template <std::size_t Ndim>
+  void BM_SetupTiles(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    for (auto _ : state) {
+      pipeline.setup_tiles();
+    }
+    set_throughput(state, Ndim * sizeof(float));
+  }
+
+  template <std::size_t Ndim>
+  void BM_CopyToDevice(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    for (auto _ : state) {
+      pipeline.copy_to_device();
+      pipeline.wait();
+    }
+    set_throughput(state, (Ndim + 1) * sizeof(float));
+  }
+
+  template <std::size_t Ndim>
+  void BM_FillTiles(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::FillTiles);
+    for (auto _ : state) {
+      pipeline.reset_arena();
+      pipeline.fill_tiles();
+      pipeline.wait();
+    }
+    // the coordinates, the tile of each point and its position in the tiles
+    set_throughput(state, Ndim * sizeof(float) + 2 * sizeof(int32_t));
+  }
+
+  template <std::size_t Ndim, typename Kernel, typename DistanceMetric>
+  void BM_LocalDensity(benchmark::State& state, Kernel kernel) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::LocalDensity);
+    for (auto _ : state) {
+      pipeline.local_density(kernel, DistanceMetric{});
+      pipeline.wait();
+    }
+    // the coordinates and the weight of each point, and its density
+    set_throughput(state, (Ndim + 2) * sizeof(float));
+  }
+
+  template <std::size_t Ndim, typename DistanceMetric>
+  void BM_NearestHighers(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::NearestHighers);
+    for (auto _ : state) {
+      pipeline.reset_arena();
+      pipeline.nearest_highers(DistanceMetric{});
+    }
+    // the coordinates and the density of each point, and its nearest higher
+    set_throughput(state, (Ndim + 1) * sizeof(float) + sizeof(int32_t));
+  }
+
+  template <std::size_t Ndim, typename DistanceMetric>
+  void BM_FindSeeds(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::Seeds);
+    for (auto _ : state) {
+      pipeline.reset_arena();
+      pipeline.find_seeds(DistanceMetric{});
+      pipeline.wait();
+    }
+    // the coordinates, the density and the nearest higher of each point
+    set_throughput(state, (Ndim + 1) * sizeof(float) + sizeof(int32_t));
+  }
+
+  template <std::size_t Ndim>
+  void BM_FillFollowers(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::Followers);
+    for (auto _ : state) {
+      pipeline.fill_followers();
+      pipeline.wait();
+    }
+    // the nearest higher of each point and its position among the followers
+    set_throughput(state, 2 * sizeof(int32_t));
+  }
+
+  template <std::size_t Ndim>
+  void BM_AssignClusters(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::Assignment);
+    for (auto _ : state) {
+      pipeline.assign_clusters();
+      pipeline.wait();
+    }
+    // the position of each point among the followers and its cluster index
+    set_throughput(state, 2 * sizeof(int32_t));
+  }
+
+  template <std::size_t Ndim>
+  void BM_GetClustersDevice(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::Done);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(&pipeline.device_clusters());
+      pipeline.wait();
+    }
+    // the cluster index of each point and its position in the clusters
+    set_throughput(state, 2 * sizeof(int32_t));
+  }
+
+  template <std::size_t Ndim>
+  void BM_GetClustersHost(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::Done);
+    pipeline.copy_to_host();
+    for (auto _ : state) {
+      auto clusters = clue::detail::get_clusters(pipeline.hostPoints().clusterIndexes());
+      benchmark::DoNotOptimize(clusters);
+    }
+    set_throughput(state, 2 * sizeof(int32_t));
+  }
+
+  template <std::size_t Ndim>
+  void BM_CopyToHost(benchmark::State& state) {
+    auto pipeline = make_pipeline<Ndim>(state);
+    pipeline.run_until(Stage<Ndim>::Done);
+    for (auto _ : state) {
+      pipeline.copy_results_to_host();
+      pipeline.wait();
+    }
+    // only the cluster index of each point is copied back
+    set_throughput(state, sizeof(int32_t));
+  }
+
+  void apply_arguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"points", "density"})
+        ->ArgsProduct({benchmark::CreateRange(1 << 12, 1 << 18, 8), {32, 512}})
+        ->Unit(benchmark::kMicrosecond)
+        ->UseRealTime();
+  }
+
+  template <typename TFunc, typename... TArgs>
+  void register_stage(const std::string& name, TFunc&& func, TArgs&&... args) {
+    apply_arguments(benchmark::RegisterBenchmark(
+        name.c_str(), std::forward<TFunc>(func), std::forward<TArgs>(args)...));
+  }
+
+  template <std::size_t Ndim>
+  void register_stages() {
+    const auto dim = "/" + std::to_string(Ndim) + "D";
+    using Euclidean = clue::EuclideanMetric<Ndim>;
+    using Manhattan = clue::ManhattanMetric<Ndim>;
+    using Chebyshev = clue::ChebyshevMetric<Ndim>;
+
+    register_stage("setup_tiles" + dim, BM_SetupTiles<Ndim>);
+    register_stage("copy_to_device" + dim, BM_CopyToDevice<Ndim>);
+    register_stage("fill_tiles" + dim, BM_FillTiles<Ndim>);
+    register_stage("local_density/flat/euclidean" + dim,
+                   BM_LocalDensity<Ndim, clue::FlatKernel, Euclidean>,
+                   clue::FlatKernel{.5f});
+    register_stage("local_density/gaussian/euclidean" + dim,
+                   BM_LocalDensity<Ndim, clue::GaussianKernel, Euclidean>,
+                   clue::GaussianKernel{0.f, 1.f, 1.f});
+    register_stage("local_density/exponential/euclidean" + dim,
+                   BM_LocalDensity<Ndim, clue::ExponentialKernel, Euclidean>,
+                   clue::ExponentialKernel{0.f, 1.f});
+    register_stage("local_density/flat/manhattan" + dim,
+                   BM_LocalDensity<Ndim, clue::FlatKernel, Manhattan>,
+                   clue::FlatKernel{.5f});
+    register_stage("local_density/flat/chebyshev" + dim,
+                   BM_LocalDensity<Ndim, clue::FlatKernel, Chebyshev>,
+                   clue::FlatKernel{.5f});
+    register_stage("nearest_highers/euclidean" + dim, BM_NearestHighers<Ndim, Euclidean>);
+    register_stage("nearest_highers/manhattan" + dim, BM_NearestHighers<Ndim, Manhattan>);
+    register_stage("nearest_highers/chebyshev" + dim, BM_NearestHighers<Ndim, Chebyshev>);
+    register_stage("find_seeds/euclidean" + dim, BM_FindSeeds<Ndim, Euclidean>);
+    register_stage("find_seeds/manhattan" + dim, BM_FindSeeds<Ndim, Manhattan>);
+    register_stage("find_seeds/chebyshev" + dim, BM_FindSeeds<Ndim, Chebyshev>);
+    register_stage("fill_followers" + dim, BM_FillFollowers<Ndim>);
+    register_stage("assign_clusters" + dim, BM_AssignClusters<Ndim>);
+    register_stage("get_clusters/device" + dim, BM_GetClustersDevice<Ndim>);
+    register_stage("get_clusters/host" + dim, BM_GetClustersHost<Ndim>);
+    register_stage("copy_to_host" + dim, BM_CopyToHost<Ndim>);
+  }
+
+  template <std::size_t... Ndims>
+  void register_all_stages(std::index_sequence<Ndims...>) {
+    (register_stages<Ndims + 1>(), ...);
+  }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  register_all_stages(std::make_index_sequence<10>{});
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
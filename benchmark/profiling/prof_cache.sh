@@ -1,3 +1,6 @@
 #
+# Usage: prof_cache.sh <executable> [arguments...]
+# The dTLB events show the effect of backing the large host buffers with huge pages,
+# which can be enabled with CLUE_ALLOCATOR_HUGE_PAGE_THRESHOLD=<bytes>
 
-perf stat -B -e cache-references,cache-misses,cycles,instructions,branches $1
+perf stat -B -e cache-references,cache-misses,cycles,instructions,branches,dTLB-loads,dTLB-load-misses "$@"
@@ -10,7 +10,12 @@
 #include "CLUEstering/data_structures/PointsDevice.hpp"
 #include "CLUEstering/data_structures/PointsConversion.hpp"
 #include "CLUEstering/utils/read_csv.hpp"
+#include "CLUEstering/utils/allocator_stats.hpp"
+#include "CLUEstering/utils/binary_file.hpp"
+#include "CLUEstering/utils/write_output.hpp"
 #include "CLUEstering/utils/cluster_centroid.hpp"
+#include "CLUEstering/utils/cluster_statistics.hpp"
+#include "CLUEstering/utils/clustering_timings.hpp"
 #include "CLUEstering/utils/get_clusters.hpp"
 #include "CLUEstering/utils/get_queue.hpp"
 #include "CLUEstering/utils/scores.hpp"
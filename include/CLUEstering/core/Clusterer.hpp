@@ -6,15 +6,20 @@
 
 #include "CLUEstering/core/DistanceMetrics.hpp"
 #include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/SpatialIndex.hpp"
 #include "CLUEstering/core/detail/ClusteringKernels.hpp"
 #include "CLUEstering/core/detail/SetupFollowers.hpp"
 #include "CLUEstering/core/detail/SetupTiles.hpp"
 #include "CLUEstering/data_structures/AssociationMap.hpp"
 #include "CLUEstering/data_structures/PointsHost.hpp"
 #include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/internal/Arena.hpp"
+#include "CLUEstering/data_structures/internal/KdTree.hpp"
 #include "CLUEstering/data_structures/internal/Tiles.hpp"
+#include "CLUEstering/utils/clustering_timings.hpp"
 
 #include <array>
+#include <chrono>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
@@ -35,6 +40,7 @@ namespace clue {
     using TDev = DevType<TQueue>;
     using TPointsDevice = PointsDevice<TDev,Ndim>;
     using TilesDevice = internal::Tiles<Ndim, TDev>;
+    using KdTreeDevice = internal::KdTree<Ndim, TDev>;
     using FollowersDevice = Followers<TDev>;
 
     float m_dc;
@@ -43,16 +49,82 @@ namespace clue {
     float m_dm;
     int m_pointsPerTile;  // average number of points found in a tile
     std::array<uint8_t, Ndim> m_wrappedCoordinates;
+    internal::TilingOptions<Ndim> m_tiling;
+    SpatialIndex m_spatialIndex = SpatialIndex::Tiles;
+    bool m_decisionGraph = false;
 
     std::optional<TilesDevice> m_tiles;
+    std::optional<KdTreeDevice> m_kdtree;
     std::optional<internal::SeedArray<TDev>> m_seeds;
     std::optional<FollowersDevice> m_followers;
+    // temporary buffers of a clustering, released at its end
+    internal::Arena<TDev> m_arena;
+    ClusteringTimings m_timings;
+    ClusteringTimings m_totalTimings;
+    // the members are the same with and without CLUE_ENABLE_TIMING, which only enables the
+    // measurements, so that the layout of the class doesn't depend on the macro
+    std::chrono::steady_clock::time_point m_stageStart;
+
+    // Start measuring the stages of a clustering
+    void start_timing() {
+#ifdef CLUE_ENABLE_TIMING
+      m_timings = ClusteringTimings{};
+      m_stageStart = std::chrono::steady_clock::now();
+#endif
+    }
+    // Wait for the operations of a stage and add the time elapsed since the end of the
+    // previous one to its timing. Without timing the stages are not synchronized
+    void stop_stage([[maybe_unused]] TQueue& queue,
+                    [[maybe_unused]] ClusteringTimings::duration ClusteringTimings::*stage) {
+#ifdef CLUE_ENABLE_TIMING
+      alpaka::onHost::wait(queue);
+      const auto now = std::chrono::steady_clock::now();
+      m_timings.*stage += now - m_stageStart;
+      m_stageStart = now;
+#endif
+    }
+    // Add the timings of the clustering to the total ones
+    void stop_timing() {
+#ifdef CLUE_ENABLE_TIMING
+      m_timings.clusterings = 1;
+      m_totalTimings += m_timings;
+#endif
+    }
+
+    template <typename TPoints>
+    void setup_spatial_index(TQueue& queue, const TPoints& points) {
+      if (m_spatialIndex == SpatialIndex::KdTree) {
+        if (!m_kdtree.has_value()) {
+          m_kdtree.emplace();
+        }
+        m_kdtree->build(queue, points, m_pointsPerTile, m_wrappedCoordinates);
+      } else {
+        detail::setup_tiles(
+            queue, m_tiles, points, m_pointsPerTile, m_wrappedCoordinates, m_tiling);
+      }
+    }
+
+    // Call a function with the view of the spatial index, after filling it with the points
+    template <typename TFunc>
+    void with_spatial_index(TQueue& queue, TPointsDevice& dev_points, TFunc&& func) {
+      if (m_spatialIndex == SpatialIndex::KdTree) {
+        func(m_kdtree->view());
+      } else {
+        m_tiles->template fill<ALPAKA_TYPEOF(queue)>(
+            queue, m_arena, dev_points, dev_points.size());
+        stop_stage(queue, &ClusteringTimings::fillTiles);
+        func(m_tiles->view());
+      }
+    }
 
     void setup(TQueue& queue, const TPointsHost& h_points, TPointsDevice& dev_points) {
-      detail::setup_tiles(queue, m_tiles, h_points, m_pointsPerTile, m_wrappedCoordinates);
+      setup_spatial_index(queue, h_points);
+      stop_stage(queue, &ClusteringTimings::setupTiles);
       detail::setup_followers(queue, m_followers, h_points.size());
+      stop_stage(queue, &ClusteringTimings::followers);
       copyToDevice(queue, dev_points, h_points);
       alpaka::onHost::wait(queue);
+      stop_stage(queue, &ClusteringTimings::copyToDevice);
     }
 
     template <typename Kernel = FlatKernel,
@@ -181,6 +253,89 @@ namespace clue {
     template <std::integral... TArgs>
     void setWrappedCoordinates(TArgs... wrapped_coordinates);
 
+    /// @brief Fix the domain of the coordinates, instead of computing it from the points
+    ///
+    /// When the domain is known in advance, for instance from the geometry of a detector,
+    /// the extremes and sizes of the tiles are computed once instead of for every clustering,
+    /// which saves a pass over the points. Points outside of the domain are assigned to the
+    /// tiles on its border.
+    ///
+    /// @param bounds The minimum and maximum value of each coordinate
+    /// @param tiles_per_dim The number of tiles along each dimension. This parameter is optional
+    /// and by default it's computed from the number of points and the points per bin.
+    /// Fixing it makes the whole tile layout independent of the points
+    void setDomain(const std::array<std::array<float, 2>, Ndim>& bounds,
+                   std::optional<int32_t> tiles_per_dim = std::nullopt);
+    /// @brief Compute the domain of the coordinates from the points in every clustering
+    void resetDomain();
+    /// @brief Set how the boundaries of the tiles are placed along each dimension
+    ///
+    /// With quantile boundaries the tiles contain approximately the same number of points,
+    /// which bounds the number of neighbours explored for each point when the points are
+    /// concentrated in a small part of the domain. The quantiles are estimated from a
+    /// histogram of the coordinates, at the cost of an additional pass over the points.
+    ///
+    /// @param boundaries The placement of the boundaries of the tiles
+    void setTileBoundaries(TileBoundaries boundaries);
+    /// @brief Set the order in which the tiles are stored in memory
+    ///
+    /// Ordering the tiles along a space-filling curve keeps the tiles which are close in
+    /// space also close in memory, so that the neighbourhood of a point spans fewer cache
+    /// lines and pages. The points are stored in the order of their tiles, so the same holds
+    /// for the points of neighbouring tiles.
+    ///
+    /// @param order The order of the tiles
+    void setTileOrder(TileOrder order);
+    /// @brief Store only the tiles containing points
+    ///
+    /// When the points occupy a small part of the domain, for instance when they are
+    /// clustered in a large or high-dimensional domain, most tiles are empty. With sparse
+    /// storage the offsets of the tiles are allocated only for the occupied tiles, and the
+    /// empty tiles are skipped through an occupancy bitmap with a bit per tile.
+    ///
+    /// @param sparse Whether to store only the occupied tiles
+    void setSparseTiles(bool sparse);
+    /// @brief Set the spatial index used to search the neighbours of the points
+    ///
+    /// The tiles are efficient for points with few dimensions, but the number of tiles
+    /// explored for each point grows exponentially with the number of dimensions.
+    /// The queries of the k-d tree cost proportionally to the number of neighbours, which makes
+    /// it preferable for points with many dimensions. When clustering host points the tree is
+    /// built on the host and copied to the device. When clustering device points it is built
+    /// on the device with a sort of the points for each level of the tree, and the queue is
+    /// synchronized before each sort, so its construction costs more than the one of the tiles.
+    /// The options of the tiles are ignored when the k-d tree is used.
+    ///
+    /// @param index The spatial index to use
+    void setSpatialIndex(SpatialIndex index);
+    /// @brief Store the data of the decision graph of the clustering
+    ///
+    /// The decision graph plots the distance of each point from its nearest higher against
+    /// its local density, and the seeds stand out in its upper right corner, which helps
+    /// choosing the parameters of the clustering. When enabled, the distances are stored in
+    /// the device points, and are copied to the host points together with the densities.
+    /// When disabled, which is the default, the distances are not stored at all.
+    ///
+    /// @param enable Whether to store the decision graph
+    void setDecisionGraph(bool enable);
+
+    /// @brief Get the timings of the stages of the last clustering
+    ///
+    /// The timings are only measured when the library is compiled with CLUE_ENABLE_TIMING,
+    /// in which case the queue is synchronized at the end of each stage, and are zero
+    /// otherwise. The time between the end of a stage and the beginning of the next one is
+    /// counted in the latter.
+    ///
+    /// @return The timings of the last clustering
+    const ClusteringTimings& timings() const;
+    /// @brief Get the timings of the stages summed over all the clusterings
+    ///
+    /// @return The sum of the timings of the clusterings since the construction of the
+    /// clusterer or the last call to resetTimings
+    const ClusteringTimings& totalTimings() const;
+    /// @brief Reset the timings summed over all the clusterings
+    void resetTimings();
+
     /// @brief Get the clusters from the host points
     ///
     /// @param h_points Host points
@@ -188,10 +343,13 @@ namespace clue {
     auto getClusters(const TPointsHost& h_points);
     /// @brief Get the clusters from the device points
     /// This function returns an associator object mapping the clusters to the points they contain.
+    /// The associator is built on the device in the buffers of the clusterer, without waiting
+    /// for the queue, and is overwritten by the next clustering.
     ///
-    /// @param d_points Device points
+    /// @param queue The queue used for the clustering
+    /// @param d_points Device points, clustered by this clusterer
     /// @return An device associator mapping clusters and points
-    auto getClusters(TQueue& queue, const TPointsDevice& d_points);
+    const auto& getClusters(TQueue& queue, const TPointsDevice& d_points);
   };
   // provided a deduction guide mainly clang/hip toolchain struggles with CTAD for the clusterer
   // deduction guide
@@ -0,0 +1,37 @@
+/// @file SpatialIndex.hpp
+/// @brief Spatial indexes used to find the neighbours of the points during the clustering
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace clue {
+
+  namespace concepts {
+
+    /// @brief A spatial index visits, for a query point and a radius, a superset of the points
+    /// which lie within the radius from it. The exact distance is then checked by the caller
+    template <typename TIndex, std::size_t Ndim>
+    concept spatial_index = requires(const TIndex& index,
+                                     const std::array<float, Ndim + 1>& coords,
+                                     float radius,
+                                     void (*func)(int32_t)) {
+      index.forEachCandidate(coords, radius, func);
+    };
+
+  }  // namespace concepts
+
+  /// @brief The spatial index used to search the neighbours of the points
+  enum class SpatialIndex {
+    /// @brief Regular grid of tiles. The neighbours are searched in all the tiles overlapping
+    /// with the search box, whose number grows as 3^Ndim
+    Tiles,
+    /// @brief Balanced k-d tree with buckets of points in the leaves. The cost of a query is
+    /// proportional to the number of neighbours, which makes it preferable for points with
+    /// many dimensions
+    KdTree
+  };
+
+}  // namespace clue
@@ -61,9 +61,11 @@ namespace clue {
     auto queue=get_queue(device);
     auto d_points = PointsDevice{device,::clue::Dim<Ndim>{}, h_points.size()};
 
+    start_timing();
     setup(queue, h_points, d_points);
     make_clusters_impl(h_points, d_points, metric, kernel, queue, block_size);
     alpaka::onHost::wait(queue);
+    stop_timing();
 
   }
   template <concepts::Queue TQueue, std::size_t Ndim>
@@ -76,9 +78,11 @@ namespace clue {
     auto device=queue.getDevice();
     auto d_points = PointsDevice{device,::clue::Dim<Ndim>{}, h_points.size()};
 
+    start_timing();
     setup(queue, h_points, d_points);
     make_clusters_impl(h_points, d_points, metric, kernel, queue, block_size);
     alpaka::onHost::wait(queue);
+    stop_timing();
   }
 
   template <concepts::Queue TQueue, std::size_t Ndim>
@@ -88,10 +92,14 @@ namespace clue {
                                                      const DistanceMetric& metric,
                                                      const Kernel& kernel,
                                                      std::size_t block_size) {
-    detail::setup_tiles(queue, m_tiles, dev_points, m_pointsPerTile, m_wrappedCoordinates);
+    start_timing();
+    setup_spatial_index(queue, dev_points);
+    stop_stage(queue, &ClusteringTimings::setupTiles);
     detail::setup_followers(queue, m_followers, dev_points.size());
+    stop_stage(queue, &ClusteringTimings::followers);
     make_clusters_impl(dev_points, metric, kernel, queue, block_size);
     alpaka::onHost::wait(queue);
+    stop_timing();
   }
   template <concepts::Queue TQueue, std::size_t Ndim>
   template <typename Kernel, concepts::distance_metric<Ndim> DistanceMetric>
@@ -101,9 +109,11 @@ namespace clue {
                                                      const DistanceMetric& metric,
                                                      const Kernel& kernel,
                                                      std::size_t block_size) {
+    start_timing();
     setup(queue, h_points, dev_points);
     make_clusters_impl(h_points, dev_points, metric, kernel, queue, block_size);
     alpaka::onHost::wait(queue);
+    stop_timing();
   }
 
   template <concepts::Queue TQueue, std::size_t Ndim>
@@ -121,14 +131,85 @@ namespace clue {
   inline void Clusterer<TQueue, Ndim>::setWrappedCoordinates(TArgs... wrappedCoordinates) {
     m_wrappedCoordinates = {static_cast<uint8_t>(wrappedCoordinates)...};
   }
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline void Clusterer<TQueue, Ndim>::setDomain(
+      const std::array<std::array<float, 2>, Ndim>& bounds, std::optional<int32_t> tiles_per_dim) {
+    internal::CoordinateExtremes<Ndim> domain;
+    for (auto dim = 0u; dim < Ndim; ++dim) {
+      if (!(bounds[dim][0] < bounds[dim][1])) {
+        throw std::invalid_argument(
+            "Invalid domain. The minimum of each coordinate must be smaller than the maximum.");
+      }
+      domain.min(dim) = bounds[dim][0];
+      domain.max(dim) = bounds[dim][1];
+    }
+    if (tiles_per_dim.has_value() && *tiles_per_dim <= 0) {
+      throw std::invalid_argument("Invalid number of tiles. The number must be positive.");
+    }
+    m_tiling.domain = domain;
+    m_tiling.n_per_dim = tiles_per_dim;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline void Clusterer<TQueue, Ndim>::resetDomain() {
+    m_tiling.domain.reset();
+    m_tiling.n_per_dim.reset();
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline void Clusterer<TQueue, Ndim>::setTileBoundaries(TileBoundaries boundaries) {
+    m_tiling.boundaries = boundaries;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline void Clusterer<TQueue, Ndim>::setTileOrder(TileOrder order) {
+    m_tiling.order = order;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline void Clusterer<TQueue, Ndim>::setSparseTiles(bool sparse) {
+    m_tiling.sparse = sparse;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline void Clusterer<TQueue, Ndim>::setSpatialIndex(SpatialIndex index) {
+    m_spatialIndex = index;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline void Clusterer<TQueue, Ndim>::setDecisionGraph(bool enable) {
+    m_decisionGraph = enable;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline const ClusteringTimings& Clusterer<TQueue, Ndim>::timings() const {
+    return m_timings;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline const ClusteringTimings& Clusterer<TQueue, Ndim>::totalTimings() const {
+    return m_totalTimings;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline void Clusterer<TQueue, Ndim>::resetTimings() {
+    m_totalTimings = ClusteringTimings{};
+  }
+
   template <concepts::Queue TQueue, std::size_t Ndim>
   inline auto Clusterer<TQueue, Ndim>::getClusters(const TPointsHost& h_points) {
     return get_clusters(h_points);
   }
 
   template <concepts::Queue TQueue, std::size_t Ndim>
-  inline auto Clusterer<TQueue, Ndim>::getClusters(TQueue& queue, const TPointsDevice& d_points) {
-    return get_clusters(queue, d_points);
+  inline const auto& Clusterer<TQueue, Ndim>::getClusters(TQueue& queue,
+                                                         const TPointsDevice& d_points) {
+    if (!d_points.clustered() || !m_seeds.has_value() || !m_followers.has_value()) {
+      throw std::logic_error("The points must be clustered before getting the clusters.");
+    }
+    // the number of seeds is cached on the host when the points are assigned to the clusters
+    const auto n_clusters = m_seeds->size(queue);
+    return m_followers->clusters(queue, d_points, n_clusters);
   }
 
   template <concepts::Queue TQueue, std::size_t Ndim>
@@ -139,33 +220,44 @@ namespace clue {
                                                    const Kernel& kernel,
                                                    TQueue& queue,
                                                    std::size_t block_size) {
+    // the temporary buffers are released when the clustering ends or throws
+    internal::ArenaGuard arena_guard{m_arena, queue};
     const std::size_t n_points = h_points.size();
-    m_tiles->template fill<ALPAKA_TYPEOF(queue)>(queue, dev_points, n_points);
 
     const std::size_t grid_size = alpaka::divCeil(n_points, block_size);
     auto threadSpec = alpaka::onHost::FrameSpec{grid_size, block_size};
-    detail::computeLocalDensity(
-        queue, threadSpec, m_tiles->view(), dev_points.view(), kernel, m_dc, metric, n_points);
-    alpaka::onHost::wait(queue);
     auto seed_candidates = 0UL;
-    detail::computeNearestHighers(queue,
-                                  threadSpec,
-                                  m_tiles->view(),
-                                  dev_points.view(),
-                                  m_dm,
-                                  metric,
-                                  seed_candidates,
-                                  n_points);
+    dev_points.store_delta(m_decisionGraph);
+    with_spatial_index(queue, dev_points, [&](const auto& index) {
+      detail::computeLocalDensity(
+          queue, threadSpec, index, dev_points.view(), kernel, m_dc, metric, n_points);
+      alpaka::onHost::wait(queue);
+      stop_stage(queue, &ClusteringTimings::localDensity);
+      detail::computeNearestHighers(queue,
+                                    threadSpec,
+                                    index,
+                                    dev_points.view(),
+                                    m_dm,
+                                    metric,
+                                    m_arena,
+                                    seed_candidates,
+                                    n_points);
+    });
     alpaka::onHost::wait(queue);
-    detail::setup_seeds(queue, m_seeds, seed_candidates);
+    stop_stage(queue, &ClusteringTimings::nearestHighers);
+    detail::setup_seeds(queue, m_seeds, m_arena, seed_candidates);
     detail::findClusterSeeds(
         queue, threadSpec, m_seeds.value(), dev_points.view(), m_seed_dc, metric, m_rhoc, n_points);
     alpaka::onHost::wait(queue);
+    stop_stage(queue, &ClusteringTimings::seeds);
     m_followers->fill(queue, dev_points);
+    stop_stage(queue, &ClusteringTimings::followers);
     detail::assignPointsToClusters(
         queue, block_size, m_seeds.value(), m_followers->view(), dev_points.view());
     alpaka::onHost::wait(queue);
+    stop_stage(queue, &ClusteringTimings::assignment);
     copyToHost(queue, h_points, dev_points);
+    stop_stage(queue, &ClusteringTimings::copyToHost);
     h_points.mark_clustered();
     dev_points.mark_clustered();
   }
@@ -177,26 +269,33 @@ namespace clue {
                                                    const Kernel& kernel,
                                                    TQueue& queue,
                                                    std::size_t block_size) {
+    // the temporary buffers are released when the clustering ends or throws
+    internal::ArenaGuard arena_guard{m_arena, queue};
     const std::size_t n_points = dev_points.size();
-    m_tiles->template fill<ALPAKA_TYPEOF(queue)>(queue, dev_points, n_points);
 
     const std::size_t grid_size = alpaka::divCeil(n_points, block_size);
     auto work_division = alpaka::onHost::FrameSpec{grid_size, block_size};
-    alpaka::onHost::wait(queue);
-    detail::computeLocalDensity(
-        queue, work_division, m_tiles->view(), dev_points.view(), kernel, m_dc, metric, n_points);
     auto seed_candidates = 0UL;
-    alpaka::onHost::wait(queue);
-    detail::computeNearestHighers(queue,
-                                  work_division,
-                                  m_tiles->view(),
-                                  dev_points.view(),
-                                  m_dm,
-                                  metric,
-                                  seed_candidates,
-                                  n_points);
-
-    detail::setup_seeds(queue, m_seeds, seed_candidates);
+    dev_points.store_delta(m_decisionGraph);
+    with_spatial_index(queue, dev_points, [&](const auto& index) {
+      alpaka::onHost::wait(queue);
+      detail::computeLocalDensity(
+          queue, work_division, index, dev_points.view(), kernel, m_dc, metric, n_points);
+      alpaka::onHost::wait(queue);
+      stop_stage(queue, &ClusteringTimings::localDensity);
+      detail::computeNearestHighers(queue,
+                                    work_division,
+                                    index,
+                                    dev_points.view(),
+                                    m_dm,
+                                    metric,
+                                    m_arena,
+                                    seed_candidates,
+                                    n_points);
+    });
+    stop_stage(queue, &ClusteringTimings::nearestHighers);
+
+    detail::setup_seeds(queue, m_seeds, m_arena, seed_candidates);
     alpaka::onHost::wait(queue);
     detail::findClusterSeeds(queue,
                              work_division,
@@ -206,13 +305,16 @@ namespace clue {
                              metric,
                              m_rhoc,
                              n_points);
+    stop_stage(queue, &ClusteringTimings::seeds);
 
     m_followers->template fill<ALPAKA_TYPEOF(queue)>(queue, dev_points);
     alpaka::onHost::wait(queue);
+    stop_stage(queue, &ClusteringTimings::followers);
     detail::assignPointsToClusters(
         queue, block_size, m_seeds.value(), m_followers->view(), dev_points.view());
 
     alpaka::onHost::wait(queue);
+    stop_stage(queue, &ClusteringTimings::assignment);
     dev_points.mark_clustered();
   }
 
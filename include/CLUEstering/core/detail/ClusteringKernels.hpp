@@ -2,74 +2,28 @@
 #pragma once
 
 #include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/SpatialIndex.hpp"
 #include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/internal/Arena.hpp"
 #include "CLUEstering/data_structures/internal/Followers.hpp"
-#include "CLUEstering/data_structures/internal/SearchBox.hpp"
+#include "CLUEstering/data_structures/internal/KdTreeView.hpp"
 #include "CLUEstering/data_structures/internal/SeedArray.hpp"
 #include "CLUEstering/data_structures/internal/TilesView.hpp"
-#include "CLUEstering/data_structures/internal/VecArray.hpp"
-#include "CLUEstering/detail/make_array.hpp"
 
 #include <array>
 #include <cstdint>
+#include <limits>
 
 namespace clue::detail {
 
-  template <typename TAcc,
-            std::size_t Ndim,
-            std::size_t N_,
-            typename KernelType,
-            concepts::distance_metric<Ndim> DistanceMetric>
-  ALPAKA_FN_ACC void for_recursion(const TAcc& acc,
-                                   VecArray<int32_t, Ndim>& base_vec,
-                                   const SearchBoxBins<Ndim>& search_box,
-                                   internal::TilesView<Ndim>& tiles,
-                                   PointsView<Ndim>& dev_points,
-                                   const KernelType& kernel,
-                                   const std::array<float, Ndim + 1>& coords_i,
-                                   float& rho_i,
-                                   float dc,
-                                   const DistanceMetric& metric,
-                                   int32_t point_id) {
-    if constexpr (N_ == 0) {
-      auto binId = tiles.getGlobalBinByBin(base_vec);
-      auto span = tiles[binId];  //now returns a mdSpan
-
-      for (auto j : span) {
-        auto coords_j = dev_points[j];
-        auto distance = metric(coords_i, coords_j);
-
-        auto k = kernel(acc, distance, point_id, j);
-        rho_i += static_cast<int>(distance <= dc) * k * dev_points.weight[j];
-      }
-      return;
-    } else {
-      for (auto i = search_box[search_box.size() - N_][0];
-           i <= search_box[search_box.size() - N_][1];
-           ++i) {
-        base_vec[base_vec.capacity() - N_] = i;
-        for_recursion<TAcc, Ndim, N_ - 1>(acc,
-                                          base_vec,
-                                          search_box,
-                                          tiles,
-                                          dev_points,
-                                          kernel,
-                                          coords_i,
-                                          rho_i,
-                                          dc,
-                                          metric,
-                                          point_id);
-      }
-    }
-  }
-
   struct KernelCalculateLocalDensity {
     template <typename TAcc,
               std::size_t Ndim,
+              concepts::spatial_index<Ndim> TIndex,
               typename KernelType,
               concepts::distance_metric<Ndim> DistanceMetric>
     ALPAKA_FN_ACC void operator()(const TAcc& acc,
-                                  internal::TilesView<Ndim> dev_tiles,
+                                  TIndex index,
                                   PointsView<Ndim> dev_points,
                                   const KernelType& kernel,
                                   float dc,
@@ -77,98 +31,30 @@ namespace clue::detail {
                                   int32_t n_points) const {
       for (auto [i] : alpaka::onAcc::makeIdxMap(
                acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{n_points})) {
+        const int32_t point_id = i;
         float rho_i = 0.f;
-        auto coords_i = dev_points[i];
-
-        SearchBoxExtremes<Ndim> searchbox_extremes;
-        for (auto dim = 0u; dim != Ndim; ++dim) {
-          searchbox_extremes[dim] = nostd::make_array(coords_i[dim] - dc, coords_i[dim] + dc);
-        }
+        auto coords_i = dev_points[point_id];
 
-        SearchBoxBins<Ndim> searchbox_bins;
-        dev_tiles.searchBox(searchbox_extremes, searchbox_bins);
+        index.forEachCandidate(coords_i, dc, [&](int32_t j) {
+          auto coords_j = dev_points[j];
+          auto distance = metric(coords_i, coords_j);
 
-        VecArray<int32_t, Ndim> base_vec;
-        for_recursion<TAcc, Ndim, Ndim>(acc,
-                                        base_vec,
-                                        searchbox_bins,
-                                        dev_tiles,
-                                        dev_points,
-                                        kernel,
-                                        coords_i,
-                                        rho_i,
-                                        dc,
-                                        metric,
-                                        i);
+          auto k = kernel(acc, distance, point_id, j);
+          rho_i += static_cast<int>(distance <= dc) * k * dev_points.weight[j];
+        });
 
-        dev_points.rho[i] = rho_i;
+        dev_points.rho[point_id] = rho_i;
       }
     }
   };
 
-  template <typename TAcc,
-            std::size_t Ndim,
-            std::size_t N_,
-            concepts::distance_metric<Ndim> DistanceMetric>
-  ALPAKA_FN_ACC void for_recursion_nearest_higher(const TAcc& acc,
-                                                  VecArray<int32_t, Ndim>& base_vec,
-                                                  const SearchBoxBins<Ndim>& search_box,
-                                                  internal::TilesView<Ndim>& tiles,
-                                                  PointsView<Ndim>& dev_points,
-                                                  const std::array<float, Ndim + 1>& coords_i,
-                                                  float rho_i,
-                                                  float& delta_i,
-                                                  int& nh_i,
-                                                  float dm,
-                                                  const DistanceMetric& metric,
-                                                  int32_t point_id) {
-    if constexpr (N_ == 0) {
-      auto binId = tiles.getGlobalBinByBin(base_vec);
-      auto binSize = tiles[binId].size();
-
-      for (auto binIter = 0u; binIter < binSize; ++binIter) {
-        const auto j = tiles[binId][binIter];
-        float rho_j = dev_points.rho[j];
-        bool found_higher = (rho_j > rho_i);
-        found_higher = found_higher || ((rho_j == rho_i) && (rho_j > 0.f) && (j > point_id));
-
-        auto coords_j = dev_points[j];
-        auto distance = metric(coords_i, coords_j);
-
-        if (found_higher && distance <= dm) {
-          if (distance < delta_i) {
-            delta_i = distance;
-            nh_i = j;
-          }
-        }
-      }
-
-      return;
-    } else {
-      for (auto i = search_box[search_box.size() - N_][0];
-           i <= search_box[search_box.size() - N_][1];
-           ++i) {
-        base_vec[base_vec.capacity() - N_] = i;
-        for_recursion_nearest_higher<TAcc, Ndim, N_ - 1>(acc,
-                                                         base_vec,
-                                                         search_box,
-                                                         tiles,
-                                                         dev_points,
-                                                         coords_i,
-                                                         rho_i,
-                                                         delta_i,
-                                                         nh_i,
-                                                         dm,
-                                                         metric,
-                                                         point_id);
-      }
-    }
-  }
-
   struct KernelCalculateNearestHigher {
-    template <typename TAcc, std::size_t Ndim, concepts::distance_metric<Ndim> DistanceMetric>
+    template <typename TAcc,
+              std::size_t Ndim,
+              concepts::spatial_index<Ndim> TIndex,
+              concepts::distance_metric<Ndim> DistanceMetric>
     ALPAKA_FN_ACC void operator()(const TAcc& acc,
-                                  internal::TilesView<Ndim> dev_tiles,
+                                  TIndex index,
                                   PointsView<Ndim> dev_points,
                                   float dm,
                                   DistanceMetric metric,
@@ -176,34 +62,32 @@ namespace clue::detail {
                                   int32_t n_points) const {
       for (auto [i] : alpaka::onAcc::makeIdxMap(
                acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{n_points})) {
+        const int32_t point_id = i;
         float delta_i = std::numeric_limits<float>::max();
         int nh_i = -1;
-        auto coords_i = dev_points[i];
-        float rho_i = dev_points.rho[i];
+        auto coords_i = dev_points[point_id];
+        float rho_i = dev_points.rho[point_id];
+
+        index.forEachCandidate(coords_i, dm, [&](int32_t j) {
+          float rho_j = dev_points.rho[j];
+          bool found_higher = (rho_j > rho_i);
+          found_higher = found_higher || ((rho_j == rho_i) && (rho_j > 0.f) && (j > point_id));
+
+          auto coords_j = dev_points[j];
+          auto distance = metric(coords_i, coords_j);
+
+          if (found_higher && distance <= dm) {
+            if (distance < delta_i) {
+              delta_i = distance;
+              nh_i = j;
+            }
+          }
+        });
 
-        SearchBoxExtremes<Ndim> searchbox_extremes;
-        for (auto dim = 0u; dim != Ndim; ++dim) {
-          searchbox_extremes[dim] = nostd::make_array(coords_i[dim] - dm, coords_i[dim] + dm);
+        dev_points.nearest_higher[point_id] = nh_i;
+        if (dev_points.delta != nullptr) {
+          dev_points.delta[point_id] = delta_i;
         }
-
-        SearchBoxBins<Ndim> searchbox_bins;
-        dev_tiles.searchBox(searchbox_extremes, searchbox_bins);
-
-        VecArray<int32_t, Ndim> base_vec{};
-        for_recursion_nearest_higher<TAcc, Ndim, Ndim>(acc,
-                                                       base_vec,
-                                                       searchbox_bins,
-                                                       dev_tiles,
-                                                       dev_points,
-                                                       coords_i,
-                                                       rho_i,
-                                                       delta_i,
-                                                       nh_i,
-                                                       dm,
-                                                       metric,
-                                                       i);
-
-        dev_points.nearest_higher[i] = nh_i;
         if (nh_i == -1) {
           alpaka::onAcc::atomicAdd(acc, seed_candidates, 1UL);
         }
@@ -222,7 +106,6 @@ namespace clue::detail {
                                   int32_t n_points) const {
       for (auto [i] : alpaka::onAcc::makeIdxMap(
                acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{n_points})) {
-        dev_points.cluster_index[i] = -1;
         auto nh = dev_points.nearest_higher[i];
 
         auto coords_i = dev_points[i];
@@ -233,11 +116,9 @@ namespace clue::detail {
         bool is_seed = (distance > seed_dc) && (rho_i >= rhoc);
 
         if (is_seed) {
-          dev_points.is_seed[i] = 1;
+          alpaka::onAcc::atomicOr(acc, &dev_points.is_seed[i / 32], uint32_t{1} << (i % 32));
           dev_points.nearest_higher[i] = -1;
           seeds.push_back(acc, i);
-        } else {
-          dev_points.is_seed[i] = 0;
         }
       }
     }
@@ -282,11 +163,12 @@ namespace clue::detail {
 
   template <concepts::Queue TQueue,
             std::size_t Ndim,
+            concepts::spatial_index<Ndim> TIndex,
             typename KernelType,
             concepts::distance_metric<Ndim> DistanceMetric>
   inline void computeLocalDensity(TQueue& queue,
                                   auto const& thread_spec,
-                                  internal::TilesView<Ndim>& tiles,
+                                  const TIndex& index,
                                   PointsView<Ndim>& dev_points,
                                   KernelType&& kernel,
                                   float dc,
@@ -295,7 +177,7 @@ namespace clue::detail {
     queue.enqueue(DevicePool::exec(),
                   thread_spec,
                   alpaka::KernelBundle{KernelCalculateLocalDensity{},
-                                       tiles,
+                                       index,
                                        dev_points,
                                        std::forward<KernelType>(kernel),
                                        dc,
@@ -303,22 +185,26 @@ namespace clue::detail {
                                        size});
   }
 
-  template <concepts::Queue TQueue, std::size_t Ndim, concepts::distance_metric<Ndim> DistanceMetric>
+  template <concepts::Queue TQueue,
+            std::size_t Ndim,
+            concepts::spatial_index<Ndim> TIndex,
+            concepts::distance_metric<Ndim> DistanceMetric>
   inline void computeNearestHighers(TQueue& queue,
                                     const auto& thread_spec,
-                                    internal::TilesView<Ndim>& tiles,
+                                    const TIndex& index,
                                     PointsView<Ndim>& dev_points,
                                     float dm,
                                     const DistanceMetric& metric,
+                                    internal::Arena<DevType<TQueue>>& arena,
                                     std::size_t& seed_candidates,
                                     int32_t size) {
-    auto device = queue.getDevice();
-    auto d_seed_candidates = make_device_buffer<std::size_t>(device, Vec1D{1U});
+    auto d_seed_candidates =
+        alpaka::makeView(queue, arena.template allocate<std::size_t>(queue, 1), Vec1D{1U});
     alpaka::onHost::memset(queue, d_seed_candidates, 0U);
     queue.enqueue(DevicePool::exec(),
                   thread_spec,
                   KernelCalculateNearestHigher{},
-                  tiles,
+                  index,
                   dev_points,
                   dm,
                   metric,
@@ -338,6 +224,8 @@ namespace clue::detail {
                                const DistanceMetric& metric,
                                float rhoc,
                                int32_t size) {
+    const auto seed_words = static_cast<uint32_t>(size + 31) / 32;
+    alpaka::onHost::memset(queue, alpaka::makeView(queue, dev_points.is_seed, Vec1D{seed_words}), 0);
     queue.enqueue(DevicePool::exec(),
                   threadSpec,
                   KernelFindClusters{},
@@ -355,6 +243,11 @@ namespace clue::detail {
                                      internal::SeedArray<DevType<TQueue>>& seeds,
                                      FollowersView followers,
                                      PointsView<Ndim> dev_points) {
+    // the cluster indexes are only initialized once the followers have been filled, so that
+    // they can share the storage of the nearest highers in low-memory mode
+    const auto n_points = static_cast<uint32_t>(dev_points.n);
+    alpaka::onHost::memset(
+        queue, alpaka::makeView(queue, dev_points.cluster_index, Vec1D{n_points}), 0xff);
     const std::size_t grid_size = alpaka::divCeil(seeds.size(queue), block_size);
     const auto frame_spec = alpaka::onHost::FrameSpec{grid_size, block_size};
     queue.enqueue(
@@ -5,67 +5,323 @@
 #include "CLUEstering/data_structures/PointsDevice.hpp"
 #include "CLUEstering/data_structures/internal/CoordinateExtremes.hpp"
 #include "CLUEstering/data_structures/internal/Tiles.hpp"
-#include "CLUEstering/internal/algorithm/algorithm.hpp"
+#include "CLUEstering/internal/nostd/parallel_for.hpp"
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
 
 namespace clue::detail {
 
+  // Points processed by each host thread when computing the extremes of the coordinates
+  inline constexpr std::size_t extremes_grain = 1 << 16;
+  // Points processed by each device thread when computing the extremes of the coordinates,
+  // which keeps the number of atomic operations small
+  inline constexpr std::size_t extremes_points_per_thread = 64;
+
+  using internal::fromOrderedKey;
+  using internal::orderedKey;
+
+  // While the extremes are being reduced, the storage of the CoordinateExtremes
+  // holds the ordered keys of the minimum and maximum coordinates
+  template <std::size_t Ndim>
+  struct KernelResetExtremes {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc, internal::CoordinateExtremes<Ndim>* min_max) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{1u})) {
+        auto* keys = reinterpret_cast<int32_t*>(min_max->data());
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          keys[2 * dim] = std::numeric_limits<int32_t>::max();
+          keys[2 * dim + 1] = std::numeric_limits<int32_t>::lowest();
+        }
+      }
+    }
+  };
+
+  // Each thread reduces the extremes of all the coordinates of its points,
+  // which are then merged with a single atomic operation per dimension
+  struct KernelReduceExtremes {
+    template <typename TAcc, std::size_t Ndim>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim> points,
+                                  internal::CoordinateExtremes<Ndim>* min_max,
+                                  int32_t size) const {
+      std::array<int32_t, Ndim> local_min;
+      std::array<int32_t, Ndim> local_max;
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        local_min[dim] = std::numeric_limits<int32_t>::max();
+        local_max[dim] = std::numeric_limits<int32_t>::lowest();
+      }
+      bool found = false;
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{size})) {
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          const auto key = orderedKey(points.coords[dim][i]);
+          local_min[dim] = key < local_min[dim] ? key : local_min[dim];
+          local_max[dim] = key > local_max[dim] ? key : local_max[dim];
+        }
+        found = true;
+      }
+      if (found) {
+        auto* keys = reinterpret_cast<int32_t*>(min_max->data());
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          alpaka::onAcc::atomicMin(acc, &keys[2 * dim], local_min[dim]);
+          alpaka::onAcc::atomicMax(acc, &keys[2 * dim + 1], local_max[dim]);
+        }
+      }
+    }
+  };
+
+  template <std::size_t Ndim>
+  struct KernelComputeTileSizes {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::CoordinateExtremes<Ndim>* min_max,
+                                  float* tile_sizes,
+                                  int32_t nPerDim) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{1u})) {
+        const auto* keys = reinterpret_cast<const int32_t*>(min_max->data());
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          const auto min = fromOrderedKey(keys[2 * dim]);
+          const auto max = fromOrderedKey(keys[2 * dim + 1]);
+          min_max->min(dim) = min;
+          min_max->max(dim) = max;
+          tile_sizes[dim] = (max - min) / static_cast<float>(nPerDim);
+        }
+      }
+    }
+  };
+
   template <std::size_t Ndim>
   void compute_tile_size(internal::CoordinateExtremes<Ndim>* min_max,
                          alpaka::concepts::IMdSpan auto tile_sizes,
                          const PointsHost<Ndim>& h_points,
                          int32_t nPerDim) {
-    for (size_t dim{}; dim != Ndim; ++dim) {
-      auto coords = h_points.coords(dim);
-      auto stdView = std::span<const float>(coords.data(), coords.size());
-      min_max->min(dim) = *std::ranges::min_element(stdView);
-      min_max->max(dim) = *std::ranges::max_element(stdView);
-
-      const float tileSize = (min_max->max(dim) - min_max->min(dim)) / nPerDim;
-      tile_sizes[dim] = tileSize;
+    // every block of points is reduced by a thread over all the coordinates at once
+    const auto size = static_cast<std::size_t>(h_points.size());
+    std::vector<internal::CoordinateExtremes<Ndim>> partials(
+        nostd::host_concurrency(size, extremes_grain));
+    for (auto& partial : partials) {
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        partial.min(dim) = std::numeric_limits<float>::max();
+        partial.max(dim) = std::numeric_limits<float>::lowest();
+      }
+    }
+    const auto& view = h_points.view();
+    nostd::parallel_for_blocks(
+        size,
+        [&](std::size_t block, std::size_t begin, std::size_t end) {
+          auto& partial = partials[block];
+          for (auto dim = 0u; dim < Ndim; ++dim) {
+            const auto [min, max] =
+                std::minmax_element(view.coords[dim] + begin, view.coords[dim] + end);
+            if (begin != end) {
+              partial.min(dim) = *min;
+              partial.max(dim) = *max;
+            }
+          }
+        },
+        extremes_grain);
+
+    for (auto dim = 0u; dim < Ndim; ++dim) {
+      min_max->min(dim) = partials[0].min(dim);
+      min_max->max(dim) = partials[0].max(dim);
+      for (const auto& partial : partials) {
+        min_max->min(dim) = std::min(min_max->min(dim), partial.min(dim));
+        min_max->max(dim) = std::max(min_max->max(dim), partial.max(dim));
+      }
+      tile_sizes[dim] = (min_max->max(dim) - min_max->min(dim)) / nPerDim;
     }
   }
 
+  // Compute the extremes of the coordinates and the sizes of the tiles directly in device
+  // memory, without any transfer or synchronization with the host
   template <concepts::Queue TQueue, std::size_t Ndim, typename TDev>
-  void compute_tile_size(TQueue & queue,
+  void compute_tile_size(TQueue& queue,
                          internal::CoordinateExtremes<Ndim>* min_max,
-                         alpaka::concepts::IMdSpan auto tile_sizes,
-                         const PointsDevice<TDev,Ndim>& dev_points,
-                         uint32_t nPerDim) {
-    for (size_t dim{}; dim != Ndim; ++dim) {
-      auto coords = dev_points.coords(dim);
-      auto [itmin,itmax] = internal::algorithm::minmax_element(queue, coords.begin(), coords.end());
-      float h_min{0};
-      float h_max{0};
-      auto ptr_min = std::to_address(itmin);
-      auto ptr_max = std::to_address(itmax);
-      alpaka::onHost::memcpy(queue, makeView(alpaka::api::host,&h_min,Vec1D{float{1}}), alpaka::makeView(queue,ptr_min,Vec1D{float{1}}),Vec1D{float{1}});
-      alpaka::onHost::memcpy(queue, makeView(alpaka::api::host,&h_max,Vec1D{float{1}}), alpaka::makeView(queue,ptr_max,Vec1D{float{1}}),Vec1D{float{1}});
-      // alpaka::onHost::wait(queue);
-      // alpaka::onHost::reduce(queue,
-      //                        DevicePool::exec(),
-      //                        std::numeric_limits<float>::lowest(),
-      //                        d_max,
-      //                        internal::simdMax(),
-      //                        devCoordsView);
-      //
-      // alpaka::onHost::reduce(queue,
-      //                        DevicePool::exec(),
-      //                        std::numeric_limits<float>::max(),
-      //                        d_min,
-      //                        internal::simdMin(),
-      //                        devCoordsView);
-      //
-      // float h_max{};
-      // float h_min{};
-      // alpaka::onHost::memcpy(queue, makeView(alpaka::api::host,&h_max,Vec1D{1U}), d_max);
-      // alpaka::onHost::memcpy(queue, makeView(alpaka::api::host,&h_min,Vec1D{1U}), d_min);
-      // alpaka::onHost::wait(queue);
-      min_max->min(dim) = h_min;
-      min_max->max(dim) = h_max;
-
-      tile_sizes[dim] = (h_max - h_min) / static_cast<float>(nPerDim);
+                         float* tile_sizes,
+                         const PointsDevice<TDev, Ndim>& dev_points,
+                         int32_t nPerDim) {
+    const auto size = static_cast<std::size_t>(dev_points.size());
+    constexpr std::size_t block_size = 256;
+    const auto grid_size =
+        std::max<std::size_t>(alpaka::divCeil(size, block_size * extremes_points_per_thread), 1);
+    const auto single = alpaka::onHost::FrameSpec{1u, 1u};
+
+    queue.enqueue(DevicePool::exec(), single, KernelResetExtremes<Ndim>{}, min_max);
+    queue.enqueue(DevicePool::exec(),
+                  alpaka::onHost::FrameSpec{grid_size, block_size},
+                  KernelReduceExtremes{},
+                  dev_points.view(),
+                  min_max,
+                  static_cast<int32_t>(size));
+    queue.enqueue(
+        DevicePool::exec(), single, KernelComputeTileSizes<Ndim>{}, min_max, tile_sizes, nPerDim);
+  }
+
+  // The histograms of the quantiles are uniform in the space of the ordered keys, whose
+  // resolution follows the one of the floats. This keeps enough resolution close to the mode
+  // of distributions with heavy tails, where uniform bins would contain most of the points
+  ALPAKA_FN_HOST_ACC inline constexpr int32_t quantileBin(float coord,
+                                                          int32_t min_key,
+                                                          int32_t max_key) {
+    const auto key = orderedKey(coord);
+    if (key <= min_key) {
+      return 0;
+    }
+    if (key >= max_key) {
+      return internal::quantile_bins - 1;
     }
+    return static_cast<int32_t>((static_cast<int64_t>(key) - min_key) * internal::quantile_bins /
+                                (static_cast<int64_t>(max_key) - min_key + 1));
+  }
+
+  // Compute the internal edges of the tiles of a dimension from the histogram of its
+  // coordinates, interpolating linearly inside the bin containing each quantile
+  ALPAKA_FN_HOST_ACC inline void quantileEdges(
+      const int32_t* histogram, float min, float max, int32_t nPerDim, float* edges) {
+    const auto min_key = orderedKey(min);
+    const auto max_key = orderedKey(max);
+    const auto bin_width =
+        (static_cast<double>(max_key) - min_key + 1) / internal::quantile_bins;
+    int64_t n_points = 0;
+    for (auto bin = 0; bin < internal::quantile_bins; ++bin) {
+      n_points += histogram[bin];
+    }
+
+    int64_t cumulative = 0;
+    auto edge = 1;
+    for (auto bin = 0; bin < internal::quantile_bins && edge < nPerDim; ++bin) {
+      const auto count = histogram[bin];
+      while (edge < nPerDim &&
+             (cumulative + count) * nPerDim >= static_cast<int64_t>(edge) * n_points) {
+        const auto target = static_cast<double>(edge) * n_points / nPerDim;
+        const auto fraction = count > 0 ? (target - cumulative) / count : 0.;
+        const auto key = static_cast<int32_t>(min_key + (bin + fraction) * bin_width);
+        edges[edge - 1] = fromOrderedKey(key < max_key ? key : max_key);
+        ++edge;
+      }
+      cumulative += count;
+    }
+    for (; edge < nPerDim; ++edge) {
+      edges[edge - 1] = max;
+    }
+  }
+
+  struct KernelQuantileHistogram {
+    template <typename TAcc, std::size_t Ndim>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim> points,
+                                  const internal::CoordinateExtremes<Ndim>* min_max,
+                                  int32_t* histogram,
+                                  int32_t size) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{size})) {
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          const auto bin = quantileBin(points.coords[dim][i],
+                                       orderedKey(min_max->min(dim)),
+                                       orderedKey(min_max->max(dim)));
+          alpaka::onAcc::atomicAdd(acc, &histogram[dim * internal::quantile_bins + bin], 1);
+        }
+      }
+    }
+  };
+
+  template <std::size_t Ndim>
+  struct KernelQuantileEdges {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  const internal::CoordinateExtremes<Ndim>* min_max,
+                                  const int32_t* histogram,
+                                  float* edges,
+                                  int32_t nPerDim) const {
+      for (auto [dim] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{static_cast<uint32_t>(Ndim)})) {
+        quantileEdges(histogram + dim * internal::quantile_bins,
+                      min_max->min(dim),
+                      min_max->max(dim),
+                      nPerDim,
+                      edges + dim * (nPerDim - 1));
+      }
+    }
+  };
+
+  // Compute the edges of the quantile tiles from a parallel histogram of the coordinates
+  template <std::size_t Ndim>
+  void compute_quantile_edges(const internal::CoordinateExtremes<Ndim>& min_max,
+                              float* edges,
+                              const PointsHost<Ndim>& h_points,
+                              int32_t nPerDim) {
+    const auto size = static_cast<std::size_t>(h_points.size());
+    std::vector<std::vector<int32_t>> partials(
+        nostd::host_concurrency(size, extremes_grain),
+        std::vector<int32_t>(Ndim * internal::quantile_bins, 0));
+    const auto& view = h_points.view();
+    nostd::parallel_for_blocks(
+        size,
+        [&](std::size_t block, std::size_t begin, std::size_t end) {
+          auto& partial = partials[block];
+          for (auto dim = 0u; dim < Ndim; ++dim) {
+            const auto min_key = orderedKey(min_max.min(dim));
+            const auto max_key = orderedKey(min_max.max(dim));
+            auto* histogram = partial.data() + dim * internal::quantile_bins;
+            for (auto i = begin; i < end; ++i) {
+              ++histogram[quantileBin(view.coords[dim][i], min_key, max_key)];
+            }
+          }
+        },
+        extremes_grain);
+
+    auto& histogram = partials[0];
+    for (auto block = 1u; block < partials.size(); ++block) {
+      std::transform(histogram.begin(),
+                     histogram.end(),
+                     partials[block].begin(),
+                     histogram.begin(),
+                     std::plus<int32_t>{});
+    }
+    for (auto dim = 0u; dim < Ndim; ++dim) {
+      quantileEdges(histogram.data() + dim * internal::quantile_bins,
+                    min_max.min(dim),
+                    min_max.max(dim),
+                    nPerDim,
+                    edges + dim * (nPerDim - 1));
+    }
+  }
+
+  // Compute the edges of the quantile tiles directly in device memory, from the extremes
+  // already stored there
+  template <concepts::Queue TQueue, std::size_t Ndim, typename TDev>
+  void compute_quantile_edges(TQueue& queue,
+                              const internal::CoordinateExtremes<Ndim>* min_max,
+                              auto& histogram,
+                              float* edges,
+                              const PointsDevice<TDev, Ndim>& dev_points,
+                              int32_t nPerDim) {
+    const auto size = static_cast<std::size_t>(dev_points.size());
+    constexpr std::size_t block_size = 256;
+    const auto grid_size = std::max<std::size_t>(alpaka::divCeil(size, block_size), 1);
+
+    alpaka::onHost::memset(queue, histogram, 0);
+    queue.enqueue(DevicePool::exec(),
+                  alpaka::onHost::FrameSpec{grid_size, block_size},
+                  KernelQuantileHistogram{},
+                  dev_points.view(),
+                  min_max,
+                  histogram.data(),
+                  static_cast<int32_t>(size));
+    queue.enqueue(DevicePool::exec(),
+                  alpaka::onHost::FrameSpec{1u, 1u},
+                  KernelQuantileEdges<Ndim>{},
+                  min_max,
+                  histogram.data(),
+                  edges,
+                  nPerDim);
   }
 
 }  // namespace clue::detail
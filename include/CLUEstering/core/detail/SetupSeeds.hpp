@@ -2,6 +2,7 @@
 #pragma once
 
 #include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/data_structures/internal/Arena.hpp"
 #include "CLUEstering/data_structures/internal/SeedArray.hpp"
 #include <cstddef>
 #include <optional>
@@ -10,12 +11,10 @@ namespace clue::detail {
   template <typename TQueue, typename TDev>
   inline void setup_seeds(TQueue& queue,
                           std::optional<internal::SeedArray<TDev>>& seeds,
+                          internal::Arena<TDev>& arena,
                           std::size_t seed_candidates) {
-    if (!seeds.has_value() || seeds->capacity() < seed_candidates) {
-      seeds = internal::SeedArray<TDev>(queue, seed_candidates);
-    } else {
-      seeds->reset(queue);
-    }
+    // the seeds live in the arena, which is reset at the end of every clustering
+    seeds.emplace(queue, arena, seed_candidates);
     alpaka::onHost::wait(queue);
   }
 
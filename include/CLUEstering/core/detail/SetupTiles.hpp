@@ -13,34 +13,63 @@
 
 namespace clue::detail {
 
+  // The number of tiles per dimension, either fixed by the user or such that
+  // each tile contains on average the requested number of points
+  template <std::size_t Ndim>
+  inline int32_t tiles_per_dim(int32_t n_points,
+                               int points_per_tile,
+                               const internal::TilingOptions<Ndim>& options) {
+    if (options.domain.has_value() && options.n_per_dim.has_value()) {
+      return *options.n_per_dim;
+    }
+    // TODO: reconsider the way that we compute the number of tiles
+    const auto ntiles =
+        static_cast<int32_t>(std::ceil(n_points / static_cast<float>(points_per_tile)));
+    return static_cast<int32_t>(std::ceil(std::pow(ntiles, 1. / Ndim)));
+  }
+
   template <typename TQueue, std::size_t Ndim, typename TDev>
   void setup_tiles(TQueue& queue,
                    std::optional<internal::Tiles<Ndim, TDev>>& tiles,
                    const PointsHost<Ndim>& points,
                    int points_per_tile,
-                   const std::array<uint8_t, Ndim>& wrapped_coordinates) {
-    // TODO: reconsider the way that we compute the number of tiles
-    auto ntiles =
-        static_cast<int32_t>(std::ceil(points.size() / static_cast<float>(points_per_tile)));
-    const auto n_per_dim = static_cast<int32_t>(std::ceil(std::pow(ntiles, 1. / Ndim)));
-    ntiles = static_cast<int32_t>(std::pow(n_per_dim, Ndim));
+                   const std::array<uint8_t, Ndim>& wrapped_coordinates,
+                   const internal::TilingOptions<Ndim>& options = {}) {
+    const auto n_per_dim = tiles_per_dim(points.size(), points_per_tile, options);
+    const auto ntiles = static_cast<int32_t>(std::pow(n_per_dim, Ndim));
 
+    // with sparse storage only the occupied tiles are allocated, when filling the tiles
+    const auto nkeys = options.sparse ? 0 : ntiles;
     if (!tiles.has_value()) {
-      tiles = std::make_optional<internal::Tiles<Ndim, TDev>>(queue, points.size(), ntiles);
+      tiles = std::make_optional<internal::Tiles<Ndim, TDev>>(queue, points.size(), nkeys);
     }
+    tiles->setSparse(options.sparse);
     // check if tiles are large enough for current data
-    if ((tiles->extents().values < static_cast<std::size_t>(points.size())) or
-        (tiles->extents().keys < static_cast<std::size_t>(ntiles))) {
+    if ((tiles->capacity().values < static_cast<std::size_t>(points.size())) or
+        (tiles->capacity().keys < static_cast<std::size_t>(nkeys))) {
       tiles->initialize(queue, points.size(), ntiles, n_per_dim);
     } else {
       tiles->reset(points.size(), ntiles, n_per_dim);
     }
+    tiles->setOrder(queue, options.order);
 
-    auto min_max = make_host_buffer<internal::CoordinateExtremes<Ndim>>();
-    auto tile_sizes = make_host_buffer<float>(Ndim);
-    detail::compute_tile_size(min_max.data(), tile_sizes, points, n_per_dim);
-    alpaka::onHost::memcpy(queue, tiles->m_minmax, min_max);
-    alpaka::onHost::memcpy(queue, tiles->m_tilesizes, tile_sizes);
+    if (options.domain.has_value()) {
+      tiles->setGeometry(queue, *options.domain);
+    } else {
+      tiles->invalidateGeometry();
+      detail::compute_tile_size(
+          tiles->m_hostMinmax.data(), tiles->m_hostTilesizes, points, n_per_dim);
+      alpaka::onHost::memcpy(queue, tiles->m_minmax, tiles->m_hostMinmax);
+      alpaka::onHost::memcpy(queue, tiles->m_tilesizes, tiles->m_hostTilesizes);
+    }
+    if (options.boundaries == TileBoundaries::Quantile) {
+      auto& quantiles = tiles->useQuantileEdges(queue);
+      detail::compute_quantile_edges(
+          *tiles->m_hostMinmax.data(), quantiles.hostEdges.data(), points, n_per_dim);
+      alpaka::onHost::memcpy(queue, quantiles.edges, quantiles.hostEdges);
+    } else {
+      tiles->useUniformEdges();
+    }
     auto view = alpaka::makeView(wrapped_coordinates);
 
     auto& dst = tiles->m_wrapped;
@@ -55,30 +84,46 @@ namespace clue::detail {
                    std::optional<internal::Tiles<Ndim, TDev>>& tiles,
                    const PointsDevice<TDev,Ndim>& points,
                    int points_per_tile,
-                   const std::array<uint8_t, Ndim>& wrapped_coordinates) {
-    auto ntiles =
-        static_cast<int32_t>(std::ceil(points.size() / static_cast<float>(points_per_tile)));
-    const auto n_per_dim = static_cast<int32_t>(std::ceil(std::pow(ntiles, 1. / Ndim)));
-    ntiles = static_cast<int32_t>(std::pow(n_per_dim, Ndim));
+                   const std::array<uint8_t, Ndim>& wrapped_coordinates,
+                   const internal::TilingOptions<Ndim>& options = {}) {
+    const auto n_per_dim = tiles_per_dim(points.size(), points_per_tile, options);
+    const auto ntiles = static_cast<int32_t>(std::pow(n_per_dim, Ndim));
 
+    // with sparse storage only the occupied tiles are allocated, when filling the tiles
+    const auto nkeys = options.sparse ? 0 : ntiles;
     if (!tiles.has_value()) {
-      tiles = std::make_optional<internal::Tiles<Ndim, TDev>>(queue, points.size(), ntiles);
+      tiles = std::make_optional<internal::Tiles<Ndim, TDev>>(queue, points.size(), nkeys);
     }
+    tiles->setSparse(options.sparse);
     // check if tiles are large enough for current data
-    if ((tiles->extents().values < static_cast<std::size_t>(points.size())) or
-        (tiles->extents().keys < static_cast<std::size_t>(ntiles))) {
+    if ((tiles->capacity().values < static_cast<std::size_t>(points.size())) or
+        (tiles->capacity().keys < static_cast<std::size_t>(nkeys))) {
       tiles->initialize(queue, points.size(), ntiles, n_per_dim);
     } else {
       tiles->reset(points.size(), ntiles, n_per_dim);
     }
+    tiles->setOrder(queue, options.order);
 
-    auto min_max = make_host_buffer<internal::CoordinateExtremes<Ndim>>();
-    auto tile_sizes = make_host_buffer<float>(Ndim);
-    detail::compute_tile_size(queue,min_max.data(), tile_sizes.getMdSpan(), points, n_per_dim);
-
-    alpaka::onHost::memcpy(queue, tiles->m_minmax, min_max);
-    alpaka::onHost::memcpy(queue, tiles->m_minmax, tile_sizes);
-    alpaka::onHost::memcpy(queue, tiles->m_tilesizes, wrapped_coordinates);
+    if (options.domain.has_value()) {
+      tiles->setGeometry(queue, *options.domain);
+    } else {
+      tiles->invalidateGeometry();
+      detail::compute_tile_size(
+          queue, tiles->m_minmax.data(), tiles->m_tilesizes.data(), points, n_per_dim);
+    }
+    if (options.boundaries == TileBoundaries::Quantile) {
+      auto& quantiles = tiles->useQuantileEdges(queue);
+      detail::compute_quantile_edges(queue,
+                                     tiles->m_minmax.data(),
+                                     quantiles.histogram,
+                                     quantiles.edges.data(),
+                                     points,
+                                     n_per_dim);
+    } else {
+      tiles->useUniformEdges();
+    }
+    auto view = alpaka::makeView(wrapped_coordinates);
+    alpaka::onHost::memcpy(queue, tiles->m_wrapped, view, alpaka::Vec<uint8_t, 1>{Ndim});
   }
 
 }  // namespace clue::detail
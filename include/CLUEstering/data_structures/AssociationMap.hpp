@@ -5,10 +5,16 @@
 #pragma once
 
 #include "CLUEstering/data_structures/AssociationMapView.hpp"
+#include "CLUEstering/data_structures/internal/Arena.hpp"
 #include "CLUEstering/detail/concepts.hpp"
 #include "CLUEstering/internal/alpaka/memory.hpp"
+#include "CLUEstering/internal/alpaka/first_touch.hpp"
 #include "CLUEstering/data_structures/detail/AssociationMapBase.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <optional>
 #include <span>
+#include <utility>
 #include <alpaka/alpaka.hpp>
 #include "CLUEstering/data_structures/detail/AssociationMap.hpp"
 namespace clue {
@@ -34,14 +40,14 @@ namespace clue {
     HostAssociationMap(size_type nelements, size_type nbins)
         : Base(make_host_buffer<mapped_type>(nelements), make_host_buffer<key_type>(nbins + 1)) {
       Base::wire_view(nelements, nbins);
-      std::memset(Base::m_offsets.data(), 0, nbins * sizeof(key_type));
+      first_touch();
     }
 
     ALPAKA_FN_HOST void initialize(size_type nelements, size_type nbins) {
       Base::m_indexes = make_host_buffer<mapped_type>(nelements);
       Base::m_offsets = make_host_buffer<key_type>(nbins + 1);
       Base::wire_view(nelements, nbins);
-      std::memset(Base::m_offsets.data(), 0, nbins * sizeof(key_type));
+      first_touch();
     }
     template <concepts::Queue TQueue>
     ALPAKA_FN_HOST void fill(TQueue&, size_type size, std::span<key_type> associations) {
@@ -72,6 +78,14 @@ namespace clue {
         }
       }
     }
+
+  private:
+    // zero the buffers from the workers of the host backend, so that their pages are
+    // spread over the NUMA nodes of the workers
+    void first_touch() {
+      internal::first_touch_host_columns(Base::m_indexes.data(), Base::m_extents.values, 1);
+      internal::first_touch_host_columns(Base::m_offsets.data(), Base::m_extents.keys, 1);
+    }
   };
   template <typename TDev>
   class DevAssociationMap : public detail::AssociationMapBase<TDev> {
@@ -121,38 +135,48 @@ namespace clue {
 
     template <concepts::Queue TQueue, class TFunc>
     ALPAKA_FN_HOST void fill(TQueue& queue, size_type size, TFunc func) {
+      internal::Arena<TDev> arena;
+      fill(queue, arena, size, func);
+    }
+
+    /// @brief Fill the map from a function returning the key of each element, taking the
+    /// temporary buffers from an arena
+    ///
+    /// The temporary buffers are not released after the fill, and remain in use until
+    /// the arena is reset.
+    ///
+    /// @param queue The queue to enqueue the operations on
+    /// @param arena The arena providing the temporary buffers
+    /// @param size The number of elements to associate
+    /// @param func The function returning the key of an element, or a negative key
+    /// for unassociated elements
+    template <concepts::Queue TQueue, class TFunc>
+    ALPAKA_FN_HOST void fill(TQueue& queue,
+                             internal::Arena<TDev>& arena,
+                             size_type size,
+                             TFunc func) {
       auto exec = DevicePool::exec();
-      auto device = queue.getDevice();
       if (Base::m_extents.keys == 0)
         return;
       const int32_t nbins = static_cast<int32_t>(Base::m_extents.keys);
 
       // 1) Build per-element association/bin info
-      auto bin_buffer = make_device_buffer<int32_t>(device, std::size_t{size});
+      auto* bins = arena.template allocate<int32_t>(queue, size);
 
       constexpr auto blocksize = size_type{512};
       const auto gridsize = alpaka::divCeil(size, blocksize);
       const auto workdiv = alpaka::onHost::FrameSpec{gridsize, blocksize};
 
-      queue.enqueue(exec,
-                    workdiv,
-                    detail::KernelComputeAssociations<TFunc>{},
-                    size,
-                    bin_buffer.data(),
-                    nbins,
-                    func);
+      queue.enqueue(
+          exec, workdiv, detail::KernelComputeAssociations<TFunc>{}, size, bins, nbins, func);
 
       // 2) Compute per-key sizes (histogram-like)
-      auto sizes_buffer = make_device_buffer<int32_t>(device, size_type{Base::m_extents.keys});
-      alpaka::onHost::memset(queue, sizes_buffer, 0);
+      auto* sizes = arena.template allocate<int32_t>(queue, Base::m_extents.keys);
+      alpaka::onHost::memset(
+          queue, alpaka::makeView(queue.getDevice(), sizes, Vec1D{Base::m_extents.keys}), 0);
 
-      queue.enqueue(exec,
-                    workdiv,
-                    detail::KernelComputeAssociationSizes{},
-                    bin_buffer.data(),
-                    sizes_buffer.data(),
-                    nbins,
-                    size);
+      queue.enqueue(
+          exec, workdiv, detail::KernelComputeAssociationSizes{}, bins, sizes, nbins, size);
 
       // 3) Prefix scan -> offsets
       //    We want:
@@ -160,94 +184,142 @@ namespace clue {
       //      temp_offsets[i+1] = sum_{j<=i} sizes[j]
       //    This is exactly exclusiveScan(sizes) into temp_offsets+1.
 
-      auto temp_offsets = make_device_buffer<int32_t>(device, size_type{Base::m_extents.keys + 1});
-      alpaka::onHost::memset(queue, temp_offsets, int32_t{0}, Vec1D{1});
+      auto* temp_offsets = arena.template allocate<int32_t>(queue, Base::m_extents.keys + 1);
+      alpaka::onHost::memset(
+          queue, alpaka::makeView(queue.getDevice(), temp_offsets, Vec1D{1}), int32_t{0});
 
-      auto sizes_mdspan = alpaka::makeMdSpan(sizes_buffer.data(), Vec1D{Base::m_extents.keys});
-      auto offsets_mdspan =
-          alpaka::makeMdSpan(temp_offsets.data() + 1, Vec1D{Base::m_extents.keys});
+      auto sizes_mdspan = alpaka::makeMdSpan(sizes, Vec1D{Base::m_extents.keys});
+      auto offsets_mdspan = alpaka::makeMdSpan(temp_offsets + 1, Vec1D{Base::m_extents.keys});
 
       const auto scanBufferSize =
           alpaka::onHost::getScanBufferSize<int32_t>(sizes_mdspan.getExtents());
 
-      auto scan_buffer = make_device_buffer<std::byte>(device, Vec1D{scanBufferSize});
+      auto scan_buffer = alpaka::makeView(queue.getDevice(),
+                                          arena.template allocate<std::byte>(queue, scanBufferSize),
+                                          Vec1D{scanBufferSize});
       alpaka::onHost::inclusiveScan(queue, exec, scan_buffer, offsets_mdspan, sizes_mdspan);
 
       // 4) Copy offsets into Base storage
       alpaka::onHost::memcpy(
           queue,
-          alpaka::makeView(device, Base::m_offsets.data(), Vec1D{Base::m_extents.keys + 1}),
-          temp_offsets);
+          alpaka::makeView(queue.getDevice(), Base::m_offsets.data(), Vec1D{Base::m_extents.keys + 1}),
+          alpaka::makeView(queue.getDevice(), temp_offsets, Vec1D{Base::m_extents.keys + 1}));
       // 5) Fill associator indices using computed offsets
       queue.enqueue(exec,
                     workdiv,
                     detail::KernelFillAssociator{},
                     Base::m_indexes.data(),
-                    bin_buffer.data(),
-                    temp_offsets.data(),
+                    bins,
+                    temp_offsets,
                     nbins,
                     size);
       alpaka::onHost::wait(queue);
     }
 
+    /// @brief Fill the map from the key associated to each element, without waiting for
+    /// the operations enqueued on the queue to complete
+    ///
+    /// The temporary buffers used for the counting and the scan are kept by the map and
+    /// reused by the following fills, so that repeated fills don't allocate.
+    ///
+    /// @param queue The queue to enqueue the operations on
+    /// @param size The number of elements to associate
+    /// @param associations The device span containing the key of each element,
+    /// where negative keys mark unassociated elements
     template <concepts::Queue TQueue>
-    ALPAKA_FN_HOST void fill(TQueue& queue,
-                             size_type size,
-                             std::span<const key_type> associations) {
-
-      auto exec = DevicePool::exec();
-      if (Base::m_extents.keys == 0)
+    ALPAKA_FN_HOST void fill_async(TQueue& queue,
+                                   size_type size,
+                                   std::span<const key_type> associations) {
+      if (Base::m_extents.keys == 0) {
+        alpaka::onHost::memset(
+            queue, alpaka::makeView(queue.getDevice(), Base::m_offsets.data(), Vec1D{1}), 0);
         return;
+      }
+      auto exec = DevicePool::exec();
       const int32_t nbins = static_cast<int32_t>(Base::m_extents.keys);
       constexpr size_type blockSize = 512;
       const size_type gridSize = alpaka::divCeil(size, blockSize);
       const auto frameSpec = alpaka::onHost::FrameSpec(gridSize, blockSize);
 
-      auto sizes_buffer =
-          make_device_buffer<key_type>(queue.getDevice(), size_type{Base::m_extents.keys});
-      alpaka::onHost::memset(queue, sizes_buffer, 0);
+      const auto scanBufferSize =
+          alpaka::onHost::getScanBufferSize<key_type>(Vec1D{Base::m_extents.keys});
+      reserve_scratch(queue, scanBufferSize);
+      auto sizes_mdspan = alpaka::makeMdSpan(m_scratch->sizes.data(), Vec1D{Base::m_extents.keys});
+
+      alpaka::onHost::memset(
+          queue,
+          alpaka::makeView(queue.getDevice(), m_scratch->sizes.data(), Vec1D{Base::m_extents.keys}),
+          0);
       queue.enqueue(exec,
                     frameSpec,
                     detail::KernelComputeAssociationSizes{},
                     associations.data(),
-                    sizes_buffer.data(),
+                    m_scratch->sizes.data(),
                     nbins,
                     size);
 
-      auto block_counter = make_device_buffer<int32_t>(queue.getDevice());
-      alpaka::onHost::memset(queue, block_counter, 0);
-
-      // Allocate output offsets (size = keys + 1)
-      auto temp_offsets = make_device_buffer<key_type>(queue.getDevice(), Base::m_extents.keys + 1);
-
-      // temp_offsets[0] = 0
-      alpaka::onHost::memset(queue, temp_offsets, key_type{0}, Vec1D{1});
-      // Create mdspans
-      auto sizes_mdspan = alpaka::makeMdSpan(sizes_buffer.data(), Vec1D{Base::m_extents.keys});
-
+      // the offsets are the inclusive scan of the sizes, shifted by one
+      alpaka::onHost::memset(
+          queue, alpaka::makeView(queue.getDevice(), Base::m_offsets.data(), Vec1D{1}), 0);
       auto offsets_mdspan =
-          alpaka::makeMdSpan(temp_offsets.data() + 1, Vec1D{Base::m_extents.keys});
-
-      auto scanBufferSize = alpaka::onHost::getScanBufferSize<key_type>(sizes_mdspan.getExtents());
-
-      auto scan_buffer = make_device_buffer<std::byte>(queue.getDevice(), Vec1D{scanBufferSize});
-
-      alpaka::onHost::inclusiveScan(queue, exec, scan_buffer, offsets_mdspan, sizes_mdspan);
+          alpaka::makeMdSpan(Base::m_offsets.data() + 1, Vec1D{Base::m_extents.keys});
+      alpaka::onHost::inclusiveScan(
+          queue, exec, m_scratch->scan, offsets_mdspan, sizes_mdspan);
 
+      // the fill kernel advances a copy of the offsets as the elements are placed
       alpaka::onHost::memcpy(
           queue,
           alpaka::makeView(
-              queue.getDevice(), Base::m_offsets.data(), Vec1D{Base::m_extents.keys + 1}),
-          temp_offsets);
+              queue.getDevice(), m_scratch->cursors.data(), Vec1D{Base::m_extents.keys + 1}),
+          alpaka::makeView(
+              queue.getDevice(), Base::m_offsets.data(), Vec1D{Base::m_extents.keys + 1}));
       queue.enqueue(exec,
                     frameSpec,
                     detail::KernelFillAssociator{},
                     Base::m_indexes.data(),
                     associations.data(),
-                    temp_offsets.data(),
+                    m_scratch->cursors.data(),
                     nbins,
                     size);
+    }
+
+    template <concepts::Queue TQueue>
+    ALPAKA_FN_HOST void fill(TQueue& queue,
+                             size_type size,
+                             std::span<const key_type> associations) {
+      fill_async(queue, size, associations);
       alpaka::onHost::wait(queue);
     }
+
+  private:
+    using scan_container_type =
+        decltype(make_device_buffer<std::byte>(std::declval<TDev>(), std::declval<size_type>()));
+
+    struct Scratch {
+      getBufferType<TDev, key_type> sizes;
+      getBufferType<TDev, key_type> cursors;
+      scan_container_type scan;
+      size_type keys;
+      size_type scan_bytes;
+    };
+    std::optional<Scratch> m_scratch;
+
+    // Make sure that the temporary buffers of the fill can hold the current number of keys
+    template <concepts::Queue TQueue>
+    ALPAKA_FN_HOST void reserve_scratch(TQueue& queue, size_type scan_bytes) {
+      const auto keys = Base::m_extents.keys;
+      if (m_scratch.has_value() && m_scratch->keys >= keys && m_scratch->scan_bytes >= scan_bytes) {
+        return;
+      }
+      const auto capacity = std::max(keys, m_scratch.has_value() ? m_scratch->keys : size_type{0});
+      const auto scan_capacity =
+          std::max(scan_bytes, m_scratch.has_value() ? m_scratch->scan_bytes : size_type{0});
+      m_scratch.reset();
+      m_scratch.emplace(Scratch{make_device_buffer<key_type>(queue.getDevice(), size_type{capacity}),
+                                make_device_buffer<key_type>(queue.getDevice(), size_type{capacity + 1}),
+                                make_device_buffer<std::byte>(queue.getDevice(), size_type{scan_capacity}),
+                                capacity,
+                                scan_capacity});
+    }
   };
 }  // namespace clue
@@ -19,6 +19,8 @@ namespace clue {
   /// @param queue The queue used for the device operations
   /// @param h_points The points allocated on the host, where the clustering results will be saved
   /// @param d_points The points allocated on the device, where the clustering has been run
+  /// @note When the decision graph has been stored, the local densities and the distances
+  /// from the nearest highers are copied too
   template <concepts::Queue TQueue, std::size_t Ndim>
   void copyToHost(TQueue& queue,
                   PointsHost<Ndim>& h_points,
@@ -47,6 +47,24 @@ namespace clue {
       alpaka::onHost::memcpy(queue, dst, src);
     }
 
+    // densities and distances from the nearest highers, only when the distances are stored
+    if (d_points.m_view.delta != nullptr) {
+      if (!h_points.m_rho.has_value()) {
+        const auto n_points = static_cast<std::size_t>(h_points.m_size);
+        h_points.m_rho.emplace(make_host_buffer<float>(n_points));
+        h_points.m_delta.emplace(make_host_buffer<float>(n_points));
+      }
+      alpaka::onHost::memcpy(queue,
+                             alpaka::makeView(alpaka::api::host, h_points.m_rho->data(), extent),
+                             alpaka::makeView(queue, d_points.m_view.rho, extent));
+      alpaka::onHost::memcpy(queue,
+                             alpaka::makeView(alpaka::api::host, h_points.m_delta->data(), extent),
+                             alpaka::makeView(queue, d_points.m_view.delta, extent));
+    } else {
+      h_points.m_rho.reset();
+      h_points.m_delta.reset();
+    }
+
     // Make host-side data immediately usable
     alpaka::onHost::wait(queue);
 
@@ -109,6 +127,12 @@ namespace clue {
   /// @brief The PointsDevice class is a data structure that manages points on a device.
   /// It provides methods to allocate, access, and manipulate points in device memory.
   ///
+  /// Besides the points, the container holds the densities, the nearest higher of each point
+  /// and a bitset of the seeds computed by the clustering. Defining CLUE_LOW_MEMORY, the
+  /// nearest highers are stored in the column of the cluster indexes, saving a column of
+  /// 32 bits integers. The mode is fixed when the points are constructed and stored with
+  /// them, so points constructed with and without CLUE_LOW_MEMORY can be used together.
+  ///
   /// @tparam Ndim The number of dimensions of the points to manage
   /// @tparam TDev The device type to use for the allocation. Defaults to clue::Device.
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
@@ -117,9 +141,12 @@ namespace clue {
     getBufferType<TDev, std::byte> m_buffer;
     TDev m_device;
     PointsView<Ndim> m_view;
+    std::optional<getBufferType<TDev, float>> m_delta;
     std::optional<std::size_t> m_nclusters;
     bool m_clustered = false;
     int32_t m_size;
+    // whether the nearest highers share the column of the cluster indexes
+    bool m_lowMemory;
     /// @brief Construct a PointsDevice object
     ///
     /// @param device The device where points are allocated
@@ -130,6 +157,9 @@ namespace clue {
 
     /// @brief Construct a PointsDevice object with a pre-allocated buffer
     ///
+    /// The buffer holds one column per coordinate, followed by the weights and the cluster
+    /// indexes, each padded to a multiple of 64 bytes. Its size is given by soa::device::computeSoASize.
+    ///
     /// @param device The device where points are allocated
     /// @param dim The number of dimensions of the points to manage
     /// @param n_points The number of points to allocate
@@ -185,6 +215,9 @@ namespace clue {
 
     /// @brief Construct a PointsDevice object with a pre-allocated buffer
     ///
+    /// The buffer holds one column per coordinate, followed by the weights and the cluster
+    /// indexes, each padded to a multiple of 64 bytes. Its size is given by soa::device::computeSoASize.
+    ///
     /// @param device device where points are allocated
     /// @param dim The number of dimensions of the points to manage
     /// @param n_points The number of points to allocate
@@ -234,15 +267,30 @@ namespace clue {
     ALPAKA_FN_HOST auto& view();
 #endif
 
+    /// @brief Returns the local densities of the points
     ALPAKA_FN_HOST auto rho() const;
     ALPAKA_FN_HOST auto rho();
 
+    /// @brief Returns the distances of the points from their nearest higher
+    ///
+    /// The distances are only stored when requested with Clusterer::setDecisionGraph,
+    /// otherwise the span is empty. The points without a nearest higher have the largest
+    /// float as distance.
     ALPAKA_FN_HOST auto delta() const;
     ALPAKA_FN_HOST auto delta();
 
+    /// @brief Returns the indexes of the nearest points with higher density
+    ///
+    /// The seeds and the points without a nearest higher have index -1.
+    /// @note When the points are constructed with CLUE_LOW_MEMORY the nearest highers share
+    /// the storage of the cluster indexes, so after the clustering this span contains the
+    /// cluster indexes
     ALPAKA_FN_HOST auto nearestHigher() const;
     ALPAKA_FN_HOST auto nearestHigher();
 
+    /// @brief Returns the bitset marking the seeds, as a span of 32 bits words
+    ///
+    /// The point i is a seed if the bit i % 32 of the word i / 32 is set.
     ALPAKA_FN_HOST auto isSeed() const;
     ALPAKA_FN_HOST auto isSeed();
 
@@ -256,6 +304,7 @@ namespace clue {
     inline static constexpr std::size_t Ndim_ = Ndim;
 
     void mark_clustered() { m_clustered = true; }
+    void store_delta(bool store);
 
     template <concepts::Queue _TQueue, std::size_t _Ndim>
     friend class Clusterer;
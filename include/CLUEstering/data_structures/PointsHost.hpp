@@ -8,9 +8,11 @@
 #include "CLUEstering/data_structures/internal/PointsCommon.hpp"
 #include "CLUEstering/detail/concepts.hpp"
 #include "CLUEstering/internal/alpaka/memory.hpp"
+#include "CLUEstering/internal/io/MappedFile.hpp"
 #include "CLUEstering/detail/Dim.hpp"
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <optional>
 #include <ranges>
 #include <string>
@@ -20,7 +22,7 @@
 namespace clue {
 
   template <std::size_t NDim>
-  ::clue::PointsHost<NDim> read_output(const std::string& file_path);
+  ::clue::PointsHost<NDim> read_output(Dim<NDim> dim, const std::string& file_path);
 
   template <concepts::Queue TQueue, std::size_t Ndim>
   void copyToHost(TQueue& queue,
@@ -48,6 +50,9 @@ namespace clue {
     std::optional<std::size_t> m_nclusters;
     PointsView<Ndim> m_view;
     std::optional<ALPAKA_TYPEOF(make_host_buffer<std::byte>(std::size_t{}))> m_buffer;
+    std::optional<ALPAKA_TYPEOF(make_host_buffer<float>(std::size_t{}))> m_rho;
+    std::optional<ALPAKA_TYPEOF(make_host_buffer<float>(std::size_t{}))> m_delta;
+    std::optional<internal::MappedFile> m_file;
     int32_t m_size;
     bool m_clustered = false;
 
@@ -73,6 +78,9 @@ namespace clue {
 
     /// @brief Constructs a container for the points allocated on the host using a pre-allocated buffers
     ///
+    /// The buffer holds one column per coordinate, followed by the weights and the cluster
+    /// indexes, each padded to a multiple of 64 bytes. Its size is given by soa::host::computeSoASize.
+    ///
     /// @param dim The number of dimensions of the points to manage
     /// @param n_points The number of points
     /// @param buffer The pre-allocated buffer to use for the points data
@@ -137,6 +145,19 @@ namespace clue {
     requires(sizeof...(TBuffers) == Ndim + 2 and Ndim > 1)
         PointsHost(Dim<Ndim> dim,int32_t n_points, TBuffers... buffers);
 
+    /// @brief Constructs a container for the points stored in a binary file
+    ///
+    /// The file is memory-mapped and its columns are used directly as the storage of the points,
+    /// so no data is read until it is accessed. The mapping is private, so modifying the points,
+    /// for instance by clustering them, doesn't modify the file.
+    /// If the file contains no cluster index column, the cluster indexes are allocated separately.
+    ///
+    /// @param dim The number of dimensions of the points to manage
+    /// @param file_path The path of the binary file, as written by write_binary
+    /// @throw std::runtime_error if the file can't be read or is not a valid binary file
+    /// @throw std::invalid_argument if the points in the file have a different number of dimensions
+    PointsHost(Dim<Ndim> dim, const std::filesystem::path& file_path);
+
     PointsHost(const PointsHost&) = delete;
     PointsHost& operator=(const PointsHost&) = delete;
     PointsHost(PointsHost&&) = default;
@@ -178,6 +199,22 @@ namespace clue {
     ALPAKA_FN_HOST auto& view();
 #endif
 
+    /// @brief Returns the local densities of the points
+    ///
+    /// The densities are only copied from the device when the clusterer stores the distances
+    /// from the nearest highers, requested with Clusterer::setDecisionGraph. Otherwise the
+    /// span is empty.
+    /// @return A const span of the densities of the points
+    std::span<const float> rho() const;
+    /// @brief Returns the distances of the points from their nearest higher
+    ///
+    /// Together with the densities they form the decision graph, which helps choosing the
+    /// parameters of the clustering. The span is empty unless requested with
+    /// Clusterer::setDecisionGraph. The points without a nearest higher have the largest
+    /// float as distance.
+    /// @return A const span of the distances of the points
+    std::span<const float> delta() const;
+
     /// @brief Returns the Point object at the specified index
     ///
     /// @param idx The index of the point to retrieve
@@ -221,8 +258,8 @@ namespace clue {
                              PointsDevice<DevType<_TQueue>,_Ndim>& d_points,
                              const PointsHost<_Ndim>& h_points);
     friend struct internal::points_interface<PointsHost<Ndim>>;
-    template <std::size_t NDim, concepts::Queue TQueue>
-    friend PointsHost<NDim> read_output(TQueue& queue, const std::string& file_path);
+    template <std::size_t NDim>
+    friend PointsHost<NDim> read_output(Dim<NDim> dim, const std::string& file_path);
   };
 
 }  // namespace clue
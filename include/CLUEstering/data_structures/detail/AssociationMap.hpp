@@ -19,10 +19,9 @@ namespace clue {
                  acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{size})) {
           int32_t bin = func(i);
 
-          // Debug hardening (keep behind #ifdef if you want)
+          // elements outside of the range of keys are left unassociated
           if (bin < -1 || bin >= nbins) {
-            printf("BAD BIN i=%d bin=%d nbins=%d\n", static_cast<int>(i), bin, nbins);
-            bin = -1;  // or __builtin_trap();
+            bin = -1;
           }
 
           associations[i] = bin;
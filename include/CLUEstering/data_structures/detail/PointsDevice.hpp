@@ -7,6 +7,7 @@
 #include "CLUEstering/internal/algorithm/reduce/reduce.hpp"
 #include "CLUEstering/internal/alpaka/memory.hpp"
 #include "CLUEstering/internal/meta/apply.hpp"
+#include "CLUEstering/internal/alpaka/first_touch.hpp"
 #include "CLUEstering/internal/alpaka/minMax.hpp"
 #include <alpaka/alpaka.hpp>
 #include <cassert>
@@ -21,13 +22,57 @@ namespace clue {
 
   namespace soa::device {
 
+    // Whether the points constructed in this translation unit are in low-memory mode. The
+    // constant has internal linkage and is only read by the constructors, which store the
+    // mode with the points, so that the layout of the buffers doesn't depend on the
+    // settings of the translation units using them
+#ifdef CLUE_LOW_MEMORY
+    constexpr bool low_memory_mode = true;
+#else
+    constexpr bool low_memory_mode = false;
+#endif
+
+    // Number of columns holding the temporary results of the clustering, besides the bitset
+    // of the seeds. In low-memory mode the nearest highers share the column of the cluster
+    // indexes, which are only written once the nearest highers are no longer needed
+    inline constexpr std::size_t n_temp_columns(bool low_memory) { return low_memory ? 1 : 2; }
+
+    // Size in bytes of a column of the points, including the padding to the alignment
+    template <std::size_t Ndim>
+    inline std::size_t computeColumnStride(int32_t n_points) {
+      return static_cast<std::size_t>(computeAlignSoASize(n_points)) * sizeof(float);
+    }
+
+    // Size in bytes of the temporary results of the clustering
     template <std::size_t Ndim>
-    inline auto computeSoASize(Dim<Ndim>/**unused **/,int32_t n_points) {
+    inline std::size_t computeTempSize(int32_t n_points, bool low_memory) {
+      return n_temp_columns(low_memory) * computeColumnStride<Ndim>(n_points) +
+             static_cast<std::size_t>(computeSeedMaskSize(n_points)) * sizeof(uint32_t);
+    }
+
+    template <std::size_t Ndim>
+    inline auto computeSoASize(Dim<Ndim>/**unused **/,int32_t n_points,
+                               bool low_memory = low_memory_mode) {
       if (n_points <= 0) {
         throw std::invalid_argument(
             "Number of points passed to PointsDevice constructor must be positive.");
       }
-      return ((Ndim + 2) * sizeof(float) + 3 * sizeof(int)) * n_points;
+      return (Ndim + 2) * computeColumnStride<Ndim>(n_points) +
+             computeTempSize<Ndim>(n_points, low_memory);
+    }
+
+    // Place the temporary results of the clustering in a buffer of computeTempSize bytes.
+    // The cluster indexes must have already been placed
+    template <std::size_t Ndim>
+    inline void partitionTempSoAView(PointsView<Ndim>& view,
+                                     std::byte* buffer,
+                                     int32_t n_points,
+                                     bool low_memory) {
+      const auto stride = computeColumnStride<Ndim>(n_points);
+      view.rho = reinterpret_cast<float*>(buffer);
+      view.nearest_higher =
+          low_memory ? view.cluster_index : reinterpret_cast<int*>(buffer + stride);
+      view.is_seed = reinterpret_cast<uint32_t*>(buffer + n_temp_columns(low_memory) * stride);
     }
     template <concepts::Queue TQueue, std::size_t Ndim>
     void copyToHost(TQueue& queue,
@@ -39,36 +84,39 @@ namespace clue {
                       PointsDevice<DevType<TQueue>,Ndim>& d_points,
                       const PointsHost<Ndim>& h_points);
     template <std::size_t Ndim>
-    inline void partitionSoAView(PointsView<Ndim>& view, std::byte* buffer, int32_t n_points) {
+    inline void partitionSoAView(PointsView<Ndim>& view,
+                                 std::byte* buffer,
+                                 int32_t n_points,
+                                 bool low_memory) {
+      const auto stride = computeColumnStride<Ndim>(n_points);
       meta::apply<Ndim>([&]<std::size_t Dim>() {
-        view.coords[Dim] = reinterpret_cast<float*>(buffer + Dim * n_points * sizeof(float));
+        view.coords[Dim] = reinterpret_cast<float*>(buffer + Dim * stride);
       });
-      view.weight = reinterpret_cast<float*>(buffer + Ndim * n_points * sizeof(float));
-      view.cluster_index = reinterpret_cast<int*>(buffer + (Ndim + 1) * n_points * sizeof(float));
-      view.is_seed = reinterpret_cast<int*>(buffer + (Ndim + 2) * n_points * sizeof(float));
-      view.rho = reinterpret_cast<float*>(buffer + (Ndim + 3) * n_points * sizeof(float));
-      view.nearest_higher = reinterpret_cast<int*>(buffer + (Ndim + 4) * n_points * sizeof(float));
+      view.weight = reinterpret_cast<float*>(buffer + Ndim * stride);
+      view.cluster_index = reinterpret_cast<int*>(buffer + (Ndim + 1) * stride);
+      partitionTempSoAView(view, buffer + (Ndim + 2) * stride, n_points, low_memory);
       view.n = n_points;
     }
     template <std::size_t Ndim>
     inline void partitionSoAView(PointsView<Ndim>& view,
                                  std::byte* alloc_buffer,
                                  std::byte* buffer,
-                                 int32_t n_points) {
+                                 int32_t n_points,
+                                 bool low_memory) {
+      const auto stride = computeColumnStride<Ndim>(n_points);
       meta::apply<Ndim>([&]<std::size_t Dim>() {
-        view.coords[Dim] = reinterpret_cast<float*>(buffer + Dim * n_points * sizeof(float));
+        view.coords[Dim] = reinterpret_cast<float*>(buffer + Dim * stride);
       });
-      view.weight = reinterpret_cast<float*>(buffer + Ndim * n_points * sizeof(float));
-      view.cluster_index = reinterpret_cast<int*>(buffer + (Ndim + 1) * n_points * sizeof(float));
-      view.is_seed = reinterpret_cast<int*>(alloc_buffer);
-      view.rho = reinterpret_cast<float*>(alloc_buffer + n_points * sizeof(float));
-      view.nearest_higher = reinterpret_cast<int*>(alloc_buffer + 2 * n_points * sizeof(float));
+      view.weight = reinterpret_cast<float*>(buffer + Ndim * stride);
+      view.cluster_index = reinterpret_cast<int*>(buffer + (Ndim + 1) * stride);
+      partitionTempSoAView(view, alloc_buffer, n_points, low_memory);
       view.n = n_points;
     }
     template <std::size_t Ndim>
     inline void partitionSoAView(PointsView<Ndim>& view,
                                  std::byte* alloc_buffer,
                                  int32_t n_points,
+                                 bool low_memory,
                                  std::span<float> coordinates,
                                  std::span<float> weights,
                                  std::span<int> output) {
@@ -76,15 +124,14 @@ namespace clue {
           [&]<std::size_t Dim>() { view.coords[Dim] = coordinates.data() + Dim * n_points; });
       view.weight = weights.data();
       view.cluster_index = output.data();
-      view.is_seed = reinterpret_cast<int*>(alloc_buffer);
-      view.rho = reinterpret_cast<float*>(alloc_buffer + n_points * sizeof(float));
-      view.nearest_higher = reinterpret_cast<int*>(alloc_buffer + 2 * n_points * sizeof(float));
+      partitionTempSoAView(view, alloc_buffer, n_points, low_memory);
       view.n = n_points;
     }
     template <std::size_t Ndim, concepts::Pointer... TBuffers>
     requires(sizeof...(TBuffers) == 3) inline void partitionSoAView(PointsView<Ndim>& view,
                                                                     std::byte* alloc_buffer,
                                                                     int32_t n_points,
+                                                                    bool low_memory,
                                                                     TBuffers... buffer) {
       auto buffers_tuple = std::make_tuple(buffer...);
 
@@ -93,15 +140,14 @@ namespace clue {
       });
       view.weight = std::get<1>(buffers_tuple);
       view.cluster_index = std::get<2>(buffers_tuple);
-      view.is_seed = reinterpret_cast<int*>(alloc_buffer);
-      view.rho = reinterpret_cast<float*>(alloc_buffer + n_points * sizeof(float));
-      view.nearest_higher = reinterpret_cast<int*>(alloc_buffer + 2 * n_points * sizeof(float));
+      partitionTempSoAView(view, alloc_buffer, n_points, low_memory);
       view.n = n_points;
     }
     template <std::size_t Ndim>
     inline void partitionSoAView(PointsView<Ndim>& view,
                                  std::byte* alloc_buffer,
                                  int32_t n_points,
+                                 bool low_memory,
                                  std::span<float> input,
                                  std::span<int> output) {
       meta::apply<Ndim>([&]<std::size_t Dim>() {
@@ -109,15 +155,14 @@ namespace clue {
       });
       view.weight = input.data() + Ndim * n_points;
       view.cluster_index = output.data();
-      view.is_seed = reinterpret_cast<int*>(alloc_buffer);
-      view.rho = reinterpret_cast<float*>(alloc_buffer + n_points * sizeof(float));
-      view.nearest_higher = reinterpret_cast<int*>(alloc_buffer + 2 * n_points * sizeof(float));
+      partitionTempSoAView(view, alloc_buffer, n_points, low_memory);
       view.n = n_points;
     }
     template <std::size_t Ndim, concepts::Pointer... TBuffers>
     requires(sizeof...(TBuffers) == 2) inline void partitionSoAView(PointsView<Ndim>& view,
                                                                     std::byte* alloc_buffer,
                                                                     int32_t n_points,
+                                                                    bool low_memory,
                                                                     TBuffers... buffers) {
       auto buffers_tuple = std::make_tuple(buffers...);
 
@@ -126,14 +171,16 @@ namespace clue {
       });
       view.weight = std::get<0>(buffers_tuple) + Ndim * n_points;
       view.cluster_index = std::get<1>(buffers_tuple);
-      view.is_seed = reinterpret_cast<int*>(alloc_buffer);
-      view.rho = reinterpret_cast<float*>(alloc_buffer + n_points * sizeof(float));
-      view.nearest_higher = reinterpret_cast<int*>(alloc_buffer + 2 * n_points * sizeof(float));
+      partitionTempSoAView(view, alloc_buffer, n_points, low_memory);
       view.n = n_points;
     }
     template <std::size_t Ndim, concepts::Pointer... TBuffers>
     requires(sizeof...(TBuffers) == Ndim + 2 and Ndim > 1) inline void partitionSoAView(
-        PointsView<Ndim>& view, std::byte* alloc_buffer, int32_t n_points, TBuffers... buffers) {
+        PointsView<Ndim>& view,
+        std::byte* alloc_buffer,
+        int32_t n_points,
+        bool low_memory,
+        TBuffers... buffers) {
       auto buffers_tuple = std::make_tuple(buffers...);
 
       meta::apply<Ndim>([&]<std::size_t Dim>() {
@@ -141,9 +188,7 @@ namespace clue {
       });
       view.weight = std::get<Ndim>(buffers_tuple) + Ndim * n_points;
       view.cluster_index = std::get<Ndim + 1>(buffers_tuple);
-      view.is_seed = reinterpret_cast<int*>(alloc_buffer);
-      view.rho = reinterpret_cast<float*>(alloc_buffer + n_points * sizeof(float));
-      view.nearest_higher = reinterpret_cast<int*>(alloc_buffer + 2 * n_points * sizeof(float));
+      partitionTempSoAView(view, alloc_buffer, n_points, low_memory);
       view.n = n_points;
     }
 
@@ -151,23 +196,39 @@ namespace clue {
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
   inline PointsDevice<TDev,Ndim>::PointsDevice(TDev& device,Dim<Ndim> dim, int32_t n_points)
-      : m_buffer{make_device_buffer<std::byte>(device,
-                                               soa::device::computeSoASize(dim,n_points))},
+      : m_buffer{make_device_buffer<std::byte>(
+            device, soa::device::computeSoASize(dim, n_points, soa::device::low_memory_mode))},
         m_device(device),
         m_view{},
-        m_size{n_points} {
-    soa::device::partitionSoAView<Ndim>(m_view, m_buffer.data(), n_points);
+        m_size{n_points},
+        m_lowMemory{soa::device::low_memory_mode} {
+    if constexpr (concepts::HostApi<TDev>) {
+      internal::first_touch_columns(get_queue(device),
+                                    reinterpret_cast<float*>(m_buffer.data()),
+                                    computeAlignSoASize(n_points),
+                                    Ndim + 2 + soa::device::n_temp_columns(m_lowMemory));
+    }
+    soa::device::partitionSoAView<Ndim>(m_view, m_buffer.data(), n_points, m_lowMemory);
   }
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
   inline PointsDevice<TDev,Ndim>::PointsDevice(TDev& device, Dim<Ndim> dim,
                                                 int32_t n_points,
                                                 std::span<std::byte> buffer)
-      : m_buffer{make_device_buffer<std::byte>(device, 3 * n_points * sizeof(float))},
+      : m_buffer{make_device_buffer<std::byte>(
+            device, soa::device::computeTempSize<Ndim>(n_points, soa::device::low_memory_mode))},
         m_device(device),
         m_view{},
-        m_size{n_points} {
-    soa::device::partitionSoAView<Ndim>(m_view, m_buffer.data(), buffer.data(), n_points);
+        m_size{n_points},
+        m_lowMemory{soa::device::low_memory_mode} {
+    if constexpr (concepts::HostApi<TDev>) {
+      internal::first_touch_columns(get_queue(device),
+                                    reinterpret_cast<float*>(m_buffer.data()),
+                                    computeAlignSoASize(n_points),
+                                    soa::device::n_temp_columns(m_lowMemory));
+    }
+    soa::device::partitionSoAView<Ndim>(
+        m_view, m_buffer.data(), buffer.data(), n_points, m_lowMemory);
   }
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
@@ -175,11 +236,20 @@ namespace clue {
                                                 int32_t n_points,
                                                 std::span<float> input,
                                                 std::span<int> output)
-      : m_buffer{make_device_buffer<std::byte>(device, 3 * n_points * sizeof(float))},
+      : m_buffer{make_device_buffer<std::byte>(
+            device, soa::device::computeTempSize<Ndim>(n_points, soa::device::low_memory_mode))},
         m_device(device),
         m_view{},
-        m_size{n_points} {
-    soa::device::partitionSoAView<Ndim>(m_view, m_buffer.data(), n_points, input, output);
+        m_size{n_points},
+        m_lowMemory{soa::device::low_memory_mode} {
+    if constexpr (concepts::HostApi<TDev>) {
+      internal::first_touch_columns(get_queue(device),
+                                    reinterpret_cast<float*>(m_buffer.data()),
+                                    computeAlignSoASize(n_points),
+                                    soa::device::n_temp_columns(m_lowMemory));
+    }
+    soa::device::partitionSoAView<Ndim>(
+        m_view, m_buffer.data(), n_points, m_lowMemory, input, output);
   }
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
@@ -188,12 +258,20 @@ namespace clue {
                                                 std::span<float> coordinates,
                                                 std::span<float> weights,
                                                 std::span<int> output)
-      : m_buffer{make_device_buffer<std::byte>(device, 3 * n_points * sizeof(float))},
+      : m_buffer{make_device_buffer<std::byte>(
+            device, soa::device::computeTempSize<Ndim>(n_points, soa::device::low_memory_mode))},
         m_device(device),
         m_view{},
-        m_size{n_points} {
+        m_size{n_points},
+        m_lowMemory{soa::device::low_memory_mode} {
+    if constexpr (concepts::HostApi<TDev>) {
+      internal::first_touch_columns(get_queue(device),
+                                    reinterpret_cast<float*>(m_buffer.data()),
+                                    computeAlignSoASize(n_points),
+                                    soa::device::n_temp_columns(m_lowMemory));
+    }
     soa::device::partitionSoAView<Ndim>(
-        m_view, m_buffer.data(), n_points, coordinates, weights, output);
+        m_view, m_buffer.data(), n_points, m_lowMemory, coordinates, weights, output);
   }
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
@@ -201,22 +279,39 @@ namespace clue {
                                                 int32_t n_points,
                                                 float* input,
                                                 int* output)
-      : m_buffer{make_device_buffer<std::byte>(device, 3 * n_points * sizeof(float))},
+      : m_buffer{make_device_buffer<std::byte>(
+            device, soa::device::computeTempSize<Ndim>(n_points, soa::device::low_memory_mode))},
         m_device(device),
         m_view{},
-        m_size{n_points} {
-    soa::device::partitionSoAView<Ndim>(m_view, m_buffer.data(), n_points, input, output);
+        m_size{n_points},
+        m_lowMemory{soa::device::low_memory_mode} {
+    if constexpr (concepts::HostApi<TDev>) {
+      internal::first_touch_columns(get_queue(device),
+                                    reinterpret_cast<float*>(m_buffer.data()),
+                                    computeAlignSoASize(n_points),
+                                    soa::device::n_temp_columns(m_lowMemory));
+    }
+    soa::device::partitionSoAView<Ndim>(
+        m_view, m_buffer.data(), n_points, m_lowMemory, input, output);
   }
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
   inline PointsDevice<TDev,Ndim>::PointsDevice(
       TDev& device,Dim<Ndim> dim, int32_t n_points, float* coordinates, float* weights, int* output)
-      : m_buffer{make_device_buffer<std::byte>(device, 3 * n_points * sizeof(float))},
+      : m_buffer{make_device_buffer<std::byte>(
+            device, soa::device::computeTempSize<Ndim>(n_points, soa::device::low_memory_mode))},
         m_device(device),
         m_view{},
-        m_size{n_points} {
+        m_size{n_points},
+        m_lowMemory{soa::device::low_memory_mode} {
+    if constexpr (concepts::HostApi<TDev>) {
+      internal::first_touch_columns(get_queue(device),
+                                    reinterpret_cast<float*>(m_buffer.data()),
+                                    computeAlignSoASize(n_points),
+                                    soa::device::n_temp_columns(m_lowMemory));
+    }
     soa::device::partitionSoAView<Ndim>(
-        m_view, m_buffer.data(), n_points, coordinates, weights, output);
+        m_view, m_buffer.data(), n_points, m_lowMemory, coordinates, weights, output);
   }
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
@@ -225,11 +320,20 @@ namespace clue {
            Ndim > 1) inline PointsDevice<TDev,Ndim>::PointsDevice(TDev& device, Dim<Ndim> dim,
                                                                    int32_t n_points,
                                                                    TBuffers... buffers)
-      : m_buffer{make_device_buffer<std::byte>(device, 3 * n_points * sizeof(float))},
+      : m_buffer{make_device_buffer<std::byte>(
+            device, soa::device::computeTempSize<Ndim>(n_points, soa::device::low_memory_mode))},
         m_device(device),
         m_view{},
-        m_size{n_points} {
-    soa::device::partitionSoAView<Ndim>(m_view, m_buffer.data(), n_points, buffers...);
+        m_size{n_points},
+        m_lowMemory{soa::device::low_memory_mode} {
+    if constexpr (concepts::HostApi<TDev>) {
+      internal::first_touch_columns(get_queue(device),
+                                    reinterpret_cast<float*>(m_buffer.data()),
+                                    computeAlignSoASize(n_points),
+                                    soa::device::n_temp_columns(m_lowMemory));
+    }
+    soa::device::partitionSoAView<Ndim>(
+        m_view, m_buffer.data(), n_points, m_lowMemory, buffers...);
   }
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
@@ -241,6 +345,24 @@ namespace clue {
     return std::span<float>(m_view.rho, m_size);
   }
 
+  template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
+  ALPAKA_FN_HOST inline auto PointsDevice<TDev,Ndim>::delta() const {
+    return std::span<const float>(m_view.delta, m_view.delta == nullptr ? 0 : m_size);
+  }
+  template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
+  ALPAKA_FN_HOST inline auto PointsDevice<TDev,Ndim>::delta() {
+    return std::span<float>(m_view.delta, m_view.delta == nullptr ? 0 : m_size);
+  }
+
+  template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
+  inline void PointsDevice<TDev,Ndim>::store_delta(bool store) {
+    // the column is allocated on the first request and kept for the following clusterings
+    if (store && !m_delta.has_value()) {
+      m_delta.emplace(make_device_buffer<float>(m_device, static_cast<std::size_t>(m_size)));
+    }
+    m_view.delta = store ? m_delta->data() : nullptr;
+  }
+
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
   ALPAKA_FN_HOST inline auto PointsDevice<TDev,Ndim>::nearestHigher() const {
     return std::span<const int>(m_view.nearest_higher, m_size);
@@ -252,11 +374,11 @@ namespace clue {
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
   ALPAKA_FN_HOST inline auto PointsDevice<TDev,Ndim>::isSeed() const {
-    return std::span<const int>(m_view.is_seed, m_size);
+    return std::span<const uint32_t>(m_view.is_seed, (m_size + 31) / 32);
   }
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
   ALPAKA_FN_HOST inline auto PointsDevice<TDev,Ndim>::isSeed() {
-    return std::span<int>(m_view.is_seed, m_size);
+    return std::span<uint32_t>(m_view.is_seed, (m_size + 31) / 32);
   }
 
   template <alpaka::onHost::concepts::Device TDev,std::size_t Ndim>
@@ -5,10 +5,14 @@
 #include "CLUEstering/data_structures/ClusterProperties.hpp"
 #include "CLUEstering/utils/detail/get_cluster_properties.hpp"
 #include "CLUEstering/internal/alpaka/memory.hpp"
+#include "CLUEstering/internal/io/BinaryFormat.hpp"
 #include "CLUEstering/internal/meta/apply.hpp"
+#include "CLUEstering/internal/alpaka/first_touch.hpp"
 #include "CLUEstering/detail/Dim.hpp"
 #include <alpaka/alpaka.hpp>
 #include <cassert>
+#include <filesystem>
+#include <limits>
 #include <optional>
 #include <ranges>
 #include <span>
@@ -25,18 +29,20 @@ namespace clue {
         throw std::invalid_argument(
             "Number of points passed to PointsHost constructor must be positive.");
       }
-      return ((Ndim + 1) * sizeof(float) + sizeof(int)) * n_points;
+      return ((Ndim + 1) * sizeof(float) + sizeof(int)) *
+             static_cast<std::size_t>(computeAlignSoASize(n_points));
     }
 
     template <concepts::Queue TQueue, std::size_t Ndim>
     auto copyToHost(TQueue& queue, const PointsDevice<DevType<TQueue>,Ndim>& d_points);
     template <std::size_t Ndim>
     inline void partitionSoAView(PointsView<Ndim>& view, std::byte* buffer, int32_t n_points) {
+      const auto stride = computeAlignSoASize(n_points) * sizeof(float);
       meta::apply<Ndim>([&]<std::size_t Dim>() {
-        view.coords[Dim] = reinterpret_cast<float*>(buffer + Dim * n_points * sizeof(float));
+        view.coords[Dim] = reinterpret_cast<float*>(buffer + Dim * stride);
       });
-      view.weight = reinterpret_cast<float*>(buffer + Ndim * n_points * sizeof(float));
-      view.cluster_index = reinterpret_cast<int*>(buffer + (Ndim + 1) * n_points * sizeof(float));
+      view.weight = reinterpret_cast<float*>(buffer + Ndim * stride);
+      view.cluster_index = reinterpret_cast<int*>(buffer + (Ndim + 1) * stride);
       view.n = n_points;
     }
     template <std::size_t Ndim, concepts::Pointer... TBuffers>
@@ -126,6 +132,9 @@ namespace clue {
       : m_view{},
         m_buffer{make_host_buffer<std::byte>(soa::host::computeSoASize(dim,n_points))},
         m_size{n_points} {
+    // coordinates, weights and cluster indexes
+    internal::first_touch_host_columns(
+        reinterpret_cast<float*>(m_buffer->data()), computeAlignSoASize(n_points), Ndim + 2);
     soa::host::partitionSoAView<Ndim>(m_view, m_buffer->data(), n_points);
   }
 
@@ -186,6 +195,75 @@ namespace clue {
     soa::host::partitionSoAView<Ndim>(m_view, n_points, buffers...);
   }
 
+  template <std::size_t Ndim>
+  inline PointsHost<Ndim>::PointsHost(Dim<Ndim> /**unused**/, const std::filesystem::path& file_path)
+      : m_view{}, m_file{std::in_place, file_path.string(), internal::MappedFile::Access::CopyOnWrite} {
+    using namespace internal::binary;
+    const auto content = parse(*m_file, file_path.string());
+    if (content.header.ndim != Ndim) {
+      throw std::invalid_argument("The file " + file_path.string() + " contains points with " +
+                                  std::to_string(content.header.ndim) + " dimensions, while " +
+                                  std::to_string(Ndim) + " were expected.");
+    }
+    if (content.header.n_points > static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+      throw std::invalid_argument("The file " + file_path.string() +
+                                  " contains more points than supported by PointsHost.");
+    }
+    m_size = static_cast<int32_t>(content.header.n_points);
+
+    auto column = [&](ColumnKind kind, DType dtype, std::size_t n = 0) -> std::byte* {
+      const auto descriptor = content.find(kind, n);
+      if (!descriptor.has_value()) {
+        return nullptr;
+      }
+      if (descriptor->dtype != dtype) {
+        throw std::runtime_error("The file " + file_path.string() +
+                                 " contains a column with an unexpected data type.");
+      }
+      return m_file->bytes().data() + descriptor->offset;
+    };
+    auto required_column = [&](ColumnKind kind, DType dtype, std::size_t n = 0) {
+      auto* data = column(kind, dtype, n);
+      if (data == nullptr) {
+        throw std::runtime_error("The file " + file_path.string() +
+                                 " doesn't contain all the coordinates and weights of the points.");
+      }
+      return data;
+    };
+
+    for (auto dim = 0u; dim < Ndim; ++dim) {
+      m_view.coords[dim] =
+          reinterpret_cast<float*>(required_column(ColumnKind::Coordinate, DType::Float32, dim));
+    }
+    m_view.weight = reinterpret_cast<float*>(required_column(ColumnKind::Weight, DType::Float32));
+    if (auto* cluster_indexes = column(ColumnKind::ClusterIndex, DType::Int32)) {
+      m_view.cluster_index = reinterpret_cast<int*>(cluster_indexes);
+      if (content.header.flags & Flags::Clustered) {
+        mark_clustered();
+      }
+    } else {
+      m_buffer = make_host_buffer<std::byte>(static_cast<std::size_t>(m_size) * sizeof(int));
+      m_view.cluster_index = reinterpret_cast<int*>(m_buffer->data());
+    }
+    m_view.n = m_size;
+  }
+
+  template <std::size_t Ndim>
+  inline std::span<const float> PointsHost<Ndim>::rho() const {
+    if (!m_rho.has_value()) {
+      return {};
+    }
+    return std::span<const float>(m_rho->data(), m_size);
+  }
+
+  template <std::size_t Ndim>
+  inline std::span<const float> PointsHost<Ndim>::delta() const {
+    if (!m_delta.has_value()) {
+      return {};
+    }
+    return std::span<const float>(m_delta->data(), m_size);
+  }
+
   template <std::size_t Ndim>
   inline PointsHost<Ndim>::Point PointsHost<Ndim>::operator[](std::size_t idx) const {
     if (idx >= static_cast<size_t>(m_size))
@@ -193,7 +271,7 @@ namespace clue {
 
     std::array<float, Ndim> coords;
     for (size_t dim = 0; dim < Ndim; ++dim) {
-      coords[dim] = m_view.coords[0][dim * m_size + idx];
+      coords[dim] = m_view.coords[dim][idx];
     }
     return Point(coords, m_view.weight[idx], m_view.cluster_index[idx]);
   }
@@ -0,0 +1,102 @@
+
+#pragma once
+
+#include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <alpaka/alpaka.hpp>
+
+namespace clue::internal {
+
+  // Alignment of the buffers handed out by the arenas, which matches the alignment of the
+  // allocations of the device runtimes
+  inline constexpr std::size_t arena_alignment = 256;
+
+  // Bump allocator for the temporary buffers of a clustering, which all live until the end
+  // of the clustering. The buffers are carved out of a single slab, without the rounding
+  // of the sizes to the bins of the caching allocator, and are all released at once by
+  // resetting the arena. When a clustering needs more memory than the slab holds, the
+  // missing buffers are allocated separately, and the slab is enlarged to the total size
+  // on the first allocation after the reset, so that the following clusterings of a similar
+  // size are served by the slab alone.
+  template <typename TDev>
+  class Arena {
+  public:
+    Arena() = default;
+
+    // The returned buffer is valid until the next reset, and its content is not initialized
+    template <typename T, ::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST T* allocate(TQueue& queue, std::size_t size) {
+      const auto bytes = aligned_size(std::max<std::size_t>(size, 1) * sizeof(T));
+      if (m_offset == 0 && m_overflow.empty() && m_capacity < m_required) {
+        m_slab.reset();
+        m_slab.emplace(make_device_buffer<std::byte>(queue.getDevice(), m_required));
+        m_capacity = m_required;
+      }
+      m_required = std::max(m_required, m_offset + m_overflowBytes + bytes);
+      if (m_offset + bytes <= m_capacity) {
+        auto* ptr = m_slab->data() + m_offset;
+        m_offset += bytes;
+        return reinterpret_cast<T*>(ptr);
+      }
+      m_overflowBytes += bytes;
+      return reinterpret_cast<T*>(
+          m_overflow.emplace_back(make_device_buffer<std::byte>(queue.getDevice(), bytes)).data());
+    }
+
+    // Release all the buffers. The operations using them must have completed
+    ALPAKA_FN_HOST void reset() {
+      m_offset = 0;
+      if (!m_overflow.empty()) {
+        m_overflow.clear();
+        m_overflowBytes = 0;
+      }
+    }
+
+    ALPAKA_FN_HOST inline constexpr std::size_t capacity() const { return m_capacity; }
+    ALPAKA_FN_HOST inline constexpr std::size_t used() const { return m_offset + m_overflowBytes; }
+
+  private:
+    using Slab = getBufferType<TDev, std::byte>;
+
+    static constexpr std::size_t aligned_size(std::size_t bytes) {
+      return (bytes + arena_alignment - 1) / arena_alignment * arena_alignment;
+    }
+
+    std::optional<Slab> m_slab;
+    std::vector<Slab> m_overflow;
+    std::size_t m_capacity = 0;
+    std::size_t m_offset = 0;
+    std::size_t m_overflowBytes = 0;
+    // largest amount of memory used by a clustering, to which the slab is enlarged
+    std::size_t m_required = 0;
+  };
+
+  // Reset an arena at the end of a clustering, also when the clustering fails, so that the
+  // buffers of a failed clustering are not kept until the following one. The queue is
+  // waited for before the reset, because when the clustering throws or returns early the
+  // kernels already enqueued might still be using the buffers.
+  template <typename TDev, ::clue::concepts::Queue TQueue>
+  class ArenaGuard {
+  public:
+    ArenaGuard(Arena<TDev>& arena, TQueue& queue) : m_arena{arena}, m_queue{queue} {}
+    ArenaGuard(const ArenaGuard&) = delete;
+    ArenaGuard& operator=(const ArenaGuard&) = delete;
+    ~ArenaGuard() {
+      try {
+        alpaka::onHost::wait(m_queue);
+      } catch (...) {
+        // a queue in an error state doesn't execute the remaining operations
+      }
+      m_arena.reset();
+    }
+
+  private:
+    Arena<TDev>& m_arena;
+    TQueue& m_queue;
+  };
+
+}  // namespace clue::internal
@@ -2,10 +2,23 @@
 #pragma once
 
 #include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
 #include <alpaka/alpaka.hpp>
 
 namespace clue::internal {
 
+  // Map a float to an integer with the same ordering, so that the extremes can be
+  // reduced with integer atomics on every backend
+  ALPAKA_FN_HOST_ACC inline constexpr int32_t orderedKey(float value) {
+    const auto bits = std::bit_cast<int32_t>(value);
+    return bits >= 0 ? bits : bits ^ std::numeric_limits<int32_t>::max();
+  }
+  ALPAKA_FN_HOST_ACC inline constexpr float fromOrderedKey(int32_t key) {
+    return std::bit_cast<float>(key >= 0 ? key : key ^ std::numeric_limits<int32_t>::max());
+  }
+
   template <std::size_t Ndim>
   class CoordinateExtremes {
   private:
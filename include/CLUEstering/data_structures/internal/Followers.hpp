@@ -29,6 +29,25 @@ namespace clue {
       m_assoc.fill(queue, d_points.size(), d_points.nearestHigher());
     }
 
+    /// @brief Reuse the buffers of the followers to map the clusters to their points
+    ///
+    /// The followers are no longer needed once the points have been assigned to the clusters,
+    /// so their buffers, which can hold an entry for each point, are refilled with the points
+    /// of each cluster. The operations are only enqueued, without waiting for them.
+    ///
+    /// @param queue The queue to enqueue the operations on
+    /// @param d_points The clustered device points
+    /// @param n_clusters The number of clusters
+    /// @return The device associator mapping each cluster to its points
+    template <concepts::Queue TQueue, std::size_t Ndim>
+    ALPAKA_FN_HOST const DevAssociationMap<TDev>& clusters(TQueue& queue,
+                                                          const PointsDevice<TDev, Ndim>& d_points,
+                                                          std::size_t n_clusters) {
+      m_assoc.reset(d_points.size(), n_clusters);
+      m_assoc.fill_async(queue, d_points.size(), d_points.clusterIndexes());
+      return m_assoc;
+    }
+
     ALPAKA_FN_HOST inline constexpr int32_t extents() const { return m_assoc.extents().values; }
 
     ALPAKA_FN_HOST const AssociationMapView& view() const { return m_assoc.view(); }
@@ -0,0 +1,516 @@
+#pragma once
+
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/data_structures/internal/CoordinateExtremes.hpp"
+#include "CLUEstering/data_structures/internal/KdTreeView.hpp"
+#include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/algorithm/sort/sort.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+#include "CLUEstering/internal/nostd/parallel_for.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <vector>
+#include <alpaka/alpaka.hpp>
+
+namespace clue::internal {
+
+  // Positions processed by each device thread when reducing the extremes of the nodes,
+  // which at the upper levels of the tree mostly belong to the same node
+  inline constexpr int32_t kdtree_points_per_thread = 64;
+
+  // Range of the points of a node of a level, which follows from halving the ranges
+  // of its ancestors
+  ALPAKA_FN_HOST_ACC inline void kdtreeNodeRange(
+      int32_t node, int32_t level, int32_t n_points, int32_t& begin, int32_t& end) {
+    begin = 0;
+    end = n_points;
+    for (auto bit = level - 1; bit >= 0; --bit) {
+      const auto middle = begin + (end - begin) / 2;
+      if ((node >> bit) & 1) {
+        begin = middle;
+      } else {
+        end = middle;
+      }
+    }
+  }
+
+  // Node of a level containing a position of the ordered points, together with its range
+  ALPAKA_FN_HOST_ACC inline int32_t kdtreeNodeAt(
+      int32_t position, int32_t level, int32_t n_points, int32_t& begin, int32_t& end) {
+    int32_t node = 1;
+    begin = 0;
+    end = n_points;
+    for (auto depth = 0; depth < level; ++depth) {
+      const auto middle = begin + (end - begin) / 2;
+      if (position >= middle) {
+        node = 2 * node + 1;
+        begin = middle;
+      } else {
+        node = 2 * node;
+        end = middle;
+      }
+    }
+    return node;
+  }
+
+  // Entry of the sort of the points of a level, ordered by the node containing the point
+  // and then by its coordinate along the split dimension of the node
+  struct KdTreeEntry {
+    uint64_t key;
+    int32_t index;
+  };
+
+  struct KdTreeEntryLess {
+    ALPAKA_FN_HOST_ACC constexpr bool operator()(const KdTreeEntry& lhs,
+                                                 const KdTreeEntry& rhs) const {
+      return lhs.key < rhs.key;
+    }
+  };
+
+  struct KernelIota {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc, int32_t* indexes, int32_t size) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{size})) {
+        indexes[i] = i;
+      }
+    }
+  };
+
+  // While the extremes of the nodes of a level are being reduced, they are stored
+  // as the ordered keys of the minimum and maximum coordinates, like in the tiles
+  template <std::size_t Ndim>
+  struct KernelResetNodeExtremes {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc, int32_t* keys, int32_t n_nodes) const {
+      for (auto [k] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{n_nodes})) {
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          keys[2 * Ndim * k + 2 * dim] = std::numeric_limits<int32_t>::max();
+          keys[2 * Ndim * k + 2 * dim + 1] = std::numeric_limits<int32_t>::lowest();
+        }
+      }
+    }
+  };
+
+  // Each thread reduces the extremes of a block of consecutive positions, merging them
+  // with the extremes of their node with atomic operations whenever the node changes
+  struct KernelReduceNodeExtremes {
+    template <typename TAcc, std::size_t Ndim>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim> points,
+                                  const int32_t* indexes,
+                                  int32_t* keys,
+                                  int32_t level,
+                                  int32_t n_points) const {
+      const auto first_node = int32_t{1} << level;
+      const auto n_blocks = (n_points + kdtree_points_per_thread - 1) / kdtree_points_per_thread;
+      for (auto [block] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{n_blocks})) {
+        const auto first = static_cast<int32_t>(block) * kdtree_points_per_thread;
+        const auto last = n_points - first > kdtree_points_per_thread
+                              ? first + kdtree_points_per_thread
+                              : n_points;
+        std::array<int32_t, Ndim> local_min;
+        std::array<int32_t, Ndim> local_max;
+        int32_t node = 0;
+        int32_t end = first;
+        for (auto i = first; i < last; ++i) {
+          if (i >= end) {
+            if (node != 0) {
+              merge(acc, keys + 2 * Ndim * (node - first_node), local_min, local_max);
+            }
+            int32_t begin;
+            node = kdtreeNodeAt(i, level, n_points, begin, end);
+            for (auto dim = 0u; dim < Ndim; ++dim) {
+              local_min[dim] = std::numeric_limits<int32_t>::max();
+              local_max[dim] = std::numeric_limits<int32_t>::lowest();
+            }
+          }
+          const auto point = indexes[i];
+          for (auto dim = 0u; dim < Ndim; ++dim) {
+            const auto key = orderedKey(points.coords[dim][point]);
+            local_min[dim] = key < local_min[dim] ? key : local_min[dim];
+            local_max[dim] = key > local_max[dim] ? key : local_max[dim];
+          }
+        }
+        if (node != 0) {
+          merge(acc, keys + 2 * Ndim * (node - first_node), local_min, local_max);
+        }
+      }
+    }
+
+  private:
+    template <typename TAcc, std::size_t Ndim>
+    ALPAKA_FN_ACC static void merge(const TAcc& acc,
+                                    int32_t* node_keys,
+                                    const std::array<int32_t, Ndim>& local_min,
+                                    const std::array<int32_t, Ndim>& local_max) {
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        alpaka::onAcc::atomicMin(acc, &node_keys[2 * dim], local_min[dim]);
+        alpaka::onAcc::atomicMax(acc, &node_keys[2 * dim + 1], local_max[dim]);
+      }
+    }
+  };
+
+  template <std::size_t Ndim>
+  struct KernelComputeRootExtremes {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  const int32_t* keys,
+                                  CoordinateExtremes<Ndim>* extremes) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{1u})) {
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          extremes->min(dim) = fromOrderedKey(keys[2 * dim]);
+          extremes->max(dim) = fromOrderedKey(keys[2 * dim + 1]);
+        }
+      }
+    }
+  };
+
+  // Choose the split dimension of the nodes of a level, the one with the largest extent,
+  // and compute the sort keys of their points
+  template <std::size_t Ndim>
+  struct KernelComputeSortKeys {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim> points,
+                                  const int32_t* indexes,
+                                  const int32_t* keys,
+                                  uint8_t* dims,
+                                  KdTreeEntry* entries,
+                                  int32_t level,
+                                  int32_t n_points) const {
+      const auto first_node = int32_t{1} << level;
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{n_points})) {
+        int32_t begin;
+        int32_t end;
+        const auto node = kdtreeNodeAt(i, level, n_points, begin, end);
+        const auto* node_keys = keys + 2 * Ndim * (node - first_node);
+        uint8_t split_dim = 0;
+        auto largest = fromOrderedKey(node_keys[1]) - fromOrderedKey(node_keys[0]);
+        for (auto dim = 1u; dim < Ndim; ++dim) {
+          const auto range =
+              fromOrderedKey(node_keys[2 * dim + 1]) - fromOrderedKey(node_keys[2 * dim]);
+          if (range > largest) {
+            largest = range;
+            split_dim = static_cast<uint8_t>(dim);
+          }
+        }
+        if (i == begin) {
+          dims[node] = split_dim;
+        }
+
+        // flipping the sign bit makes the unsigned order of the keys follow the coordinates
+        const auto point = indexes[i];
+        const auto coordinate =
+            static_cast<uint32_t>(orderedKey(points.coords[split_dim][point])) ^ 0x80000000u;
+        entries[i] = KdTreeEntry{
+            (static_cast<uint64_t>(node - first_node) << 32) | coordinate, point};
+      }
+    }
+  };
+
+  // Store the sorted points of a level and the split values of its nodes,
+  // which are the coordinates of the points in the middle of their ranges
+  template <std::size_t Ndim>
+  struct KernelSplitNodes {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim> points,
+                                  const KdTreeEntry* entries,
+                                  int32_t* indexes,
+                                  const uint8_t* dims,
+                                  float* splits,
+                                  int32_t level,
+                                  int32_t n_points) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{n_points})) {
+        int32_t begin;
+        int32_t end;
+        const auto node = kdtreeNodeAt(i, level, n_points, begin, end);
+        const auto point = entries[i].index;
+        indexes[i] = point;
+        if (i == begin + (end - begin) / 2) {
+          splits[node] = points.coords[dims[node]][point];
+        }
+      }
+    }
+  };
+
+  template <std::size_t Ndim, typename TDev>
+  class KdTree {
+  public:
+    KdTree() : m_view{} {}
+
+    /// @brief Build the tree from the points on the host and copy it to the device
+    ///
+    /// The copy is enqueued without waiting for it, so the points must not be modified
+    /// until the queue has been synchronized.
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST void build(TQueue& queue,
+                              const PointsHost<Ndim>& points,
+                              int32_t leaf_size,
+                              const std::array<uint8_t, Ndim>& wrapping) {
+      std::array<const float*, Ndim> coords;
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        coords[dim] = points.coords(dim).data();
+      }
+      build(queue, coords, points.size(), leaf_size, wrapping);
+    }
+
+    /// @brief Build the tree from the points on the device
+    ///
+    /// The points are sorted on the device once per level of the tree, by node and by
+    /// coordinate along the split dimension of the node. The device sorts are not ordered
+    /// with the queue, which is synchronized before each of them.
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST void build(TQueue& queue,
+                              const PointsDevice<TDev, Ndim>& points,
+                              int32_t leaf_size,
+                              const std::array<uint8_t, Ndim>& wrapping) {
+      const auto n_points = points.size();
+      const auto depth = treeDepth(n_points, leaf_size);
+      const auto n_nodes = std::size_t{1} << depth;
+      // the widest level is the last one before the leaves
+      const auto level_nodes = std::max<std::size_t>(n_nodes / 2, 1);
+      const auto size = static_cast<std::size_t>(n_points);
+      allocate(queue, size, n_nodes);
+      if (!m_workspace.has_value() || m_workspace->points_capacity < size ||
+          m_workspace->nodes_capacity < level_nodes) {
+        const auto points_capacity = std::max<std::size_t>(size, 1);
+        m_workspace.emplace(Workspace{
+            make_device_buffer<KdTreeEntry>(queue.getDevice(), points_capacity),
+            make_device_buffer<int32_t>(queue.getDevice(), 2 * Ndim * level_nodes),
+            points_capacity,
+            level_nodes});
+      }
+      auto& buffers = *m_buffers;
+      auto& workspace = *m_workspace;
+      auto exec = DevicePool::exec();
+      constexpr std::size_t block_size = 256;
+      const auto points_grid = alpaka::onHost::FrameSpec{
+          std::max<std::size_t>(alpaka::divCeil(size, block_size), 1), block_size};
+      const auto reduce_grid = alpaka::onHost::FrameSpec{
+          std::max<std::size_t>(
+              alpaka::divCeil(size, block_size * kdtree_points_per_thread), 1),
+          block_size};
+      const auto single = alpaka::onHost::FrameSpec{1u, 1u};
+
+      queue.enqueue(exec, points_grid, KernelIota{}, buffers.indexes.data(), n_points);
+      for (auto level = 0; level < std::max(depth, 1); ++level) {
+        const auto first_node = int32_t{1} << level;
+        const auto nodes = static_cast<std::size_t>(first_node);
+        queue.enqueue(exec,
+                      alpaka::onHost::FrameSpec{
+                          std::max<std::size_t>(alpaka::divCeil(nodes, block_size), 1), block_size},
+                      KernelResetNodeExtremes<Ndim>{},
+                      workspace.keys.data(),
+                      first_node);
+        queue.enqueue(exec,
+                      reduce_grid,
+                      KernelReduceNodeExtremes{},
+                      points.view(),
+                      buffers.indexes.data(),
+                      workspace.keys.data(),
+                      level,
+                      n_points);
+        if (level == 0) {
+          queue.enqueue(exec,
+                        single,
+                        KernelComputeRootExtremes<Ndim>{},
+                        workspace.keys.data(),
+                        buffers.extremes.data());
+        }
+        if (level == depth) {
+          break;
+        }
+
+        queue.enqueue(exec,
+                      points_grid,
+                      KernelComputeSortKeys<Ndim>{},
+                      points.view(),
+                      buffers.indexes.data(),
+                      workspace.keys.data(),
+                      buffers.dims.data(),
+                      workspace.entries.data(),
+                      level,
+                      n_points);
+        alpaka::onHost::wait(queue);
+        algorithm::sort(queue,
+                        workspace.entries.data(),
+                        workspace.entries.data() + n_points,
+                        KdTreeEntryLess{});
+        queue.enqueue(exec,
+                      points_grid,
+                      KernelSplitNodes<Ndim>{},
+                      points.view(),
+                      workspace.entries.data(),
+                      buffers.indexes.data(),
+                      buffers.dims.data(),
+                      buffers.splits.data(),
+                      level,
+                      n_points);
+      }
+
+      m_view.wrapping = wrapping;
+      m_view.npoints = n_points;
+      m_view.depth = depth;
+    }
+
+    const KdTreeView<Ndim>& view() const { return m_view; }
+
+    ALPAKA_FN_HOST inline constexpr auto depth() const { return m_view.depth; }
+
+  private:
+    struct DeviceBuffers {
+      getBufferType<TDev, int32_t> indexes;
+      getBufferType<TDev, float> splits;
+      getBufferType<TDev, uint8_t> dims;
+      getBufferType<TDev, CoordinateExtremes<Ndim>> extremes;
+      std::size_t points_capacity;
+      std::size_t nodes_capacity;
+    };
+
+    // buffers used only while building the tree on the device
+    struct Workspace {
+      getBufferType<TDev, KdTreeEntry> entries;
+      // ordered keys of the extremes of the nodes of a level
+      getBufferType<TDev, int32_t> keys;
+      std::size_t points_capacity;
+      std::size_t nodes_capacity;
+    };
+
+    static int32_t treeDepth(int32_t n_points, int32_t leaf_size) {
+      int32_t depth = 0;
+      while (depth < kdtree_max_depth && (n_points >> (depth + 1)) >= leaf_size) {
+        ++depth;
+      }
+      return depth;
+    }
+
+    // The tree is built level by level. The nodes of a level are split concurrently, each
+    // one partitioning its range of points around the median of the coordinate with the
+    // largest extent, so that the tree is balanced whatever the distribution of the points
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST void build(TQueue& queue,
+                              const std::array<const float*, Ndim>& coords,
+                              int32_t n_points,
+                              int32_t leaf_size,
+                              const std::array<uint8_t, Ndim>& wrapping) {
+      const auto depth = treeDepth(n_points, leaf_size);
+      const auto n_nodes = std::size_t{1} << depth;
+      m_indexes.resize(n_points);
+      std::iota(m_indexes.begin(), m_indexes.end(), 0);
+      m_splits.assign(n_nodes, 0.f);
+      m_dims.assign(n_nodes, 0);
+
+      for (auto level = 0; level < std::max(depth, 1); ++level) {
+        const auto first_node = std::size_t{1} << level;
+        nostd::parallel_for(first_node, [&](std::size_t k) {
+          const auto node = static_cast<int32_t>(first_node + k);
+          int32_t begin;
+          int32_t end;
+          kdtreeNodeRange(node, level, n_points, begin, end);
+          const auto middle = begin + (end - begin) / 2;
+
+          CoordinateExtremes<Ndim> extremes;
+          for (auto dim = 0u; dim < Ndim; ++dim) {
+            extremes.min(dim) = std::numeric_limits<float>::max();
+            extremes.max(dim) = std::numeric_limits<float>::lowest();
+            for (auto i = begin; i < end; ++i) {
+              const auto coord = coords[dim][m_indexes[i]];
+              extremes.min(dim) = std::min(extremes.min(dim), coord);
+              extremes.max(dim) = std::max(extremes.max(dim), coord);
+            }
+          }
+          if (node == 1) {
+            m_extremes = extremes;
+          }
+          if (level == depth) {
+            return;
+          }
+          uint8_t split_dim = 0;
+          for (auto dim = 1u; dim < Ndim; ++dim) {
+            if (extremes.range(dim) > extremes.range(split_dim)) {
+              split_dim = static_cast<uint8_t>(dim);
+            }
+          }
+
+          const auto* column = coords[split_dim];
+          std::nth_element(m_indexes.begin() + begin,
+                           m_indexes.begin() + middle,
+                           m_indexes.begin() + end,
+                           [column](int32_t lhs, int32_t rhs) { return column[lhs] < column[rhs]; });
+          m_splits[node] = column[m_indexes[middle]];
+          m_dims[node] = split_dim;
+        });
+      }
+
+      upload(queue, static_cast<std::size_t>(n_points), n_nodes);
+      m_view.wrapping = wrapping;
+      m_view.npoints = n_points;
+      m_view.depth = depth;
+    }
+
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST void allocate(TQueue& queue, std::size_t n_points, std::size_t n_nodes) {
+      if (!m_buffers.has_value() || m_buffers->points_capacity < n_points ||
+          m_buffers->nodes_capacity < n_nodes) {
+        const auto points_capacity = std::max<std::size_t>(n_points, 1);
+        m_buffers.emplace(DeviceBuffers{
+            make_device_buffer<int32_t>(queue.getDevice(), points_capacity),
+            make_device_buffer<float>(queue.getDevice(), n_nodes),
+            make_device_buffer<uint8_t>(queue.getDevice(), n_nodes),
+            make_device_buffer<CoordinateExtremes<Ndim>>(queue.getDevice(),
+                                                         alpaka::Vec<std::size_t, 1U>{1}),
+            points_capacity,
+            n_nodes});
+      }
+      m_view.indexes = m_buffers->indexes.data();
+      m_view.splits = m_buffers->splits.data();
+      m_view.dims = m_buffers->dims.data();
+      m_view.extremes = m_buffers->extremes.data();
+    }
+
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST void upload(TQueue& queue, std::size_t n_points, std::size_t n_nodes) {
+      allocate(queue, n_points, n_nodes);
+      if (n_points > 0) {
+        const auto extent = Vec1D{static_cast<uint32_t>(n_points)};
+        alpaka::onHost::memcpy(queue,
+                               alpaka::makeView(queue, m_buffers->indexes.data(), extent),
+                               alpaka::makeView(alpaka::api::host, m_indexes.data(), extent));
+      }
+      const auto nodes_extent = Vec1D{static_cast<uint32_t>(n_nodes)};
+      alpaka::onHost::memcpy(queue,
+                             alpaka::makeView(queue, m_buffers->splits.data(), nodes_extent),
+                             alpaka::makeView(alpaka::api::host, m_splits.data(), nodes_extent));
+      alpaka::onHost::memcpy(queue,
+                             alpaka::makeView(queue, m_buffers->dims.data(), nodes_extent),
+                             alpaka::makeView(alpaka::api::host, m_dims.data(), nodes_extent));
+      alpaka::onHost::memcpy(queue,
+                             alpaka::makeView(queue, m_buffers->extremes.data(), Vec1D{1}),
+                             alpaka::makeView(alpaka::api::host, &m_extremes, Vec1D{1}));
+    }
+
+    // host copies of the tree built from host points, which are kept alive until
+    // the next build because the copies to the device are asynchronous
+    std::vector<int32_t> m_indexes;
+    std::vector<float> m_splits;
+    std::vector<uint8_t> m_dims;
+    CoordinateExtremes<Ndim> m_extremes;
+    std::optional<DeviceBuffers> m_buffers;
+    std::optional<Workspace> m_workspace;
+    KdTreeView<Ndim> m_view;
+  };
+
+}  // namespace clue::internal
@@ -0,0 +1,72 @@
+
+#pragma once
+
+#include "CLUEstering/data_structures/internal/CoordinateExtremes.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <alpaka/alpaka.hpp>
+
+namespace clue::internal {
+
+  // Maximum depth of the k-d trees, which bounds the size of the traversal stack
+  inline constexpr int32_t kdtree_max_depth = 24;
+
+  // The tree is balanced and stored implicitly, with the children of node i in 2i and 2i + 1
+  // starting from the root in 1. Each internal node halves the range of points of its parent,
+  // so the ranges don't need to be stored, and the nodes at the maximum depth are the leaves.
+  // The points of the left child have coordinates not larger than the split value, and
+  // the points of the right child not smaller.
+  template <std::size_t Ndim>
+  struct KdTreeView {
+    const int32_t* indexes;
+    const float* splits;
+    const uint8_t* dims;
+    // extremes of the coordinates of all the points, stored on the device
+    const CoordinateExtremes<Ndim>* extremes;
+    std::array<uint8_t, Ndim> wrapping;
+    int32_t npoints;
+    int32_t depth;
+
+    // Call a function on all the points contained in the leaves overlapping with the
+    // search box of a point
+    template <typename TFunc>
+    ALPAKA_FN_ACC inline void forEachCandidate(const std::array<float, Ndim + 1>& coords,
+                                               float radius,
+                                               TFunc&& func) const {
+      struct Node {
+        int32_t id;
+        int32_t begin;
+        int32_t end;
+      };
+      Node stack[kdtree_max_depth + 1];
+      int32_t stack_size = 0;
+      stack[stack_size++] = Node{1, 0, npoints};
+
+      const auto first_leaf = int32_t{1} << depth;
+      while (stack_size > 0) {
+        const auto node = stack[--stack_size];
+        if (node.id >= first_leaf) {
+          for (auto i = node.begin; i < node.end; ++i) {
+            func(indexes[i]);
+          }
+          continue;
+        }
+
+        const auto dim = dims[node.id];
+        const auto split = splits[node.id];
+        const auto middle = node.begin + (node.end - node.begin) / 2;
+        // a search box crossing the boundary of a periodic coordinate overlaps with both halves
+        const auto crosses = wrapping[dim] && (coords[dim] - radius < extremes->min(dim) ||
+                                              coords[dim] + radius > extremes->max(dim));
+        if (crosses || coords[dim] + radius >= split) {
+          stack[stack_size++] = Node{2 * node.id + 1, middle, node.end};
+        }
+        if (crosses || coords[dim] - radius <= split) {
+          stack[stack_size++] = Node{2 * node.id, node.begin, middle};
+        }
+      }
+    }
+  };
+
+}  // namespace clue::internal
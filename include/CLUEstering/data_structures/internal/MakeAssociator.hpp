@@ -15,9 +15,6 @@ namespace clue::internal {
                               std::span<const T_Elem> associations,
                               T_Elem elements) {
     if (elements == 0 || associations.empty()) {
-      alpaka::onHost::wait(queue);
-      std::cerr << "make_associator: throwing early (elements=" << elements
-                  << ", size=" << associations.size() << ")\n";
       throw std::invalid_argument("make_associator: elements and associations must be non-zero");
     }
     auto it_max=algorithm::max_element(queue,associations.begin(),associations.end());
@@ -29,8 +26,7 @@ namespace clue::internal {
     alpaka::onHost::wait(queue);
     auto device=queue.getDevice();
     DevAssociationMap map(device, elements, max_el + 1);
-    map.fill(queue, elements, associations);
-    alpaka::onHost::wait(queue);
+    map.fill(queue, associations.size(), associations);
     return map;
   }
   inline auto make_associator(std::span<const int32_t> associations, int32_t elements)
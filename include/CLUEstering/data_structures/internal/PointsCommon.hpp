@@ -5,6 +5,8 @@
 #include "CLUEstering/detail/concepts.hpp"
 #include "CLUEstering/detail/make_array.hpp"
 #include "CLUEstering/internal/meta/apply.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <span>
 
 namespace clue {
@@ -67,8 +69,11 @@ namespace clue {
     std::array<float*, Ndim> coords;
     float* weight;
     int* cluster_index;
-    int* is_seed;
+    // bitset marking the seeds, with a bit for each point
+    uint32_t* is_seed;
     float* rho;
+    // distance from the nearest higher, only stored when requested
+    float* delta;
     int* nearest_higher;
     int32_t n;
 
@@ -84,11 +89,31 @@ namespace clue {
       point[Ndim] = weight[i];
       return point;
     }
+
+    ALPAKA_FN_HOST_ACC bool isSeed(int32_t i) const {
+      return (is_seed[i / 32] >> (i % 32)) & uint32_t{1};
+    }
   };
 
-  // TODO: implement for better cache use
-  template <std::size_t Ndim>
-  auto computeAlignSoASize(int32_t n_points) -> int32_t;
+  // Alignment of the columns of the points, which covers a cache line and the widest
+  // vector registers of the CPU backends
+  inline constexpr std::size_t soa_alignment = 64;
+
+  // Number of elements between the beginnings of two consecutive columns of the points.
+  // The columns are padded to a multiple of the alignment, so that when the buffer is
+  // aligned every column is aligned too, and vectorized loops over a column need no
+  // masking of the last iteration
+  inline constexpr auto computeAlignSoASize(int32_t n_points) -> int32_t {
+    constexpr auto elements = static_cast<int64_t>(soa_alignment / sizeof(float));
+    return static_cast<int32_t>((n_points + elements - 1) / elements * elements);
+  }
+
+  // Number of words of the bitset marking the seeds, padded like the columns of the points
+  inline constexpr auto computeSeedMaskSize(int32_t n_points) -> int32_t {
+    constexpr auto bits = static_cast<int64_t>(soa_alignment * 8);
+    constexpr auto words = static_cast<int64_t>(soa_alignment / sizeof(uint32_t));
+    return static_cast<int32_t>((n_points + bits - 1) / bits * words);
+  }
 
   template <std::size_t Ndim>
   class PointsHost;
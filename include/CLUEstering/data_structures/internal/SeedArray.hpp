@@ -1,10 +1,12 @@
 
 #pragma once
 
+#include "CLUEstering/data_structures/internal/Arena.hpp"
 #include "CLUEstering/internal/alpaka/memory.hpp"
 #include <alpaka/alpaka.hpp>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include "CLUEstering/detail/concepts.hpp"
 namespace clue::internal {
 
@@ -41,25 +43,25 @@ namespace clue::internal {
     }
   };
 
+  // The seeds of a clustering, whose buffers are taken from the arena of the temporaries
+  // of the clustering. The number of seeds is cached on the host when it is first read,
+  // so it remains available after the arena has been reset.
   template <typename TDev>
   class SeedArray {
   private:
-    getBufferType<TDev, int32_t> m_buffer;
-    getBufferType<TDev, std::size_t> m_dsize;
+    std::size_t* m_dsize;
     std::optional<std::size_t> m_size;
     std::size_t m_capacity;
     SeedArrayView m_view;
 
   public:
     template <::clue::concepts::Queue TQueue>
-    SeedArray(TQueue& queue, std::size_t size)
-        : m_buffer{make_device_buffer<int32_t>(queue.getDevice(), std::size_t{size})},
-          m_dsize{
-              make_device_buffer<std::size_t>(queue.getDevice(), alpaka::Vec<std::size_t, 1u>{1})},
+    SeedArray(TQueue& queue, Arena<TDev>& arena, std::size_t size)
+        : m_dsize{arena.template allocate<std::size_t>(queue, 1)},
           m_size{std::nullopt},
           m_capacity{size},
-          m_view{m_buffer.data(), m_dsize.data(), m_capacity} {
-      alpaka::onHost::memset(queue, m_dsize, 0u);
+          m_view{arena.template allocate<int32_t>(queue, size), m_dsize, m_capacity} {
+      alpaka::onHost::memset(queue, alpaka::makeView(queue, m_dsize, Vec1D{1}), 0u);
     }
 
     ALPAKA_FN_HOST constexpr auto capacity() const { return m_capacity; }
@@ -68,18 +70,14 @@ namespace clue::internal {
     ALPAKA_FN_HOST auto size(TQueue& queue) {
       if (!m_size.has_value()) {
         m_size = std::make_optional<std::size_t>();
-        alpaka::onHost::memcpy(queue, makeView(alpaka::api::host, &*m_size, Vec1D{1}), m_dsize);
+        alpaka::onHost::memcpy(queue,
+                               makeView(alpaka::api::host, &*m_size, Vec1D{1}),
+                               alpaka::makeView(queue, m_dsize, Vec1D{1}));
         alpaka::onHost::wait(queue);
       }
       return *m_size;
     }
 
-    template <::clue::concepts::Queue TQueue>
-    ALPAKA_FN_HOST auto reset(TQueue& queue) {
-      m_size = std::nullopt;
-      alpaka::onHost::memset(queue, m_dsize, 0u);
-    }
-
     ALPAKA_FN_HOST const auto& view() const { return m_view; }
     ALPAKA_FN_HOST auto& view() { return m_view; }
   };
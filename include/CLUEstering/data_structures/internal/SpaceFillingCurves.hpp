@@ -0,0 +1,87 @@
+
+#pragma once
+
+#include "CLUEstering/internal/nostd/parallel_for.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace clue::internal {
+
+  // Interleave the bits of the coordinates of a cell, starting from the most significant bit,
+  // with the first coordinate as the most significant one
+  template <std::size_t Ndim>
+  inline uint64_t mortonKey(const std::array<uint32_t, Ndim>& cell, int32_t bits) {
+    uint64_t key = 0;
+    for (auto bit = bits - 1; bit >= 0; --bit) {
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        key = (key << 1) | ((cell[dim] >> bit) & 1u);
+      }
+    }
+    return key;
+  }
+
+  // Position of a cell along the Hilbert curve, using the algorithm of J. Skilling,
+  // "Programming the Hilbert curve", AIP Conference Proceedings 707 (2004), which transforms
+  // the coordinates so that the interleaving of their bits gives the Hilbert index
+  template <std::size_t Ndim>
+  inline uint64_t hilbertKey(std::array<uint32_t, Ndim> cell, int32_t bits) {
+    const auto top = uint32_t{1} << (bits - 1);
+    for (auto q = top; q > 1; q >>= 1) {
+      const auto p = q - 1;
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        if (cell[dim] & q) {
+          cell[0] ^= p;
+        } else {
+          const auto t = (cell[0] ^ cell[dim]) & p;
+          cell[0] ^= t;
+          cell[dim] ^= t;
+        }
+      }
+    }
+    // Gray encoding
+    for (auto dim = 1u; dim < Ndim; ++dim) {
+      cell[dim] ^= cell[dim - 1];
+    }
+    uint32_t t = 0;
+    for (auto q = top; q > 1; q >>= 1) {
+      if (cell[Ndim - 1] & q) {
+        t ^= q - 1;
+      }
+    }
+    for (auto& coord : cell) {
+      coord ^= t;
+    }
+    return mortonKey(cell, bits);
+  }
+
+  // Compute the position along a space-filling curve of each cell of a grid with
+  // n_per_dim cells per dimension, indexed in row-major order. The curve is defined on
+  // the smallest grid with a power of two of cells per dimension containing the grid,
+  // and the positions are then made contiguous by ranking the keys of the cells
+  template <std::size_t Ndim, typename TKey>
+  inline void curve_ranks(int32_t n_per_dim, int32_t n_cells, int32_t* ranks, TKey&& curve_key) {
+    int32_t bits = 1;
+    while ((int64_t{1} << bits) < n_per_dim) {
+      ++bits;
+    }
+    std::vector<std::pair<uint64_t, int32_t>> keys(n_cells);
+    nostd::parallel_for(static_cast<std::size_t>(n_cells), [&](std::size_t i) {
+      std::array<uint32_t, Ndim> cell;
+      auto remainder = static_cast<uint32_t>(i);
+      for (auto dim = static_cast<int32_t>(Ndim) - 1; dim >= 0; --dim) {
+        cell[dim] = remainder % n_per_dim;
+        remainder /= n_per_dim;
+      }
+      keys[i] = std::make_pair(curve_key(cell, bits), static_cast<int32_t>(i));
+    });
+    std::sort(keys.begin(), keys.end());
+    for (auto rank = 0; rank < n_cells; ++rank) {
+      ranks[keys[rank].second] = rank;
+    }
+  }
+
+}  // namespace clue::internal
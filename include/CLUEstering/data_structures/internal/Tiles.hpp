@@ -2,20 +2,100 @@
 #pragma once
 
 #include "CLUEstering/data_structures/AssociationMap.hpp"
+#include "CLUEstering/data_structures/internal/Arena.hpp"
 #include "CLUEstering/data_structures/internal/TilesView.hpp"
 #include "CLUEstering/data_structures/internal/CoordinateExtremes.hpp"
+#include "CLUEstering/data_structures/internal/SpaceFillingCurves.hpp"
 #include "CLUEstering/detail/concepts.hpp"
 #include "CLUEstering/detail/make_array.hpp"
 #include "CLUEstering/internal/alpaka/memory.hpp"
-#include "CLUEstering/detail/concepts.hpp"
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
-#include <cstdint>
+#include <optional>
+#include <utility>
 #include <alpaka/Vec.hpp>
 #include <alpaka/alpaka.hpp>
 
+namespace clue {
+
+  /// @brief Placement of the boundaries of the tiles along each dimension
+  enum class TileBoundaries {
+    /// @brief Tiles of equal size, spanning the extremes of the coordinates
+    Uniform,
+    /// @brief Tiles containing approximately the same number of points, with the boundaries
+    /// placed at the quantiles of the coordinates. This bounds the number of points in the
+    /// densest tiles when the points are distributed very unevenly, for instance with heavy tails
+    Quantile
+  };
+
+  /// @brief Order in which the tiles are stored in memory
+  enum class TileOrder {
+    /// @brief Row-major order, where only the neighbouring tiles along the last dimension
+    /// are close in memory
+    RowMajor,
+    /// @brief Order along the Z-order (Morton) curve, which interleaves the bits of the
+    /// indexes of the tiles along each dimension
+    Morton,
+    /// @brief Order along the Hilbert curve, where consecutive tiles are neighbours if the
+    /// number of tiles per dimension is a power of two. Otherwise the curve is defined on the
+    /// padded grid, and the tiles that follow a gap can be farther apart
+    Hilbert
+  };
+
+}  // namespace clue
+
 namespace clue::internal {
 
+  /// @brief Options for the construction of the tiles chosen by the user
+  template <std::size_t Ndim>
+  struct TilingOptions {
+    // the domain of the coordinates, instead of computing it from the points
+    std::optional<CoordinateExtremes<Ndim>> domain;
+    std::optional<int32_t> n_per_dim;
+    TileBoundaries boundaries = TileBoundaries::Uniform;
+    TileOrder order = TileOrder::RowMajor;
+    bool sparse = false;
+  };
+
+  // Mark the tiles containing at least one point in the occupancy bitmap
+  template <std::size_t Ndim>
+  struct KernelMarkOccupiedTiles {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim> points,
+                                  TilesView<Ndim> tiles,
+                                  uint32_t* occupancy,
+                                  int32_t size) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{size})) {
+        float coords[Ndim];
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          coords[dim] = points.coords[dim][i];
+        }
+        const auto bin = tiles.getGlobalBin(coords);
+        alpaka::onAcc::atomicOr(acc, &occupancy[bin / 32], uint32_t{1} << (bin % 32));
+      }
+    }
+  };
+
+  struct KernelCountOccupiedTiles {
+    template <typename TAcc>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  const uint32_t* occupancy,
+                                  int32_t* counts,
+                                  int32_t words) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{words})) {
+        counts[i] = std::popcount(occupancy[i]);
+      }
+    }
+  };
+
+  // Number of bins of the histograms used to estimate the quantiles of the coordinates
+  inline constexpr int32_t quantile_bins = 4096;
+
   template <std::size_t Ndim, typename TDev>
   class Tiles {
   public:
@@ -25,10 +105,13 @@ namespace clue::internal {
                                                                 alpaka::Vec<std::size_t, 1U>{1})},
           m_tilesizes{make_device_buffer<float>(queue.getDevice(), Ndim)},
           m_wrapped{make_device_buffer<uint8_t>(queue.getDevice(), Ndim)},
+          m_hostMinmax{make_host_buffer<CoordinateExtremes<Ndim>>(std::size_t{1})},
+          m_hostTilesizes{make_host_buffer<float>(std::size_t{Ndim})},
           m_assoc{static_cast<std::size_t>(n_points), static_cast<std::size_t>(n_tiles), queue},
           m_ntiles{n_tiles},
           m_nperdim{static_cast<int32_t>(std::pow(n_tiles, 1.f / Ndim))},
           m_view{} {
+      m_capacity = m_assoc.extents();
       m_view.indexes = m_assoc.m_indexes.data();
       m_view.offsets = m_assoc.m_offsets.data();
       m_view.minmax = m_minmax.data();
@@ -44,7 +127,9 @@ namespace clue::internal {
 
     template <::clue::concepts::Queue TQueue>
     ALPAKA_FN_HOST void initialize(TQueue& queue, int32_t npoints, int32_t ntiles, int32_t nperdim) {
-      m_assoc.initialize(queue, npoints, ntiles);
+      // with sparse storage the keys are the occupied tiles, which are counted when filling
+      m_assoc.initialize(queue, npoints, m_sparse ? 0 : ntiles);
+      m_capacity = m_assoc.extents();
       m_ntiles = ntiles;
       m_nperdim = nperdim;
 
@@ -59,7 +144,7 @@ namespace clue::internal {
     }
 
     ALPAKA_FN_HOST void reset(int32_t npoints, int32_t ntiles, int32_t nperdim) {
-      m_assoc.reset(npoints, ntiles);
+      m_assoc.reset(npoints, m_sparse ? 0 : ntiles);
 
       m_ntiles = ntiles;
       m_nperdim = nperdim;
@@ -73,6 +158,95 @@ namespace clue::internal {
       m_view.nperdim = nperdim;
     }
 
+    /// @brief Set the extremes of the tiles to a fixed domain and compute the tile sizes
+    ///
+    /// The geometry is only copied to the device if it differs from the one already set,
+    /// so repeated calls with the same domain and number of tiles don't cost anything.
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST void setGeometry(TQueue& queue, const CoordinateExtremes<Ndim>& domain) {
+      if (m_geometry.has_value() && m_geometry->second == m_nperdim &&
+          std::equal(domain.data(), domain.data() + 2 * Ndim, m_geometry->first.data())) {
+        return;
+      }
+      *m_hostMinmax.data() = domain;
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        m_hostTilesizes[dim] = domain.range(dim) / static_cast<float>(m_nperdim);
+      }
+      alpaka::onHost::memcpy(queue, m_minmax, m_hostMinmax);
+      alpaka::onHost::memcpy(queue, m_tilesizes, m_hostTilesizes);
+      m_geometry = std::make_pair(domain, m_nperdim);
+    }
+
+    /// @brief Forget the fixed geometry, after the extremes have been computed from the points
+    ALPAKA_FN_HOST void invalidateGeometry() { m_geometry.reset(); }
+
+    // Buffers of the edges of the quantile tiles, containing the nperdim - 1 internal edges
+    // of each dimension, and of the histograms from which they are computed
+    struct QuantileBuffers {
+      getBufferType<TDev, float> edges;
+      getBufferType<TDev, int32_t> histogram;
+      getBufferType<alpaka::api::Host, float> hostEdges;
+      std::size_t capacity;
+    };
+
+    /// @brief Use the quantile edges for binning the points, allocating their buffers if needed
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST QuantileBuffers& useQuantileEdges(TQueue& queue) {
+      const auto size = Ndim * static_cast<std::size_t>(std::max(m_nperdim - 1, 1));
+      if (!m_quantiles.has_value() || m_quantiles->capacity < size) {
+        m_quantiles.emplace(QuantileBuffers{
+            make_device_buffer<float>(queue.getDevice(), size),
+            make_device_buffer<int32_t>(queue.getDevice(), Ndim * std::size_t{quantile_bins}),
+            make_host_buffer<float>(size),
+            size});
+      }
+      m_view.edges = m_quantiles->edges.data();
+      return *m_quantiles;
+    }
+
+    /// @brief Bin the points in tiles of uniform size
+    ALPAKA_FN_HOST void useUniformEdges() { m_view.edges = nullptr; }
+
+    /// @brief Set the order in which the tiles are stored
+    ///
+    /// The positions of the tiles along the curve are computed on the host and copied to
+    /// the device only when the order or the number of tiles change.
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST void setOrder(TQueue& queue, TileOrder order) {
+      if (order == TileOrder::RowMajor) {
+        m_view.order = nullptr;
+        return;
+      }
+      if (!m_order.has_value() || m_order->order != order || m_order->ntiles != m_ntiles) {
+        const auto capacity = static_cast<std::size_t>(m_ntiles);
+        if (!m_order.has_value() || m_order->capacity < capacity) {
+          m_order.emplace(OrderBuffers{make_device_buffer<int32_t>(queue.getDevice(), capacity),
+                                       make_host_buffer<int32_t>(capacity),
+                                       capacity,
+                                       order,
+                                       m_ntiles});
+        }
+        if (order == TileOrder::Morton) {
+          curve_ranks<Ndim>(
+              m_nperdim, m_ntiles, m_order->hostRanks.data(), [](const auto& cell, int32_t bits) {
+                return mortonKey<Ndim>(cell, bits);
+              });
+        } else {
+          curve_ranks<Ndim>(
+              m_nperdim, m_ntiles, m_order->hostRanks.data(), [](const auto& cell, int32_t bits) {
+                return hilbertKey<Ndim>(cell, bits);
+              });
+        }
+        const auto extent = Vec1D{static_cast<uint32_t>(m_ntiles)};
+        alpaka::onHost::memcpy(queue,
+                               alpaka::makeView(queue, m_order->ranks.data(), extent),
+                               alpaka::makeView(alpaka::api::host, m_order->hostRanks.data(), extent));
+        m_order->order = order;
+        m_order->ntiles = m_ntiles;
+      }
+      m_view.order = m_order->ranks.data();
+    }
+
     struct GetGlobalBin {
       PointsView<Ndim> pointsView;
       TilesView<Ndim> tilesView;
@@ -84,15 +258,44 @@ namespace clue::internal {
         }
 
         auto bin = tilesView.getGlobalBin(coords);
-        return bin;
+        return tilesView.tileKey(bin);
       }
     };
 
+    /// @brief Store only the occupied tiles, or all of them
+    ///
+    /// With sparse storage the offsets contain only the occupied tiles, which are found through
+    /// an occupancy bitmap with a bit for each tile. The memory of the offsets then scales with
+    /// the number of occupied tiles instead of the volume of the domain. Must be set before
+    /// initializing or resetting the tiles.
+    ALPAKA_FN_HOST void setSparse(bool sparse) {
+      m_sparse = sparse;
+      if (!sparse) {
+        m_view.occupancy = nullptr;
+        m_view.ranks = nullptr;
+      }
+    }
+
+    ALPAKA_FN_HOST inline constexpr bool sparse() const { return m_sparse; }
+
     // requires(::clue::concepts::NonHostApi<DevType<TQueue>>)
     template <::clue::concepts::Queue TQueue>
-    ALPAKA_FN_HOST void fill(TQueue& queue, PointsDevice< TDev,Ndim>& d_points, size_t size) {
+    ALPAKA_FN_HOST void fill(TQueue& queue,
+                             Arena<TDev>& arena,
+                             PointsDevice<TDev, Ndim>& d_points,
+                             size_t size) {
       auto pointsView = d_points.view();
-      m_assoc.fill(queue, size, GetGlobalBin{pointsView, m_view});
+      if (m_sparse) {
+        const auto occupied = static_cast<std::size_t>(markOccupiedTiles(queue, pointsView, size));
+        if (occupied > m_capacity.keys) {
+          m_assoc.initialize(queue, m_capacity.values, occupied);
+          m_capacity = m_assoc.extents();
+        }
+        m_assoc.reset(size, occupied);
+        m_view.indexes = m_assoc.m_indexes.data();
+        m_view.offsets = m_assoc.m_offsets.data();
+      }
+      m_assoc.fill(queue, arena, size, GetGlobalBin{pointsView, m_view});
     }
 
     ALPAKA_FN_HOST inline constexpr auto size() const { return m_ntiles; }
@@ -100,16 +303,105 @@ namespace clue::internal {
     ALPAKA_FN_HOST inline constexpr auto nPerDim() const { return m_nperdim; }
 
     ALPAKA_FN_HOST inline constexpr auto extents() const { return m_assoc.extents(); }
+    // the number of points and tiles for which the buffers are allocated
+    ALPAKA_FN_HOST inline constexpr auto capacity() const { return m_capacity; }
     getBufferType<TDev, CoordinateExtremes<Ndim>> m_minmax;
     getBufferType<TDev, float> m_tilesizes;
     getBufferType<TDev, uint8_t> m_wrapped;
+    // staging buffers for the geometry computed on the host
+    getBufferType<alpaka::api::Host, CoordinateExtremes<Ndim>> m_hostMinmax;
+    getBufferType<alpaka::api::Host, float> m_hostTilesizes;
 
   private:
     DevAssociationMap<TDev> m_assoc;
+    decltype(std::declval<DevAssociationMap<TDev>>().extents()) m_capacity;
 
     int32_t m_ntiles;
     int32_t m_nperdim;
     TilesView<Ndim> m_view;
+    // the fixed geometry currently stored on the device, with its number of tiles per dimension
+    std::optional<std::pair<CoordinateExtremes<Ndim>, int32_t>> m_geometry;
+    std::optional<QuantileBuffers> m_quantiles;
+    // positions of the tiles along the space-filling curve currently stored on the device
+    struct OrderBuffers {
+      getBufferType<TDev, int32_t> ranks;
+      getBufferType<alpaka::api::Host, int32_t> hostRanks;
+      std::size_t capacity;
+      TileOrder order;
+      int32_t ntiles;
+    };
+    std::optional<OrderBuffers> m_order;
+
+    struct SparseBuffers {
+      getBufferType<TDev, uint32_t> occupancy;
+      getBufferType<TDev, int32_t> counts;
+      getBufferType<TDev, int32_t> ranks;
+      getBufferType<TDev, std::byte> scan;
+      getBufferType<alpaka::api::Host, int32_t> hostOccupied;
+      std::size_t words;
+      std::size_t scan_bytes;
+    };
+    bool m_sparse = false;
+    std::optional<SparseBuffers> m_sparseBuffers;
+
+    // Build the occupancy bitmap and the number of occupied tiles preceding each of its words,
+    // and return the total number of occupied tiles
+    template <::clue::concepts::Queue TQueue>
+    ALPAKA_FN_HOST int32_t markOccupiedTiles(TQueue& queue, PointsView<Ndim> points, std::size_t size) {
+      const auto words = static_cast<std::size_t>(alpaka::divCeil(m_ntiles, 32));
+      const auto scan_bytes =
+          static_cast<std::size_t>(alpaka::onHost::getScanBufferSize<int32_t>(Vec1D{words}));
+      if (!m_sparseBuffers.has_value() || m_sparseBuffers->words < words ||
+          m_sparseBuffers->scan_bytes < scan_bytes) {
+        m_sparseBuffers.emplace(
+            SparseBuffers{make_device_buffer<uint32_t>(queue.getDevice(), words),
+                          make_device_buffer<int32_t>(queue.getDevice(), words),
+                          make_device_buffer<int32_t>(queue.getDevice(), words + 1),
+                          make_device_buffer<std::byte>(queue.getDevice(), scan_bytes),
+                          make_host_buffer<int32_t>(std::size_t{1}),
+                          words,
+                          scan_bytes});
+      }
+      auto& buffers = *m_sparseBuffers;
+      auto device = queue.getDevice();
+      auto exec = DevicePool::exec();
+      constexpr std::size_t block_size = 256;
+
+      alpaka::onHost::memset(
+          queue, alpaka::makeView(device, buffers.occupancy.data(), Vec1D{words}), 0);
+      queue.enqueue(exec,
+                    alpaka::onHost::FrameSpec{
+                        std::max<std::size_t>(alpaka::divCeil(size, block_size), 1), block_size},
+                    KernelMarkOccupiedTiles<Ndim>{},
+                    points,
+                    m_view,
+                    buffers.occupancy.data(),
+                    static_cast<int32_t>(size));
+      queue.enqueue(exec,
+                    alpaka::onHost::FrameSpec{
+                        std::max<std::size_t>(alpaka::divCeil(words, block_size), 1), block_size},
+                    KernelCountOccupiedTiles{},
+                    buffers.occupancy.data(),
+                    buffers.counts.data(),
+                    static_cast<int32_t>(words));
+
+      // the ranks are the exclusive scan of the counts
+      alpaka::onHost::memset(
+          queue, alpaka::makeView(device, buffers.ranks.data(), Vec1D{1}), 0);
+      alpaka::onHost::inclusiveScan(queue,
+                                    exec,
+                                    buffers.scan,
+                                    alpaka::makeMdSpan(buffers.ranks.data() + 1, Vec1D{words}),
+                                    alpaka::makeMdSpan(buffers.counts.data(), Vec1D{words}));
+      alpaka::onHost::memcpy(queue,
+                             buffers.hostOccupied,
+                             alpaka::makeView(device, buffers.ranks.data() + words, Vec1D{1}));
+      alpaka::onHost::wait(queue);
+
+      m_view.occupancy = buffers.occupancy.data();
+      m_view.ranks = buffers.ranks.data();
+      return buffers.hostOccupied[0];
+    }
   };
 
 }  // namespace clue::internal
@@ -7,6 +7,7 @@
 #include "CLUEstering/data_structures/internal/VecArray.hpp"
 #include "CLUEstering/detail/make_array.hpp"
 #include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <alpaka/alpaka.hpp>
@@ -20,6 +21,15 @@ namespace clue::internal {
     int32_t* offsets;
     CoordinateExtremes<Ndim>* minmax;
     float* tilesizes;
+    // internal edges of the tiles, nperdim - 1 for each dimension, or null for uniform tiles
+    const float* edges;
+    // position of each tile, in row-major order, along a space-filling curve,
+    // or null for tiles stored in row-major order
+    const int32_t* order;
+    // with sparse storage, a bit for each tile marking the occupied ones, and the number of
+    // occupied tiles preceding each word of the bitmap, or null for dense storage
+    const uint32_t* occupancy;
+    const int32_t* ranks;
     uint8_t* wrapping;
     int32_t npoints;
     int32_t ntiles;
@@ -35,6 +45,10 @@ namespace clue::internal {
     ALPAKA_FN_ACC inline constexpr uint8_t* wrapped() { return wrapping; }
 
     ALPAKA_FN_ACC inline constexpr int getBin(float coord, int dim) const {
+      if (edges != nullptr) {
+        return getQuantileBin(wrapping[dim] ? normalizeCoordinate(coord, dim) : coord, dim);
+      }
+
       int coord_bin;
       if (wrapping[dim]) {
         coord_bin =
@@ -50,6 +64,23 @@ namespace clue::internal {
       return coord_bin;
     }
 
+    // Binary search of the first edge larger than the coordinate, which also
+    // assigns the points outside of the extremes to the tiles on the border
+    ALPAKA_FN_ACC inline constexpr int getQuantileBin(float coord, int dim) const {
+      const auto* dim_edges = edges + dim * (nperdim - 1);
+      int low = 0;
+      int high = nperdim - 1;
+      while (low < high) {
+        const auto middle = (low + high) / 2;
+        if (dim_edges[middle] <= coord) {
+          low = middle + 1;
+        } else {
+          high = middle;
+        }
+      }
+      return low;
+    }
+
     ALPAKA_FN_ACC inline constexpr int getGlobalBin(const float* coords) const {
       int global_bin = 0;
       for (auto dim = 0u; dim != Ndim - 1; ++dim) {
@@ -57,7 +88,7 @@ namespace clue::internal {
                       getBin(coords[dim], dim);
       }
       global_bin += getBin(coords[Ndim - 1], Ndim - 1);
-      return global_bin;
+      return order != nullptr ? order[global_bin] : global_bin;
     }
 
     ALPAKA_FN_ACC inline constexpr int getGlobalBinByBin(const VecArray<int32_t, Ndim>& Bins) const {
@@ -66,11 +97,11 @@ namespace clue::internal {
         auto bin_i = wrapping[dim] ? (Bins[dim] % nperdim) : Bins[dim];
         globalBin += alpaka::math::pow(static_cast<float>(nperdim), Ndim - dim - 1) * bin_i;
       }
-      return globalBin;
+      return order != nullptr ? order[globalBin] : globalBin;
     }
 
     ALPAKA_FN_ACC inline void searchBox(const SearchBoxExtremes<Ndim>& searchbox_extremes,
-                                        SearchBoxBins<Ndim>& searchbox_bins) {
+                                        SearchBoxBins<Ndim>& searchbox_bins) const {
       for (auto dim = 0u; dim != Ndim; ++dim) {
         auto infBin = getBin(searchbox_extremes[dim][0], dim);
         auto supBin = getBin(searchbox_extremes[dim][1], dim);
@@ -81,9 +112,64 @@ namespace clue::internal {
       }
     }
 
-    constexpr auto operator[](int32_t globalBinId) {
-      const auto offset0 = offsets[globalBinId];
-      const auto offset1 = offsets[globalBinId + 1];
+    // Call a function on all the points contained in the tiles overlapping with the
+    // search box of a point
+    template <typename TFunc>
+    ALPAKA_FN_ACC inline void forEachCandidate(const std::array<float, Ndim + 1>& coords,
+                                               float radius,
+                                               TFunc&& func) const {
+      SearchBoxExtremes<Ndim> searchbox_extremes;
+      for (auto dim = 0u; dim != Ndim; ++dim) {
+        searchbox_extremes[dim] = nostd::make_array(coords[dim] - radius, coords[dim] + radius);
+      }
+      SearchBoxBins<Ndim> searchbox_bins;
+      searchBox(searchbox_extremes, searchbox_bins);
+
+      VecArray<int32_t, Ndim> base_vec{};
+      forEachInBins<Ndim>(base_vec, searchbox_bins, func);
+    }
+
+    template <std::size_t N_, typename TFunc>
+    ALPAKA_FN_ACC inline void forEachInBins(VecArray<int32_t, Ndim>& base_vec,
+                                            const SearchBoxBins<Ndim>& search_box,
+                                            TFunc& func) const {
+      if constexpr (N_ == 0) {
+        const auto key = tileKey(getGlobalBinByBin(base_vec));
+        if (key < 0) {
+          return;
+        }
+        for (auto offset = offsets[key]; offset < offsets[key + 1]; ++offset) {
+          func(indexes[offset]);
+        }
+      } else {
+        for (auto i = search_box[Ndim - N_][0]; i <= search_box[Ndim - N_][1]; ++i) {
+          base_vec[Ndim - N_] = i;
+          forEachInBins<N_ - 1>(base_vec, search_box, func);
+        }
+      }
+    }
+
+    // The position of a tile in the offsets. With sparse storage only the occupied tiles
+    // are stored, in the same order, and the empty ones are skipped returning -1
+    ALPAKA_FN_ACC inline constexpr int32_t tileKey(int32_t globalBin) const {
+      if (occupancy == nullptr) {
+        return globalBin;
+      }
+      const auto word = occupancy[globalBin / 32];
+      const auto mask = uint32_t{1} << (globalBin % 32);
+      if ((word & mask) == 0) {
+        return -1;
+      }
+      return ranks[globalBin / 32] + std::popcount(word & (mask - 1));
+    }
+
+    constexpr auto operator[](int32_t globalBinId) const {
+      const auto key = tileKey(globalBinId);
+      if (key < 0) {
+        return std::span<int, std::dynamic_extent>{indexes, std::size_t{0}};
+      }
+      const auto offset0 = offsets[key];
+      const auto offset1 = offsets[key + 1];
 
       int32_t* buf_ptr = indexes + offset0;
       // Note: this template instantiation is NOT redundant since CTAD uses functions not marked __host__ __device__
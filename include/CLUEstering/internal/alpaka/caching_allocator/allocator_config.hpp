@@ -22,4 +22,14 @@ namespace clue::config {
 
   // if both maxCachedBytes and maxCachedFraction are non-zero, the smallest resulting value is used.
 
+  // largest block served by the per-thread caches and the lock-free lists, which handle the
+  // frequent small allocations without taking the lock of the allocator
+  constexpr size_t smallBlockBytes = 1 << 20;  // 1 MB
+
+  // number of free blocks of each small bin kept by each thread
+  constexpr unsigned int magazineSize = 4;
+
+  // number of slots in the lock-free list of free blocks of each small bin
+  constexpr unsigned int freeListSize = 32;
+
 }  // namespace clue::config
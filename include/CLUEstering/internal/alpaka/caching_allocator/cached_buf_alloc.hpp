@@ -5,8 +5,37 @@
 #include "CLUEstering/detail/concepts.hpp"
 #include "CLUEstering/internal/alpaka/caching_allocator/get_device_caching_allocator.hpp"
 #include "CLUEstering/internal/alpaka/caching_allocator/get_host_caching_allocator.hpp"
+#include "CLUEstering/internal/nostd/huge_pages.hpp"
+#include "CLUEstering/internal/nostd/numa.hpp"
+#include "CLUEstering/utils/allocator_config.hpp"
+#include <cstddef>
 
 namespace clue {
+  namespace detail {
+    // Whether a host buffer should be backed by huge pages, which requires it to be at least
+    // as large as the threshold of the configuration and as one huge page
+    inline bool use_huge_pages(std::size_t bytes, const AllocatorConfig& config) {
+      return config.hugePageThreshold > 0 && bytes >= config.hugePageThreshold &&
+             bytes >= nostd::huge_page_bytes;
+    }
+
+    // Apply the page size and the NUMA placement of the configuration to a new host buffer,
+    // which must not have been touched yet. The configuration can no longer be changed
+    // afterwards, so that all the buffers are placed with the same one
+    inline void place_host_memory(void* data, std::size_t bytes) {
+      if (bytes < nostd::huge_page_bytes) {
+        return;
+      }
+      const auto config = use_allocator_config();
+      if (use_huge_pages(bytes, config)) {
+        nostd::advise_huge_pages(data, bytes);
+      }
+      if (config.numaInterleave && bytes >= nostd::numa_min_bytes) {
+        nostd::interleave_pages(data, bytes);
+      }
+    }
+  }  // namespace detail
+
   template <alpaka::concepts::Vector T>
   auto getVec(T&& extent) {
     return std::forward<T>(extent);
@@ -30,7 +59,9 @@ namespace clue {
       ALPAKA_FN_HOST static auto allocCachedBuf(TDev const&, TQueue&, auto&& extent)
           -> auto{
         // non-cached host-only memory
-        return alpaka::onHost::allocHost<TElem>(ALPAKA_FORWARD(extent));
+        auto buffer = alpaka::onHost::allocHost<TElem>(extent);
+        detail::place_host_memory(buffer.data(), getVec(extent).product() * sizeof(TElem));
+        return buffer;
       }
     };
     //! The caching memory allocator implementation for the pinned host memory (requires the queue to be based on a non-host api)
@@ -41,9 +72,10 @@ namespace clue {
         alpaka::Vec const extents_vec = extent;
         size_t size = extents_vec.product();
         size_t sizeBytes = size * sizeof(TElem);
-        void* memPtr = allocator.allocate(sizeBytes, queue);
+        auto* block = allocator.allocate(sizeBytes, queue);
+        void* memPtr = block->data();
         // use a custom deleter to return the buffer to the CachingAllocator
-        auto deleter = [alloc = &allocator](TElem* ptr) { alloc->free(ptr); };
+        auto deleter = [alloc = &allocator, block](TElem*) { alloc->free(block); };
         auto pitchMd = alpaka::calculatePitchesFromExtents<TElem>(extents_vec);
         return alpaka::onHost::SharedBuffer{alpaka::api::host,
                                             reinterpret_cast<TElem*>(memPtr),
@@ -65,10 +97,10 @@ namespace clue {
         size_t size = extents_vec.product();
         size_t sizeBytes = size * sizeof(TElem);
 
-        void* memPtr = allocator.allocate(sizeBytes, queue);
-        auto* ptr = static_cast<TElem*>(memPtr);
+        auto* block = allocator.allocate(sizeBytes, queue);
+        auto* ptr = static_cast<TElem*>(block->data());
         // use a custom deleter to return the buffer to the CachingAllocator
-        auto deleter = [alloc = &allocator, ptr] { alloc->free(ptr); };
+        auto deleter = [alloc = &allocator, block] { alloc->free(block); };
         auto pitchMd = alpaka::calculatePitchesFromExtents<TElem>(extents_vec);
         return alpaka::onHost::SharedBuffer{
             api, ptr, ALPAKA_FORWARD(extents_vec), std::move(pitchMd), deleter};
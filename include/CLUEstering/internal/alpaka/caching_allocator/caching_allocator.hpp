@@ -1,22 +1,33 @@
 
 #pragma once
 
+#include "allocator_config.hpp"
 #include "allocator_policy.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <exception>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 #include <alpaka/alpaka.hpp>
 
 #include "CLUEstering/internal/alpaka/devices.hpp"
+#include "CLUEstering/utils/allocator_config.hpp"
 
 #include <CLUEstering/internal/alpaka/memory.hpp>
 #include <CLUEstering/internal/alpaka/memory.hpp>
@@ -28,8 +39,8 @@ namespace clue {
 
   namespace detail {
 
-    constexpr unsigned int power(unsigned int base, unsigned int exponent) {
-      unsigned int power = 1;
+    constexpr size_t power(size_t base, unsigned int exponent) {
+      size_t power = 1;
       while (exponent > 0) {
         if (exponent & 1) {
           power = power * base;
@@ -110,6 +121,24 @@ namespace clue {
       size_t requested = 0;  // total bytes requested and currently in use on this device
     };
 
+    // A memory block, owned by the caller between allocate() and free(), and by the allocator
+    // while it is cached
+    struct Block {
+      std::optional<Buffer> buffer;
+      std::optional<Queue> queue;
+      std::optional<Event> event;
+      size_t bytes = 0;
+      size_t requested = 0;  // for monitoring only
+      unsigned int bin = 0;
+      Block() = default;
+      Block(Block const&) = delete;
+      Block& operator=(Block const&) = delete;
+      // the memory of the block
+      void* data() { return buffer->data(); }
+      // the "synchronisation device" for this block
+      auto device() { return queue->getDevice(); }
+    };
+
     explicit CachingAllocator(
         Device const& device,
         TQueue const& queue,  //queue for type deduction
@@ -134,6 +163,10 @@ namespace clue {
           minBinBytes_(detail::power(binGrowth, minBin)),
           maxBinBytes_(detail::power(binGrowth, maxBin)),
           maxCachedBytes_(cacheSize(maxCachedBytes, maxCachedFraction)),
+          smallBins_(countSmallBins(binGrowth, minBin, maxBin)),
+          freeLists_(smallBins_),
+          id_(acquireId()),
+          serial_(nextSerial_.fetch_add(1, std::memory_order_relaxed)),
           reuseSameQueueAllocations_(reuseSameQueueAllocations),
           debug_(debug) {
       if (debug_) {
@@ -147,7 +180,8 @@ namespace clue {
           auto binSize = detail::power(binGrowth, bin);
           out << "    " << std::right << std::setw(12) << detail::as_bytes(binSize) << '\n';
         }
-        out << "  maximum amount of cached memory: " << detail::as_bytes(maxCachedBytes_);
+        out << "  maximum amount of cached memory: " << detail::as_bytes(maxCachedBytes_) << '\n'
+            << "  bins cached per thread: " << smallBins_;
         std::cout << out.str() << '\n';
       }
     }
@@ -156,122 +190,169 @@ namespace clue {
     CachingAllocator(CachingAllocator&&) = default;
     CachingAllocator& operator=(CachingAllocator&&) = default;
     ~CachingAllocator() {
-      {
-        // this should never be called while some memory blocks are still live
-        std::scoped_lock lock(mutex_);
-        assert(liveBlocks_.empty());
-        assert(cachedBytes_.live == 0);
-      }
+      // this should never be called while some memory blocks are still live
+      assert(liveBlocks_.load() == 0);
+      assert(liveBytes_.load() == 0);
+      // the magazines of the threads which are still running outlive the allocator,
+      // so their cached blocks are freed and they are detached from it
+      emptyMagazines(true);
       freeAllCached();
+      releaseId(id_);
     }
 
     // return a copy of the cache allocation status, for monitoring purposes
     CachedBytes cacheStatus() const {
-      std::scoped_lock lock(mutex_);
-      return cachedBytes_;
+      return CachedBytes{freeBytes_.load(std::memory_order_relaxed),
+                         liveBytes_.load(std::memory_order_relaxed),
+                         requestedBytes_.load(std::memory_order_relaxed)};
     }
 
-    // Allocate given number of bytes on the current device associated to given queue
-    void* allocate(size_t bytes, Queue& queue) {
-      // create a block descriptor for the requested allocation
-      BlockDescriptor block;
-      // currently a copy of the queue as and any pointer/reference might become dangling
-      //@TODO ensure queue pointer is never dangling or use a shared pointer owned by the caller
-      block.queue = queue;
-      block.requested = bytes;
-      std::tie(block.bin, block.bytes) = findBin(bytes);
-
-      // try to re-use a cached block, or allocate a new buffer
-      if (not tryReuseCachedBlock(block)) {
-        allocateNewBlock(block);
-      }
-
-      // Insert the allocation into the live blocks exactly once, and keep the pointer stable.
-      void* ptr = block.buffer->data();
-      {
-        std::scoped_lock lock(mutex_);
-        // avoids copying the block or some shared buffers (transfers ownership to liveBlocks_).
-        liveBlocks_.emplace(ptr, std::move(block));
-      }
-      return ptr;
+    // return the statistics of the allocator, for monitoring purposes
+    AllocatorStats stats() const {
+      AllocatorStats stats;
+      stats.hits = hits_.load(std::memory_order_relaxed);
+      stats.misses = misses_.load(std::memory_order_relaxed);
+      stats.liveBlocks = liveBlocks_.load(std::memory_order_relaxed);
+      stats.liveBytes = liveBytes_.load(std::memory_order_relaxed);
+      stats.cachedBytes = freeBytes_.load(std::memory_order_relaxed);
+      stats.requestedBytes = requestedBytes_.load(std::memory_order_relaxed);
+      return stats;
     }
 
-    // frees an allocation
-    void free(void* ptr) {
-      std::scoped_lock lock(mutex_);
-
-      auto i_block = liveBlocks_.find(ptr);
-      if (i_block == liveBlocks_.end()) {
-        std::stringstream ss;
-        ss << "Trying to free a non-live block at " << ptr;
-        throw std::runtime_error(ss.str());
-      }
-
-      // remove the block from the list of live blocks
-      BlockDescriptor block = std::move(i_block->second);
-      liveBlocks_.erase(i_block);
-
-      cachedBytes_.live -= block.bytes;
-      cachedBytes_.requested -= block.requested;
+    // Allocate given number of bytes on the current device associated to given queue.
+    // The returned block must be given back to free() once it is no longer used.
+    Block* allocate(size_t bytes, Queue& queue) {
+      const auto [bin, binBytes] = findBin(bytes);
 
-      bool recache = (cachedBytes_.free + block.bytes <= maxCachedBytes_);
-      if (recache) {
-        block.queue->enqueue(*(block.event));
-        cachedBytes_.free += block.bytes;
-
-        // After the call to emplace(), cachedBlocks_ owns the block again.
-        // NOTE: grab debug info before move.
-        auto bin = block.bin;
-        auto bytes_ = block.bytes;
-
-        // move into cache (no copy)
-        cachedBlocks_.emplace(bin, std::move(block));
+      // try to re-use a cached block, or allocate a new buffer
+      auto block = tryReuseCachedBlock(bin, queue);
+      if (block) {
+        // associate the cached buffer to the new queue
+        block->queue = queue;
+
+        // if the new queue is on different device than the old event, create a new event
+        if (block->device() != block->event->getDevice()) {
+          block->event = block->device().makeEvent();
+        }
+        freeBytes_.fetch_sub(block->bytes, std::memory_order_relaxed);
+        hits_.fetch_add(1, std::memory_order_relaxed);
 
         if (debug_) {
           std::ostringstream out;
-          out << "\t " << alpaka::onHost::getName(device_)
-              << " returned " << bytes_ << " bytes at " << ptr << " from associated queue "
-              << alpaka::onHost::demangledName<TQueue>() << " .\n\t\t " << cachedBlocks_.size()
-              << " available blocks cached (" << cachedBytes_.free << " bytes), "
-              << liveBlocks_.size() << " live blocks (" << cachedBytes_.live
-              << " bytes) outstanding." << std::endl;
-          std::cout << out.str() << std::endl;
+          out << "\t" << alpaka::onHost::getName(device_) << " reused cached block at "
+              << block->data() << " (" << block->bytes << " bytes) for queue "
+              << alpaka::onHost::getName(*block->queue) << ", event "
+              << alpaka::onHost::getName(*block->event) << "." << std::endl;
+          std::cout << out.str() << '\n';
         }
       } else {
+        block = allocateNewBlock(bin, binBytes, queue);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      block->requested = bytes;
+      liveBlocks_.fetch_add(1, std::memory_order_relaxed);
+      liveBytes_.fetch_add(block->bytes, std::memory_order_relaxed);
+      requestedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+      return block.release();
+    }
+
+    // frees an allocation
+    void free(Block* ptr) {
+      std::unique_ptr<Block> block(ptr);
+      liveBlocks_.fetch_sub(1, std::memory_order_relaxed);
+      liveBytes_.fetch_sub(block->bytes, std::memory_order_relaxed);
+      requestedBytes_.fetch_sub(block->requested, std::memory_order_relaxed);
+
+      if (not reserveCachedBytes(block->bytes)) {
         // if the buffer is not recached, it is automatically freed when block goes out of scope
         if (debug_) {
           std::ostringstream out;
-          out << "\t " << alpaka::onHost::getName(device_) << " freed "
-              << block.bytes << " bytes at " << ptr << " from associated queue "
-              << alpaka::onHost::getName(*block.queue) << ", event "
-              << alpaka::onHost::getName(*block.event) << " .\n\t\t " << cachedBlocks_.size()
-              << " available blocks cached (" << cachedBytes_.free << " bytes), "
-              << liveBlocks_.size() << " live blocks (" << cachedBytes_.live
-              << " bytes) outstanding." << std::endl;
+          out << "\t " << alpaka::onHost::getName(device_) << " freed " << block->bytes
+              << " bytes at " << block->data() << " from associated queue "
+              << alpaka::onHost::getName(*block->queue) << ", event "
+              << alpaka::onHost::getName(*block->event) << " .\n\t\t "
+              << freeBytes_.load(std::memory_order_relaxed) << " bytes cached, "
+              << liveBytes_.load(std::memory_order_relaxed) << " live bytes outstanding."
+              << std::endl;
           std::cout << out.str() << std::endl;
         }
+        return;
+      }
+
+      block->queue->enqueue(*(block->event));
+      if (debug_) {
+        std::ostringstream out;
+        out << "\t " << alpaka::onHost::getName(device_) << " returned " << block->bytes
+            << " bytes at " << block->data() << " from associated queue "
+            << alpaka::onHost::demangledName<TQueue>() << " .\n\t\t "
+            << freeBytes_.load(std::memory_order_relaxed) << " bytes cached, "
+            << liveBytes_.load(std::memory_order_relaxed) << " live bytes outstanding."
+            << std::endl;
+        std::cout << out.str() << std::endl;
+      }
+
+      if (isSmall(block->bin)) {
+        // the thread keeps the last blocks it freed, which are the most likely to be reused
+        auto& magazine = threadMagazine();
+        auto& cache = magazine.bins[block->bin - minBin_];
+        if (cache.size() < config::magazineSize) {
+          cache.push_back(std::move(block));
+          return;
+        }
       }
+      cacheBlock(std::move(block));
     }
 
   private:
-    struct BlockDescriptor {
-      std::optional<Buffer> buffer;
-      std::optional<Queue> queue;
-      std::optional<Event> event;
-      size_t bytes = 0;
-      size_t requested = 0;  // for monitoring only
-      unsigned int bin = 0;
-      BlockDescriptor() = default;
-      BlockDescriptor(BlockDescriptor const&) = delete;
-      BlockDescriptor& operator=(BlockDescriptor const&) = delete;
-      BlockDescriptor(BlockDescriptor&&) = default;
-      //only allow move semantics (transfer ownership to active block)
-      BlockDescriptor& operator=(BlockDescriptor&&) = default;
-      // the "synchronisation device" for this block
-      auto device() { return queue->getDevice(); }
+    // Free blocks cached by a thread, which are accessed without synchronization by the thread
+    // alone. Other threads reclaim them, after a failed allocation, by asking the thread to
+    // return them to the lock-free lists and to the shared cache at its next allocation or free.
+    // The lock of the magazine is only taken to detach it, when either the thread terminates or
+    // the allocator is destroyed. The magazine is shared by the thread and the allocator, so that
+    // neither of them can access it after it has been destroyed by the other one
+    struct Magazine {
+      std::mutex mutex;
+      // protected by the mutex of the magazine, reset when the allocator is destroyed
+      CachingAllocator* owner = nullptr;
+      std::atomic<bool> drain{false};
+      std::vector<std::vector<std::unique_ptr<Block>>> bins;  // one per small bin
+    };
+
+    // Reference of a thread to its magazine. The blocks of a thread that terminates are
+    // returned to the shared cache, unless the allocator has already been destroyed.
+    // The lock of the magazine is held meanwhile, so that the allocator, which takes it to
+    // detach the magazine, can't be destroyed before the blocks are returned
+    struct MagazineHandle {
+      std::shared_ptr<Magazine> magazine;
+      size_t serial = 0;  // of the allocator owning the magazine
+
+      MagazineHandle() = default;
+      MagazineHandle(MagazineHandle&&) = default;
+      MagazineHandle& operator=(MagazineHandle&&) = default;
+      ~MagazineHandle() {
+        if (magazine) {
+          std::scoped_lock lock(magazine->mutex);
+          if (magazine->owner != nullptr) {
+            magazine->owner->releaseMagazine(*magazine);
+          }
+        }
+      }
+    };
+
+    // Bounded lock-free list of the free blocks of a small bin. A block is published by
+    // storing it in an empty slot and taken by exchanging its slot with a null pointer, so
+    // each block is owned by a single thread at any time and the list is immune to ABA
+    struct FreeList {
+      std::array<std::atomic<Block*>, config::freeListSize> slots{};
+
+      ~FreeList() {
+        for (auto& slot : slots) {
+          delete slot.load();
+        }
+      }
     };
 
-  private:
     // return the maximum amount of memory that should be cached on this device
     size_t cacheSize(size_t maxCachedBytes, double maxCachedFraction) const {
       // note that getMemBytes() returns 0 if the platform does not support querying the device memory
@@ -288,6 +369,21 @@ namespace clue {
       return size;
     }
 
+    // return the number of bins, starting from the smallest one, served by the magazines
+    // and the lock-free lists
+    static unsigned int countSmallBins(unsigned int binGrowth,
+                                       unsigned int minBin,
+                                       unsigned int maxBin) {
+      unsigned int bins = 0;
+      while (minBin + bins <= maxBin and
+             detail::power(binGrowth, minBin + bins) <= config::smallBlockBytes) {
+        ++bins;
+      }
+      return bins;
+    }
+
+    bool isSmall(unsigned int bin) const { return bin - minBin_ < smallBins_; }
+
     // return (bin, bin size)
     std::tuple<unsigned int, size_t> findBin(size_t bytes) const {
       if (bytes < minBinBytes_) {
@@ -308,57 +404,219 @@ namespace clue {
       return std::make_tuple(bin, binBytes);
     }
 
-    bool tryReuseCachedBlock(BlockDescriptor& block) {
+    // a cached block can be reused once the operations on it have completed, or right away
+    // by the same queue, which executes them in order
+    bool isReusable(Block& block, Queue const& queue) const {
+      return (reuseSameQueueAllocations_ and (queue == *block.queue)) or block.event->isComplete();
+    }
+
+    // account for a block being added to the cache, unless the cache is full
+    bool reserveCachedBytes(size_t bytes) {
+      auto cached = freeBytes_.load(std::memory_order_relaxed);
+      do {
+        if (cached + bytes > maxCachedBytes_) {
+          return false;
+        }
+      } while (not freeBytes_.compare_exchange_weak(cached, cached + bytes, std::memory_order_relaxed));
+      return true;
+    }
+
+    // The ids of the allocators index their magazines among the ones of each thread. They are
+    // reused after an allocator is destroyed, so that the magazines of a thread are bounded by
+    // the number of allocators alive at the same time
+    static size_t acquireId() {
+      std::scoped_lock lock(idsMutex_);
+      if (freeIds_.empty()) {
+        return nextId_++;
+      }
+      const auto id = freeIds_.back();
+      freeIds_.pop_back();
+      return id;
+    }
+
+    static void releaseId(size_t id) {
+      std::scoped_lock lock(idsMutex_);
+      freeIds_.push_back(id);
+    }
+
+    // the magazine of the calling thread. A magazine left by a destroyed allocator with the same
+    // id is told apart by the serial number of the allocator, which is never reused
+    Magazine& threadMagazine() {
+      thread_local std::vector<MagazineHandle> magazines;
+      if (magazines.size() <= id_) {
+        magazines.resize(id_ + 1);
+      }
+      auto& handle = magazines[id_];
+      if (not handle.magazine or handle.serial != serial_) {
+        auto magazine = std::make_shared<Magazine>();
+        magazine->owner = this;
+        magazine->bins.resize(smallBins_);
+        {
+          std::scoped_lock lock(mutex_);
+          magazines_.push_back(magazine);
+        }
+        handle = MagazineHandle{};
+        handle.magazine = std::move(magazine);
+        handle.serial = serial_;
+      }
+      auto& magazine = *handle.magazine;
+      if (magazine.drain.load(std::memory_order_relaxed)) {
+        magazine.drain.store(false, std::memory_order_relaxed);
+        drainMagazine(magazine);
+      }
+      return magazine;
+    }
+
+    // return the blocks of the magazine of the calling thread to the shared cache
+    void drainMagazine(Magazine& magazine) {
+      for (auto& cache : magazine.bins) {
+        for (auto& block : cache) {
+          cacheBlock(std::move(block));
+        }
+        cache.clear();
+      }
+    }
+
+    // return the blocks of the magazine of a terminating thread to the shared cache,
+    // called with the lock of the magazine held
+    void releaseMagazine(Magazine& magazine) {
       std::scoped_lock lock(mutex_);
+      for (auto& cache : magazine.bins) {
+        for (auto& block : cache) {
+          const auto bin = block->bin;
+          cachedBlocks_.emplace(bin, std::move(block));
+        }
+        cache.clear();
+      }
+      magazine.owner = nullptr;
+      std::erase_if(magazines_, [&](auto const& other) { return other.get() == &magazine; });
+    }
 
-      // iterate through the range of cached blocks in the same bin
-      const auto [begin, end] = cachedBlocks_.equal_range(block.bin);
-      for (auto it = begin; it != end; ++it) {
-        if ((reuseSameQueueAllocations_ and (*block.queue == *(it->second.queue))) or
-            it->second.event->isComplete()) {
-          // associate the cached buffer to the new queue
-          Queue newQueue = std::move(*(block.queue));
-
-          // take ownership of cached entry without copying
-          // (extract removes the node from the multimap but keeps its storage intact)
-          auto node = cachedBlocks_.extract(it);
-
-          // accounting info must be captured before moving out of node.mapped()
-          const auto reusedBytes = node.mapped().bytes;
-          const auto reusedRequested = node.mapped().requested;
-
-          // move cached descriptor out (no copy of SharedBuffer)
-          // TODO cache (or remove) the debug information and use std::move()
-          block = std::move(node.mapped());
-          block.queue = std::move(newQueue);
-
-          // if the new queue is on different device than the old event, create a new event
-          if (block.device() != block.event->getDevice()) {
-            block.event = block.device().makeEvent();
+    // Reclaim the blocks in the magazines of all the threads. The magazine of the calling thread
+    // is returned to the shared cache right away, and the other threads are asked to return
+    // theirs. When the allocator is destroyed, no thread can be using it, so the blocks of all
+    // the magazines are freed and the magazines are detached from the allocator. The lock of the
+    // allocator is released before taking the ones of the magazines, which a terminating thread
+    // takes in the opposite order
+    void emptyMagazines(bool detach) {
+      std::vector<std::shared_ptr<Magazine>> magazines;
+      {
+        std::scoped_lock lock(mutex_);
+        if (detach) {
+          magazines.swap(magazines_);
+        } else {
+          magazines = magazines_;
+        }
+      }
+      if (not detach) {
+        for (auto& magazine : magazines) {
+          magazine->drain.store(true, std::memory_order_relaxed);
+        }
+        threadMagazine();
+        return;
+      }
+      for (auto& magazine : magazines) {
+        std::vector<std::unique_ptr<Block>> blocks;
+        {
+          std::scoped_lock lock(magazine->mutex);
+          for (auto& cache : magazine->bins) {
+            std::move(cache.begin(), cache.end(), std::back_inserter(blocks));
+            cache.clear();
           }
+          magazine->owner = nullptr;
+        }
+        // the blocks are freed outside of the lock of the magazine
+        for (auto& block : blocks) {
+          freeBytes_.fetch_sub(block->bytes, std::memory_order_relaxed);
+        }
+      }
+    }
 
-          // update the accounting information
-          cachedBytes_.free -= reusedBytes;
-          cachedBytes_.live += reusedBytes;
-          cachedBytes_.requested += reusedRequested;
-
-          if (debug_) {
-            std::ostringstream out;
-            out << "\t" << alpaka::onHost::getName(device_)
-                << " reused cached block at " << block.buffer->data() << " (" << reusedBytes
-                << " bytes) for queue " << alpaka::onHost::getName(*block.queue) << ", event "
-                << alpaka::onHost::getName(*block.event) << "." << std::endl;
-            std::cout << out.str() << '\n';
-          }
+    // distribute the threads over the slots of the lock-free lists, to limit the contention
+    static size_t slotHint() {
+      thread_local const auto hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+      return hint;
+    }
 
-          // cached block has been removed from cachedBlocks_ by extract()
+    bool pushFreeList(std::unique_ptr<Block>& block) {
+      auto& slots = freeLists_[block->bin - minBin_].slots;
+      const auto hint = slotHint();
+      for (size_t i = 0; i < slots.size(); ++i) {
+        auto& slot = slots[(hint + i) % slots.size()];
+        Block* empty = nullptr;
+        if (slot.load(std::memory_order_relaxed) == nullptr and
+            slot.compare_exchange_strong(empty, block.get(), std::memory_order_release, std::memory_order_relaxed)) {
+          block.release();
           return true;
         }
       }
-
       return false;
     }
 
+    std::unique_ptr<Block> popFreeList(unsigned int bin, Queue const& queue) {
+      auto& slots = freeLists_[bin - minBin_].slots;
+      const auto hint = slotHint();
+      for (size_t i = 0; i < slots.size(); ++i) {
+        auto& slot = slots[(hint + i) % slots.size()];
+        if (slot.load(std::memory_order_relaxed) == nullptr) {
+          continue;
+        }
+        std::unique_ptr<Block> block(slot.exchange(nullptr, std::memory_order_acquire));
+        if (not block) {
+          continue;
+        }
+        if (isReusable(*block, queue)) {
+          return block;
+        }
+        // the block is still in use by another queue, so it is given back
+        cacheBlock(std::move(block));
+      }
+      return nullptr;
+    }
+
+    // move a free block to the shared cache
+    void cacheBlock(std::unique_ptr<Block> block) {
+      if (isSmall(block->bin) and pushFreeList(block)) {
+        return;
+      }
+      std::scoped_lock lock(mutex_);
+      const auto bin = block->bin;
+      cachedBlocks_.emplace(bin, std::move(block));
+    }
+
+    // look for a reusable block first in the magazine of the thread, then in the lock-free
+    // list of the bin and finally in the cache protected by the lock
+    std::unique_ptr<Block> tryReuseCachedBlock(unsigned int bin, Queue const& queue) {
+      if (isSmall(bin)) {
+        {
+          auto& magazine = threadMagazine();
+          auto& cache = magazine.bins[bin - minBin_];
+          for (auto it = cache.rbegin(); it != cache.rend(); ++it) {
+            if (isReusable(**it, queue)) {
+              auto block = std::move(*it);
+              cache.erase(std::next(it).base());
+              return block;
+            }
+          }
+        }
+        if (auto block = popFreeList(bin, queue)) {
+          return block;
+        }
+      }
+
+      std::scoped_lock lock(mutex_);
+      // iterate through the range of cached blocks in the same bin
+      const auto [begin, end] = cachedBlocks_.equal_range(bin);
+      for (auto it = begin; it != end; ++it) {
+        if (isReusable(*it->second, queue)) {
+          auto block = std::move(it->second);
+          cachedBlocks_.erase(it);
+          return block;
+        }
+      }
+      return nullptr;
+    }
+
     Buffer allocateBuffer(size_t bytes, Queue const& queue) {
       if constexpr (std::is_same_v<Device, ALPAKA_TYPEOF(queue.getDevice())>) {
         // allocate device memory
@@ -377,60 +635,68 @@ namespace clue {
       }
     }
 
-    void allocateNewBlock(BlockDescriptor& block) {
+    std::unique_ptr<Block> allocateNewBlock(unsigned int bin, size_t bytes, Queue& queue) {
+      auto block = std::make_unique<Block>();
+      block->queue = queue;
+      block->bytes = bytes;
+      block->bin = bin;
       try {
-        block.buffer = allocateBuffer(block.bytes, *block.queue);
+        block->buffer = allocateBuffer(block->bytes, *block->queue);
       } catch (std::runtime_error const& e) {
         // the allocation attempt failed: free all cached blocks on the device and retry
         if (debug_) {
           std::ostringstream out;
           out << "\t" << alpaka::onHost::getName(device_)
-              << " failed to allocate " << block.bytes << " bytes for queue "
-              << alpaka::onHost::getName(*block.queue) << ", retrying after freeing cached allocations"
+              << " failed to allocate " << block->bytes << " bytes for queue "
+              << alpaka::onHost::getName(*block->queue) << ", retrying after freeing cached allocations"
               << std::endl;
           std::cout << out.str() << std::endl;
         }
         // TODO implement a method that frees only up to block.bytes bytes
+        emptyMagazines(false);
         freeAllCached();
 
         // throw an exception if it fails again
-        block.buffer = allocateBuffer(block.bytes, *block.queue);
+        block->buffer = allocateBuffer(block->bytes, *block->queue);
       }
 
       // create a new event associated to the "synchronisation device"
-      block.event = block.device().makeEvent();
-
-      {
-        // cachedBytes_ is shared state; keep original locking discipline
-        std::scoped_lock lock(mutex_);
-        cachedBytes_.live += block.bytes;
-        cachedBytes_.requested += block.requested;
-      }
+      block->event = block->device().makeEvent();
 
       if (debug_) {
         std::ostringstream out;
         out << "\t" << alpaka::onHost::getName(device_)
-            << " allocated new block at " << block.buffer->data() << " (" << block.bytes
-            << " bytes associated with queue " << alpaka::onHost::getName(*block.queue)
-            << ", event " << alpaka::onHost::getName(*block.event) << ")." << std::endl;
+            << " allocated new block at " << block->data() << " (" << block->bytes
+            << " bytes associated with queue " << alpaka::onHost::getName(*block->queue)
+            << ", event " << alpaka::onHost::getName(*block->event) << ")." << std::endl;
         std::cout << out.str() << std::endl;
       }
+      return block;
     }
 
+    // free the blocks in the lock-free lists and in the cache protected by the lock
     void freeAllCached() {
-      std::scoped_lock lock(mutex_);
+      for (auto& list : freeLists_) {
+        for (auto& slot : list.slots) {
+          std::unique_ptr<Block> block(slot.exchange(nullptr, std::memory_order_acquire));
+          if (block) {
+            freeBytes_.fetch_sub(block->bytes, std::memory_order_relaxed);
+          }
+        }
+      }
 
+      std::scoped_lock lock(mutex_);
       while (not cachedBlocks_.empty()) {
         auto iBlock = cachedBlocks_.begin();
-        cachedBytes_.free -= iBlock->second.bytes;
+        freeBytes_.fetch_sub(iBlock->second->bytes, std::memory_order_relaxed);
 
         if (debug_) {
           std::ostringstream out;
           out << "\t" << alpaka::onHost::getName(device_) << " freed "
-              << iBlock->second.bytes << " bytes.\n\t\t  " << (cachedBlocks_.size() - 1)
-              << " available blocks cached (" << cachedBytes_.free << " bytes), "
-              << liveBlocks_.size() << " live blocks (" << cachedBytes_.live
-              << " bytes) outstanding." << std::endl;
+              << iBlock->second->bytes << " bytes.\n\t\t  " << (cachedBlocks_.size() - 1)
+              << " available blocks cached (" << freeBytes_.load(std::memory_order_relaxed)
+              << " bytes), " << liveBlocks_.load(std::memory_order_relaxed) << " live blocks ("
+              << liveBytes_.load(std::memory_order_relaxed) << " bytes) outstanding." << std::endl;
           std::cout << out.str() << std::endl;
         }
 
@@ -440,16 +706,22 @@ namespace clue {
 
     // TODO replace with a tbb::concurrent_multimap ?
     using CachedBlocks =
-        std::multimap<unsigned int, BlockDescriptor>;  // ordered by the allocation bin
-    // TODO replace with a tbb::concurrent_map ?
-    using BusyBlocks =
-        std::map<void*, BlockDescriptor>;  // ordered by the address of the allocated memory
+        std::multimap<unsigned int, std::unique_ptr<Block>>;  // ordered by the allocation bin
+
+    inline static std::mutex idsMutex_;
+    inline static std::vector<size_t> freeIds_;  // protected by the lock of the ids
+    inline static size_t nextId_ = 0;            // protected by the lock of the ids
+    inline static std::atomic<size_t> nextSerial_{0};
 
     mutable std::mutex mutex_;
     Device device_;  // the device where the memory is allocated
-    CachedBytes cachedBytes_;
+    std::atomic<size_t> freeBytes_{0};
+    std::atomic<size_t> liveBytes_{0};
+    std::atomic<size_t> requestedBytes_{0};
+    std::atomic<size_t> liveBlocks_{0};  // number of live device allocations currently in use
+    std::atomic<size_t> hits_{0};        // number of allocations served by cached blocks
+    std::atomic<size_t> misses_{0};      // number of allocations of new blocks
     CachedBlocks cachedBlocks_;  // Set of cached device allocations available for reuse
-    BusyBlocks liveBlocks_;      // map of pointers to the live device allocations currently in use
 
     const unsigned int binGrowth_;  // Geometric growth factor for bin-sizes
     const unsigned int minBin_;
@@ -459,6 +731,15 @@ namespace clue {
     const size_t maxBinBytes_;
     const size_t maxCachedBytes_;  // Maximum aggregate cached bytes per device
 
+    // The smallest bins, which take most of the allocations, are served by a magazine of
+    // blocks per thread and by a lock-free list per bin, in front of the cache protected by
+    // the lock, so that the cost of an allocation doesn't grow with the number of threads
+    const unsigned int smallBins_;
+    std::vector<FreeList> freeLists_;  // one per small bin
+    std::vector<std::shared_ptr<Magazine>> magazines_;  // the magazines of all the threads, protected by the lock
+    const size_t id_;
+    const size_t serial_;
+
     const bool reuseSameQueueAllocations_;
     const bool debug_;
   };
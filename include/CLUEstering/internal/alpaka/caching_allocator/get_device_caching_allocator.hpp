@@ -8,6 +8,7 @@
 #include "CLUEstering/internal/alpaka/caching_allocator/allocator_config.hpp"
 #include "CLUEstering/internal/alpaka/caching_allocator/caching_allocator.hpp"
 #include "CLUEstering/internal/alpaka/devices.hpp"
+#include "CLUEstering/utils/allocator_config.hpp"
 
 namespace clue {
 
@@ -22,17 +23,18 @@ namespace clue {
       // allocate the storage for the objects
       auto ptr = std::allocator<Allocator>().allocate(size);
 
-      // construct the objects in the storage
+      // construct the objects in the storage, after which the configuration is fixed
+      const auto config = use_allocator_config();
       for (size_t index = 0; index < size; ++index) {
         new (ptr + index) Allocator(devices[index],
                                     queue,
-                                    config::binGrowth,
-                                    config::minBin,
-                                    config::maxBin,
-                                    config::maxCachedBytes,
-                                    config::maxCachedFraction,
-                                    true,    // reuseSameQueueAllocations
-                                    false);  // debug
+                                    config.binGrowth,
+                                    config.minBin,
+                                    config.maxBin,
+                                    config.maxCachedBytes,
+                                    config.maxCachedFraction,
+                                    true,  // reuseSameQueueAllocations
+                                    config.debug);
       }
 
       // use a custom deleter to destroy all objects and deallocate the memory
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/alpaka/devices.hpp"
+#include "CLUEstering/internal/nostd/numa.hpp"
+#include "CLUEstering/utils/get_queue.hpp"
+#include <cstddef>
+#include <cstring>
+#include <alpaka/alpaka.hpp>
+
+namespace clue::internal {
+
+  // Block size of the first touch, the default one of the kernels of the clustering
+  inline constexpr std::size_t first_touch_block_size = 256;
+
+  struct KernelZeroColumns {
+    template <typename TAcc, typename T>
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  T* data,
+                                  std::size_t n_elements,
+                                  std::size_t n_columns) const {
+      for (auto [i] : alpaka::onAcc::makeIdxMap(
+               acc, alpaka::onAcc::worker::threadsInGrid, alpaka::IdxRange{n_elements})) {
+        for (auto column = 0u; column < n_columns; ++column) {
+          data[column * n_elements + i] = T{};
+        }
+      }
+    }
+  };
+
+  /// @brief Zero the columns of a structure of arrays in host memory, touching them first
+  /// from the threads of the host backend which will process them
+  ///
+  /// The columns are zeroed by a kernel enqueued on the queue, with the same work division
+  /// as the kernels of the clustering, so that with the first-touch policy of the operating
+  /// system the pages of each range of elements are placed on the NUMA node of the worker of
+  /// the backend which processes it, instead of all on the node of the thread which allocated
+  /// the memory. Small structures are zeroed by the calling thread.
+  ///
+  /// @param queue The queue of a host device
+  /// @param data The beginning of the first column, with the columns stored contiguously
+  /// @param n_elements The number of elements in each column
+  /// @param n_columns The number of columns
+  template <typename T, concepts::Queue TQueue>
+    requires concepts::HostApi<DevType<TQueue>>
+  inline void first_touch_columns(TQueue& queue,
+                                  T* data,
+                                  std::size_t n_elements,
+                                  std::size_t n_columns) {
+    if (n_elements * n_columns * sizeof(T) < nostd::numa_min_bytes) {
+      std::memset(data, 0, n_elements * n_columns * sizeof(T));
+      return;
+    }
+    const auto grid_size = alpaka::divCeil(n_elements, first_touch_block_size);
+    queue.enqueue(DevicePool::exec(),
+                  alpaka::onHost::FrameSpec{grid_size, first_touch_block_size},
+                  KernelZeroColumns{},
+                  data,
+                  n_elements,
+                  n_columns);
+    alpaka::onHost::wait(queue);
+  }
+
+  /// @brief Zero the columns of a structure of arrays in host memory which is not bound to
+  /// a device
+  ///
+  /// With a host backend the columns are touched first by its workers, as with
+  /// first_touch_columns. With the other backends the host memory is only processed by the
+  /// calling thread, which zeroes it.
+  ///
+  /// @param data The beginning of the first column, with the columns stored contiguously
+  /// @param n_elements The number of elements in each column
+  /// @param n_columns The number of columns
+  template <typename T>
+  inline void first_touch_host_columns(T* data, std::size_t n_elements, std::size_t n_columns) {
+    if constexpr (concepts::HostApi<Device>) {
+      first_touch_columns(get_queue(DevicePool::deviceAt(0u)), data, n_elements, n_columns);
+    } else {
+      std::memset(data, 0, n_elements * n_columns * sizeof(T));
+    }
+  }
+
+}  // namespace clue::internal
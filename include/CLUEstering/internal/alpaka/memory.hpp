@@ -53,7 +53,9 @@ namespace clue {
 
   template <typename T>
   auto make_host_buffer(alpaka::concepts::VectorOrScalar auto const extent) {
-    return alpaka::onHost::allocHost<T>(extent);
+    auto buffer = alpaka::onHost::allocHost<T>(extent);
+    detail::place_host_memory(buffer.data(), getVec(extent).product() * sizeof(T));
+    return buffer;
   }
   template <typename T>
   auto make_host_buffer() {
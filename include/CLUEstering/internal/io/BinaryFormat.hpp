@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CLUEstering/internal/io/MappedFile.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clue::internal::binary {
+
+  // Layout of the binary point files:
+  // - a fixed-size header, containing the number of dimensions, points and columns;
+  // - a table with a descriptor for each column, containing what the column stores,
+  //   its data type and the offset of its first byte from the beginning of the file;
+  // - the columns, each one stored contiguously and aligned to `column_alignment` bytes.
+  // The coordinates are stored in as many Coordinate columns as the dimensions, in order.
+  // All the values are stored with the native byte order.
+
+  inline constexpr char magic[8] = {'C', 'L', 'U', 'E', 'P', 'T', 'S', '\0'};
+  inline constexpr uint32_t version = 1;
+  inline constexpr std::size_t column_alignment = 64;
+
+  enum class ColumnKind : uint32_t {
+    Coordinate = 0,
+    Weight = 1,
+    ClusterIndex = 2,
+    Rho = 3,
+    Delta = 4,
+    IsSeed = 5
+  };
+
+  enum class DType : uint32_t { Float32 = 0, Int32 = 1 };
+
+  enum Flags : uint32_t { Clustered = 1u << 0 };
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t ndim;
+    uint64_t n_points;
+    uint32_t n_columns;
+    uint32_t flags;
+  };
+  static_assert(sizeof(Header) == 32);
+
+  struct ColumnDescriptor {
+    ColumnKind kind;
+    DType dtype;
+    uint64_t offset;
+  };
+  static_assert(sizeof(ColumnDescriptor) == 16);
+
+  inline constexpr std::size_t align(std::size_t offset) {
+    return (offset + column_alignment - 1) / column_alignment * column_alignment;
+  }
+
+  inline constexpr std::size_t dtype_size(DType) { return 4; }
+
+  // Compute the offsets of a list of columns, placed one after the other after the header
+  inline std::vector<ColumnDescriptor> layout(
+      std::span<const std::pair<ColumnKind, DType>> columns, std::size_t n_points) {
+    std::vector<ColumnDescriptor> descriptors;
+    descriptors.reserve(columns.size());
+    auto offset = align(sizeof(Header) + columns.size() * sizeof(ColumnDescriptor));
+    for (const auto& [kind, dtype] : columns) {
+      descriptors.push_back({kind, dtype, offset});
+      offset = align(offset + n_points * dtype_size(dtype));
+    }
+    return descriptors;
+  }
+
+  // Validated content of a mapped binary point file
+  struct Content {
+    Header header;
+    std::vector<ColumnDescriptor> columns;
+
+    // Find the n-th column of a given kind
+    std::optional<ColumnDescriptor> find(ColumnKind kind, std::size_t n = 0) const {
+      for (const auto& column : columns) {
+        if (column.kind == kind && n-- == 0) {
+          return column;
+        }
+      }
+      return std::nullopt;
+    }
+  };
+
+  inline Content parse(const MappedFile& file, const std::string& file_path) {
+    const auto bytes = file.bytes();
+    Content content;
+    if (bytes.size() < sizeof(Header)) {
+      throw std::runtime_error("The file " + file_path + " is too small to be a CLUEstering binary file");
+    }
+    std::memcpy(&content.header, bytes.data(), sizeof(Header));
+    if (!std::equal(std::begin(magic), std::end(magic), content.header.magic)) {
+      throw std::runtime_error("The file " + file_path + " is not a CLUEstering binary file");
+    }
+    if (content.header.version != version) {
+      throw std::runtime_error("The file " + file_path + " has the unsupported format version " +
+                               std::to_string(content.header.version));
+    }
+
+    const auto table_size = content.header.n_columns * sizeof(ColumnDescriptor);
+    if (bytes.size() < sizeof(Header) + table_size) {
+      throw std::runtime_error("The file " + file_path + " is truncated");
+    }
+    content.columns.resize(content.header.n_columns);
+    std::memcpy(content.columns.data(), bytes.data() + sizeof(Header), table_size);
+    // the extent of each column is checked against the size of the file without computing its
+    // end, which could overflow for a corrupted header
+    const auto file_size = static_cast<uint64_t>(bytes.size());
+    for (const auto& column : content.columns) {
+      if (column.dtype != DType::Float32 && column.dtype != DType::Int32) {
+        throw std::runtime_error("The file " + file_path + " has a column of unknown type");
+      }
+      if (column.offset % alignof(float) != 0 || column.offset > file_size ||
+          content.header.n_points > (file_size - column.offset) / dtype_size(column.dtype)) {
+        throw std::runtime_error("The file " + file_path + " is truncated or corrupted");
+      }
+    }
+    return content;
+  }
+
+}  // namespace clue::internal::binary
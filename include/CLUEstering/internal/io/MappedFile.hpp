@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CLUE_HAS_MMAP 1
+#endif
+
+namespace clue::internal {
+
+  /// @brief Read-only or copy-on-write view of the content of a file
+  ///
+  /// On POSIX systems the file is memory-mapped, so that its content is paged in on
+  /// demand and shared with the page cache, otherwise it is read into memory.
+  class MappedFile {
+  public:
+    enum class Access {
+      ReadOnly,
+      // the content can be modified in memory, without the changes reaching the file
+      CopyOnWrite
+    };
+
+  private:
+    std::byte* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::vector<std::byte> m_fallback;
+
+  public:
+    /// @brief Map the content of a file in memory
+    ///
+    /// @param file_path The path of the file to map
+    /// @param access Whether the mapped content can be modified in memory
+    explicit MappedFile(const std::string& file_path, Access access = Access::ReadOnly) {
+#ifdef CLUE_HAS_MMAP
+      const auto fd = ::open(file_path.c_str(), O_RDONLY);
+      if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + file_path);
+      }
+      struct stat file_stats;
+      if (::fstat(fd, &file_stats) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not read the size of file: " + file_path);
+      }
+      m_size = static_cast<std::size_t>(file_stats.st_size);
+      if (m_size > 0) {
+        const auto protection =
+            access == Access::ReadOnly ? PROT_READ : (PROT_READ | PROT_WRITE);
+        auto* address = ::mmap(nullptr, m_size, protection, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+          ::close(fd);
+          throw std::runtime_error("Could not map file: " + file_path);
+        }
+        // the whole content is going to be read, so start paging it in right away
+        ::madvise(address, m_size, MADV_WILLNEED);
+        m_data = static_cast<std::byte*>(address);
+      }
+      ::close(fd);
+#else
+      (void)access;
+      std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+      if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + file_path);
+      }
+      m_size = static_cast<std::size_t>(file.tellg());
+      m_fallback.resize(m_size);
+      file.seekg(0);
+      file.read(reinterpret_cast<char*>(m_fallback.data()), m_size);
+      m_data = m_fallback.data();
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept
+        : m_data{std::exchange(other.m_data, nullptr)},
+          m_size{std::exchange(other.m_size, 0)},
+          m_fallback{std::move(other.m_fallback)} {}
+    MappedFile& operator=(MappedFile&& other) noexcept {
+      if (this != &other) {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_fallback = std::move(other.m_fallback);
+      }
+      return *this;
+    }
+    ~MappedFile() { unmap(); }
+
+    /// @brief Returns the size of the file in bytes
+    std::size_t size() const { return m_size; }
+
+    /// @brief Returns the content of the file as bytes
+    std::span<const std::byte> bytes() const { return {m_data, m_size}; }
+    /// @brief Returns the content of the file as modifiable bytes
+    /// @note The content can only be modified if the file is mapped as copy-on-write
+    std::span<std::byte> bytes() { return {m_data, m_size}; }
+    /// @brief Returns the content of the file as text
+    std::string_view text() const { return {reinterpret_cast<const char*>(m_data), m_size}; }
+
+  private:
+    void unmap() {
+#ifdef CLUE_HAS_MMAP
+      if (m_data != nullptr) {
+        ::munmap(m_data, m_size);
+      }
+#endif
+      m_data = nullptr;
+      m_size = 0;
+    }
+  };
+
+}  // namespace clue::internal
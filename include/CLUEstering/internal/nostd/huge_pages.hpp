@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#if defined(MADV_HUGEPAGE)
+#define CLUE_HAS_MADV_HUGEPAGE 1
+#endif
+#endif
+
+namespace clue::nostd {
+
+  // Size of the huge pages of the x86-64 and aarch64 systems with 4 kB base pages
+  inline constexpr std::size_t huge_page_bytes = std::size_t{1} << 21;  // 2 MB
+
+  // Range of the huge pages fully contained in a range of memory,
+  // which is empty when it doesn't contain a whole huge page
+  struct PageRange {
+    std::uintptr_t begin;
+    std::uintptr_t end;
+
+    constexpr bool empty() const { return end <= begin; }
+  };
+
+  inline constexpr PageRange huge_page_range(std::uintptr_t address, std::size_t bytes) {
+    const auto begin = (address + huge_page_bytes - 1) / huge_page_bytes * huge_page_bytes;
+    const auto end = (address + bytes) / huge_page_bytes * huge_page_bytes;
+    return PageRange{begin, end > begin ? end : begin};
+  }
+
+  /// @brief Ask the operating system to back a range of memory with transparent huge pages
+  ///
+  /// Only the huge pages fully contained in the range are affected, and the advice has to be
+  /// given before the pages are first touched. Where transparent huge pages are not
+  /// available, or are disabled, the memory keeps using the base pages.
+  ///
+  /// @param data The beginning of the range
+  /// @param bytes The size of the range
+  /// @return Whether the advice has been accepted
+  inline bool advise_huge_pages(void* data, std::size_t bytes) {
+#ifdef CLUE_HAS_MADV_HUGEPAGE
+    const auto range = huge_page_range(reinterpret_cast<std::uintptr_t>(data), bytes);
+    if (range.empty()) {
+      return false;
+    }
+    return ::madvise(
+               reinterpret_cast<void*>(range.begin), range.end - range.begin, MADV_HUGEPAGE) == 0;
+#else
+    (void)data;
+    (void)bytes;
+    return false;
+#endif
+  }
+
+}  // namespace clue::nostd
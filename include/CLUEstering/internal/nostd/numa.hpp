@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__) && __has_include(<sys/syscall.h>) && __has_include(<unistd.h>)
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_mbind)
+#define CLUE_HAS_MBIND 1
+#endif
+#endif
+
+namespace clue::nostd {
+
+  // Minimum size of the host memory which is placed on the NUMA nodes or touched from
+  // several threads, below which the cost of the threads exceeds the gain
+  inline constexpr std::size_t numa_min_bytes = std::size_t{1} << 22;  // 4 MB
+
+  /// @brief Spread the pages of a range of memory round-robin over all the NUMA nodes
+  ///
+  /// The placement applies to the pages which have not been touched yet, so it has to be
+  /// requested right after the allocation. Only the pages fully contained in the range are
+  /// affected. On systems without NUMA support the call has no effect.
+  ///
+  /// @param data The beginning of the range
+  /// @param bytes The size of the range
+  /// @return Whether the placement has been applied
+  inline bool interleave_pages(void* data, std::size_t bytes) {
+#ifdef CLUE_HAS_MBIND
+    const auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const auto address = reinterpret_cast<std::uintptr_t>(data);
+    const auto begin = (address + page - 1) / page * page;
+    const auto end = (address + bytes) / page * page;
+    if (end <= begin) {
+      return false;
+    }
+    // MPOL_INTERLEAVE, with all the nodes in the mask; the kernel restricts it to the nodes
+    // with memory which the process is allowed to use
+    constexpr unsigned long mpol_interleave = 3;
+    std::array<unsigned long, 16> nodes;
+    nodes.fill(~0ul);
+    return ::syscall(SYS_mbind,
+                     begin,
+                     end - begin,
+                     mpol_interleave,
+                     nodes.data(),
+                     nodes.size() * 8 * sizeof(unsigned long),
+                     0u) == 0;
+#else
+    (void)data;
+    (void)bytes;
+    return false;
+#endif
+  }
+
+}  // namespace clue::nostd
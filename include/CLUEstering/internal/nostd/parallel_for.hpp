@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace clue::nostd {
+
+  /// @brief Number of host threads to use for a parallel task over a given number of elements
+  ///
+  /// @param size The number of elements to process
+  /// @param grain The minimum number of elements assigned to each thread
+  /// @return A number of threads between one and the hardware concurrency
+  inline std::size_t host_concurrency(std::size_t size, std::size_t grain = 1) {
+    const auto hardware = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    return std::clamp<std::size_t>(size / std::max<std::size_t>(grain, 1), 1, hardware);
+  }
+
+  /// @brief Run a set of tasks concurrently on host threads
+  ///
+  /// The first task runs on the calling thread, every other task on its own thread.
+  /// The call returns once all the tasks are completed, and rethrows the first exception
+  /// thrown by any of them.
+  ///
+  /// @param n_tasks The number of tasks to run
+  /// @param func The function to call, with the index of the task as argument
+  template <typename TFunc>
+  inline void parallel_for(std::size_t n_tasks, TFunc&& func) {
+    if (n_tasks == 0) {
+      return;
+    }
+    std::vector<std::exception_ptr> errors(n_tasks);
+    auto guarded = [&](std::size_t task) {
+      try {
+        func(task);
+      } catch (...) {
+        errors[task] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(n_tasks - 1);
+    for (std::size_t task = 1; task < n_tasks; ++task) {
+      threads.emplace_back(guarded, task);
+    }
+    guarded(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  /// @brief Split a range in contiguous blocks and process them concurrently on host threads
+  ///
+  /// @param size The number of elements in the range
+  /// @param func The function to call for each block, with the index of the block and
+  /// the first and past-the-end indexes of the elements in the block as arguments
+  /// @param grain The minimum number of elements in each block
+  template <typename TFunc>
+  inline void parallel_for_blocks(std::size_t size, TFunc&& func, std::size_t grain = 1) {
+    const auto n_blocks = host_concurrency(size, grain);
+    const auto block_size = (size + n_blocks - 1) / n_blocks;
+    parallel_for(n_blocks, [&](std::size_t block) {
+      const auto begin = std::min(block * block_size, size);
+      const auto end = std::min(begin + block_size, size);
+      func(block, begin, end);
+    });
+  }
+
+}  // namespace clue::nostd
@@ -0,0 +1,208 @@
+/// @file allocator_config.hpp
+/// @brief Provides the runtime configuration of the caching allocator and the statistics it collects
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/internal/alpaka/caching_allocator/allocator_config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace clue {
+
+  /// @brief Configuration of the caching allocators
+  ///
+  /// The allocations are rounded up to bins whose sizes grow geometrically, from
+  /// binGrowth^minBin to binGrowth^maxBin bytes, and the freed blocks are cached for reuse
+  /// up to the smallest of the two limits on the cached memory.
+  /// The default values can be overridden through the environment variables
+  /// CLUE_ALLOCATOR_BIN_GROWTH, CLUE_ALLOCATOR_MIN_BIN, CLUE_ALLOCATOR_MAX_BIN,
+  /// CLUE_ALLOCATOR_MAX_CACHED_BYTES, CLUE_ALLOCATOR_MAX_CACHED_FRACTION,
+  /// CLUE_ALLOCATOR_NUMA_INTERLEAVE, CLUE_ALLOCATOR_HUGE_PAGE_THRESHOLD and
+  /// CLUE_ALLOCATOR_DEBUG, or by calling setAllocatorConfig before the first allocation.
+  struct AllocatorConfig {
+    /// @brief The growth factor of the sizes of the bins
+    unsigned int binGrowth = config::binGrowth;
+    /// @brief The smallest bin. Smaller allocations are rounded up to its size
+    unsigned int minBin = config::minBin;
+    /// @brief The largest bin. Larger allocations fail
+    unsigned int maxBin = config::maxBin;
+    /// @brief The maximum amount of cached memory on each device, where 0 means no limit
+    std::size_t maxCachedBytes = config::maxCachedBytes;
+    /// @brief The maximum fraction of the memory of each device which is cached,
+    /// where 0 means no limit
+    double maxCachedFraction = config::maxCachedFraction;
+    /// @brief Whether to spread the pages of the large host buffers over all the NUMA nodes.
+    /// By default the pages are placed on the node of the thread which first touches them,
+    /// and the columns of the points are first touched by the threads processing them
+    bool numaInterleave = false;
+    /// @brief The minimum size of the host buffers backed by 2 MB transparent huge pages,
+    /// which reduce the TLB misses of the random accesses to large buffers. Where huge pages
+    /// are not available the buffers use the base pages. 0 means never use huge pages
+    std::size_t hugePageThreshold = 0;
+    /// @brief Whether to print each operation of the allocators
+    bool debug = false;
+  };
+
+  /// @brief Statistics of the caching allocator of a device
+  struct AllocatorStats {
+    /// @brief The number of allocations served by cached blocks
+    std::size_t hits = 0;
+    /// @brief The number of allocations which required a new block
+    std::size_t misses = 0;
+    /// @brief The number of blocks currently in use
+    std::size_t liveBlocks = 0;
+    /// @brief The bytes of the blocks currently in use
+    std::size_t liveBytes = 0;
+    /// @brief The bytes of the free blocks kept in the cache
+    std::size_t cachedBytes = 0;
+    /// @brief The bytes requested by the allocations currently in use
+    std::size_t requestedBytes = 0;
+
+    /// @brief Returns the fraction of the memory in use which is lost to the rounding of
+    /// the allocations to the sizes of the bins
+    double fragmentation() const {
+      return liveBytes == 0 ? 0. : 1. - static_cast<double>(requestedBytes) / liveBytes;
+    }
+    /// @brief Returns the fraction of the allocations served by cached blocks
+    double hitRate() const {
+      const auto allocations = hits + misses;
+      return allocations == 0 ? 0. : static_cast<double>(hits) / allocations;
+    }
+  };
+
+  namespace detail {
+
+    struct AllocatorConfigState {
+      std::mutex mutex;
+      std::optional<AllocatorConfig> config;
+      // set once the first allocator has been constructed with the configuration
+      bool used = false;
+    };
+
+    inline AllocatorConfigState& allocator_config_state() {
+      static AllocatorConfigState state;
+      return state;
+    }
+
+    template <typename T>
+    inline void read_allocator_env(const char* name, T& value) {
+      const char* env = std::getenv(name);
+      if (env == nullptr || *env == '\0') {
+        return;
+      }
+      try {
+        std::size_t end = 0;
+        if constexpr (std::is_floating_point_v<T>) {
+          value = static_cast<T>(std::stod(env, &end));
+        } else {
+          const auto parsed = std::stoull(env, &end);
+          if (parsed > std::numeric_limits<T>::max()) {
+            throw std::out_of_range(name);
+          }
+          value = static_cast<T>(parsed);
+        }
+        if (env[end] != '\0') {
+          throw std::invalid_argument(name);
+        }
+      } catch (const std::logic_error&) {
+        throw std::invalid_argument(std::string("Invalid value of the environment variable ") +
+                                    name + ": " + env);
+      }
+    }
+
+    inline void validate_allocator_config(const AllocatorConfig& config) {
+      if (config.binGrowth < 2) {
+        throw std::invalid_argument("The bin growth of the caching allocator must be at least 2.");
+      }
+      if (config.minBin > config.maxBin) {
+        throw std::invalid_argument(
+            "The smallest bin of the caching allocator must not be larger than the largest bin.");
+      }
+      // the extents of the buffers are 32 bits integers
+      std::size_t bytes = 1;
+      for (auto bin = 0u; bin < config.maxBin; ++bin) {
+        bytes *= config.binGrowth;
+        if (bytes > std::numeric_limits<uint32_t>::max()) {
+          throw std::invalid_argument(
+              "The largest bin of the caching allocator must not exceed 4 GB.");
+        }
+      }
+      if (!(config.maxCachedFraction >= 0. && config.maxCachedFraction <= 1.)) {
+        throw std::invalid_argument(
+            "The fraction of cached memory of the caching allocator must be between 0 and 1.");
+      }
+    }
+
+    inline AllocatorConfig allocator_config_from_env() {
+      AllocatorConfig config;
+      read_allocator_env("CLUE_ALLOCATOR_BIN_GROWTH", config.binGrowth);
+      read_allocator_env("CLUE_ALLOCATOR_MIN_BIN", config.minBin);
+      read_allocator_env("CLUE_ALLOCATOR_MAX_BIN", config.maxBin);
+      read_allocator_env("CLUE_ALLOCATOR_MAX_CACHED_BYTES", config.maxCachedBytes);
+      read_allocator_env("CLUE_ALLOCATOR_MAX_CACHED_FRACTION", config.maxCachedFraction);
+      read_allocator_env("CLUE_ALLOCATOR_NUMA_INTERLEAVE", config.numaInterleave);
+      read_allocator_env("CLUE_ALLOCATOR_HUGE_PAGE_THRESHOLD", config.hugePageThreshold);
+      read_allocator_env("CLUE_ALLOCATOR_DEBUG", config.debug);
+      validate_allocator_config(config);
+      return config;
+    }
+
+    // Return the configuration for the construction of an allocator, after which it
+    // can no longer be changed
+    inline AllocatorConfig use_allocator_config() {
+      auto& state = allocator_config_state();
+      std::scoped_lock lock(state.mutex);
+      if (!state.config.has_value()) {
+        state.config = allocator_config_from_env();
+      }
+      state.used = true;
+      return *state.config;
+    }
+
+  }  // namespace detail
+
+  /// @brief Set the configuration of the caching allocators
+  ///
+  /// The configuration overrides the environment variables, and must be set before the
+  /// first allocation, because the allocators are constructed with it on first use and the
+  /// large host buffers are placed in memory according to it.
+  ///
+  /// @param config The configuration of the allocators
+  /// @throws std::invalid_argument if the configuration is not valid
+  /// @throws std::logic_error if an allocator has already been constructed
+  inline void setAllocatorConfig(const AllocatorConfig& config) {
+    detail::validate_allocator_config(config);
+    auto& state = detail::allocator_config_state();
+    std::scoped_lock lock(state.mutex);
+    if (state.used) {
+      throw std::logic_error(
+          "The configuration of the caching allocator must be set before the first allocation.");
+    }
+    state.config = config;
+  }
+
+  /// @brief Get the configuration of the caching allocators
+  ///
+  /// Reading the configuration doesn't fix it, so it can be modified and passed to
+  /// setAllocatorConfig until the first allocation.
+  ///
+  /// @return The configuration set with setAllocatorConfig, or otherwise the default one
+  /// overridden by the environment variables
+  inline AllocatorConfig getAllocatorConfig() {
+    auto& state = detail::allocator_config_state();
+    std::scoped_lock lock(state.mutex);
+    if (!state.config.has_value()) {
+      state.config = detail::allocator_config_from_env();
+    }
+    return *state.config;
+  }
+
+}  // namespace clue
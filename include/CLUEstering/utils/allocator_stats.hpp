@@ -0,0 +1,36 @@
+/// @file allocator_stats.hpp
+/// @brief Provides the statistics of the caching allocators of the devices
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/alpaka/caching_allocator/allocator_policy.hpp"
+#include "CLUEstering/internal/alpaka/caching_allocator/get_device_caching_allocator.hpp"
+#include "CLUEstering/utils/allocator_config.hpp"
+#include <alpaka/alpaka.hpp>
+
+namespace clue {
+
+  /// @brief Get the statistics of the caching allocator of the device of a queue
+  ///
+  /// The device buffers allocated with queues of the same type as the given one share the
+  /// same allocator. The statistics are empty for the devices which don't use the caching
+  /// allocator, like the host.
+  ///
+  /// @tparam TQueue The type of the queue
+  /// @param queue The queue whose device is queried
+  /// @return The statistics of the allocator of the device
+  template <concepts::Queue TQueue>
+  inline AllocatorStats allocatorStats(TQueue& queue) {
+    using TDev = DevType<TQueue>;
+    if constexpr (concepts::NonHostApi<TDev> &&
+                  allocator_policy<TDev> == AllocatorPolicy::Caching) {
+      auto device = queue.getDevice();
+      return getDeviceCachingAllocator(device, queue).stats();
+    } else {
+      return AllocatorStats{};
+    }
+  }
+
+}  // namespace clue
@@ -0,0 +1,47 @@
+/// @file binary_file.hpp
+/// @brief Provides functions to read and write points in the CLUEstering binary format
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/detail/Dim.hpp"
+#include "CLUEstering/utils/write_output.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace clue {
+
+  /// @brief Read points from a binary file into a PointsHost object
+  ///
+  /// The binary format is columnar, with each coordinate, the weights and, optionally,
+  /// the cluster indexes stored contiguously. The file is memory-mapped and used directly
+  /// as the storage of the points, so no parsing or copy is needed.
+  ///
+  /// @tparam NDim The number of dimensions of the points
+  /// @param dim The dimension of the points
+  /// @param file_path The path to the binary file to read
+  /// @return A PointsHost object backed by the content of the file
+  template <std::size_t NDim>
+  inline PointsHost<NDim> read_binary(Dim<NDim> dim, const std::string& file_path);
+
+  /// @brief Write points to a binary file
+  ///
+  /// The coordinates and the weights are always written, while the cluster indexes
+  /// are written only if the points have been clustered.
+  /// Each column is written to the file with a single sequential write.
+  ///
+  /// @tparam NDim The number of dimensions of the points
+  /// @param points The points to write
+  /// @param file_path The path to the binary file to write
+  /// @param columns The optional columns to write
+  /// @throw std::invalid_argument if the size of the optional columns doesn't match the number of points
+  template <std::size_t NDim>
+  inline void write_binary(const PointsHost<NDim>& points,
+                           const std::string& file_path,
+                           const OutputColumns& columns = {});
+
+}  // namespace clue
+
+#include "CLUEstering/utils/detail/binary_file.hpp"
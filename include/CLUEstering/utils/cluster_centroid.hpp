@@ -24,11 +24,14 @@ namespace clue {
   /// @param points The PointsHost object containing the points
   /// @param cluster_id The ID of the cluster for which to compute the centroid
   /// @return The centroid of the specified cluster as an array of floats
+  /// @throws std::out_of_range if the cluster contains no points
   template <std::size_t Ndim>
   inline Centroid<Ndim> cluster_centroid(const PointsHost<Ndim>& points, std::size_t cluster_id);
 
   /// @brief Compute the centroids of all clusters from the given Points
   ///
+  /// The coordinates of all the points are accumulated in a single pass.
+  ///
   /// @tparam Ndim The number of dimensions of the points
   /// @param points The PointsHost object containing the points
   /// @return A vector of centroids, one for each cluster
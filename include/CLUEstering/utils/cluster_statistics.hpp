@@ -0,0 +1,72 @@
+/// @file cluster_statistics.hpp
+/// @brief Provides functions for computing the size, weight, centroid, extent and second moments of clusters.
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/data_structures/AssociationMap.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/detail/concepts.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace clue {
+
+  /// @brief Summary of the points of a cluster
+  ///
+  /// @tparam Ndim The number of dimensions of the points
+  template <std::size_t Ndim>
+  struct ClusterStatistics {
+    /// @brief The number of points in the cluster
+    int32_t size = 0;
+    /// @brief The sum of the weights of the points
+    float weight = 0.f;
+    /// @brief The weighted centroid of the points
+    std::array<float, Ndim> centroid{};
+    /// @brief The minimum coordinates of the points
+    std::array<float, Ndim> min{};
+    /// @brief The maximum coordinates of the points
+    std::array<float, Ndim> max{};
+    /// @brief The weighted covariance of the coordinates, stored in row-major order
+    std::array<float, Ndim * Ndim> covariance{};
+
+    /// @brief Returns the weighted covariance of two coordinates
+    ALPAKA_FN_HOST_ACC constexpr float cov(std::size_t i, std::size_t j) const {
+      return covariance[i * Ndim + j];
+    }
+  };
+
+  /// @brief Compute the statistics of all the clusters from the given host points
+  ///
+  /// The statistics are accumulated in a single pass over the points.
+  ///
+  /// @tparam Ndim The number of dimensions of the points
+  /// @param points The clustered host points
+  /// @return A vector containing the statistics of each cluster
+  template <std::size_t Ndim>
+  inline std::vector<ClusterStatistics<Ndim>> cluster_statistics(const PointsHost<Ndim>& points);
+
+  /// @brief Compute the statistics of all the clusters from the given device points
+  ///
+  /// The statistics of each cluster are reduced on the device from the points associated to it,
+  /// so the points are not copied back to the host. The computation is only enqueued, without
+  /// waiting for it to complete.
+  ///
+  /// @tparam TQueue The type of the queue
+  /// @tparam Ndim The number of dimensions of the points
+  /// @param queue The queue to enqueue the computation on
+  /// @param points The clustered device points
+  /// @param clusters The device associator mapping the clusters to their points,
+  /// as returned by Clusterer::getClusters
+  /// @return A device buffer containing the statistics of each cluster
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline auto cluster_statistics(TQueue& queue,
+                                 const PointsDevice<DevType<TQueue>, Ndim>& points,
+                                 const DevAssociationMap<DevType<TQueue>>& clusters);
+
+}  // namespace clue
+
+#include "CLUEstering/utils/detail/cluster_statistics.hpp"
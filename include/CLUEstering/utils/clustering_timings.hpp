@@ -0,0 +1,66 @@
+/// @file clustering_timings.hpp
+/// @brief Provides the timings of the stages of the clustering, measured by the Clusterer
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace clue {
+
+  /// @brief Time spent in each stage of the clustering
+  ///
+  /// The timings are only measured when the library is compiled with CLUE_ENABLE_TIMING,
+  /// and are otherwise zero. The timings of several clusterings can be summed, in which case
+  /// the number of clusterings is summed as well.
+  struct ClusteringTimings {
+    using duration = std::chrono::steady_clock::duration;
+
+    /// @brief The setup of the tiles, or the construction of the k-d tree
+    duration setupTiles{};
+    /// @brief The copy of the points from the host to the device
+    duration copyToDevice{};
+    /// @brief The filling of the tiles with the points
+    duration fillTiles{};
+    /// @brief The computation of the local densities
+    duration localDensity{};
+    /// @brief The search of the nearest highers
+    duration nearestHighers{};
+    /// @brief The search of the seeds
+    duration seeds{};
+    /// @brief The setup and the filling of the followers
+    duration followers{};
+    /// @brief The assignment of the points to the clusters
+    duration assignment{};
+    /// @brief The copy of the results from the device to the host
+    duration copyToHost{};
+    /// @brief The number of clusterings whose timings are summed
+    std::size_t clusterings = 0;
+
+    /// @brief Returns the time spent in all the stages
+    duration total() const {
+      return setupTiles + copyToDevice + fillTiles + localDensity + nearestHighers + seeds +
+             followers + assignment + copyToHost;
+    }
+
+    /// @brief Add the timings of other clusterings
+    ClusteringTimings& operator+=(const ClusteringTimings& other) {
+      setupTiles += other.setupTiles;
+      copyToDevice += other.copyToDevice;
+      fillTiles += other.fillTiles;
+      localDensity += other.localDensity;
+      nearestHighers += other.nearestHighers;
+      seeds += other.seeds;
+      followers += other.followers;
+      assignment += other.assignment;
+      copyToHost += other.copyToHost;
+      clusterings += other.clusterings;
+      return *this;
+    }
+    friend ClusteringTimings operator+(ClusteringTimings lhs, const ClusteringTimings& rhs) {
+      return lhs += rhs;
+    }
+  };
+
+}  // namespace clue
@@ -0,0 +1,123 @@
+
+#pragma once
+
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/internal/io/BinaryFormat.hpp"
+#include "CLUEstering/utils/binary_file.hpp"
+#include "CLUEstering/utils/write_output.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clue {
+
+  namespace detail {
+
+    struct BinaryColumn {
+      internal::binary::ColumnKind kind;
+      internal::binary::DType dtype;
+      std::span<const std::byte> data;
+    };
+
+    // Write the header, the column table and the columns of a binary file.
+    // Each column is written with a single call, followed by the padding to the next column.
+    inline void write_binary_columns(const std::string& file_path,
+                                     uint32_t ndim,
+                                     uint64_t n_points,
+                                     uint32_t flags,
+                                     std::span<const BinaryColumn> columns) {
+      using namespace internal::binary;
+      std::vector<std::pair<ColumnKind, DType>> kinds;
+      for (const auto& column : columns) {
+        kinds.emplace_back(column.kind, column.dtype);
+      }
+      const auto descriptors = layout(kinds, n_points);
+
+      Header header{};
+      std::copy(std::begin(magic), std::end(magic), header.magic);
+      header.version = version;
+      header.ndim = ndim;
+      header.n_points = n_points;
+      header.n_columns = static_cast<uint32_t>(columns.size());
+      header.flags = flags;
+
+      std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+      if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + file_path);
+      }
+      const std::array<char, column_alignment> padding{};
+      auto position = sizeof(Header) + descriptors.size() * sizeof(ColumnDescriptor);
+      file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+      file.write(reinterpret_cast<const char*>(descriptors.data()),
+                 descriptors.size() * sizeof(ColumnDescriptor));
+      for (auto i = 0u; i < columns.size(); ++i) {
+        file.write(padding.data(), descriptors[i].offset - position);
+        file.write(reinterpret_cast<const char*>(columns[i].data.data()), columns[i].data.size());
+        position = descriptors[i].offset + columns[i].data.size();
+      }
+      file.write(padding.data(), align(position) - position);
+      if (!file) {
+        throw std::runtime_error("Could not write file: " + file_path);
+      }
+    }
+
+  }  // namespace detail
+
+  template <std::size_t NDim>
+  inline PointsHost<NDim> read_binary(Dim<NDim> dim, const std::string& file_path) {
+    return PointsHost<NDim>(dim, std::filesystem::path{file_path});
+  }
+
+  template <std::size_t NDim>
+  inline void write_binary(const PointsHost<NDim>& points,
+                           const std::string& file_path,
+                           const OutputColumns& columns) {
+    using namespace internal::binary;
+    const auto n_points = static_cast<std::size_t>(points.size());
+    detail::check_output_column(columns.rho.size(), n_points);
+    detail::check_output_column(columns.delta.size(), n_points);
+    detail::check_seed_column(columns.is_seed.size(), n_points);
+
+    std::vector<detail::BinaryColumn> binary_columns;
+    for (auto dim = 0u; dim < NDim; ++dim) {
+      binary_columns.push_back(
+          {ColumnKind::Coordinate, DType::Float32, std::as_bytes(points.coords(dim))});
+    }
+    binary_columns.push_back({ColumnKind::Weight, DType::Float32, std::as_bytes(points.weights())});
+    if (points.clustered()) {
+      binary_columns.push_back(
+          {ColumnKind::ClusterIndex, DType::Int32, std::as_bytes(points.clusterIndexes())});
+    }
+    if (!columns.rho.empty()) {
+      binary_columns.push_back({ColumnKind::Rho, DType::Float32, std::as_bytes(columns.rho)});
+    }
+    if (!columns.delta.empty()) {
+      binary_columns.push_back({ColumnKind::Delta, DType::Float32, std::as_bytes(columns.delta)});
+    }
+    // the file stores an integer per point, so the bitset of the seeds is expanded
+    std::vector<int32_t> is_seed;
+    if (!columns.is_seed.empty()) {
+      is_seed.resize(n_points);
+      for (auto i = 0u; i < n_points; ++i) {
+        is_seed[i] = (columns.is_seed[i / 32] >> (i % 32)) & 1u;
+      }
+      binary_columns.push_back(
+          {ColumnKind::IsSeed, DType::Int32, std::as_bytes(std::span<const int32_t>(is_seed))});
+    }
+    detail::write_binary_columns(file_path,
+                                 static_cast<uint32_t>(NDim),
+                                 static_cast<uint64_t>(n_points),
+                                 points.clustered() ? Flags::Clustered : 0u,
+                                 binary_columns);
+  }
+
+}  // namespace clue
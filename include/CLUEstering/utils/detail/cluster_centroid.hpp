@@ -2,11 +2,13 @@
 #pragma once
 
 #include "CLUEstering/data_structures/PointsHost.hpp"
-#include "CLUEstering/internal/nostd/zip_iterator.hpp"
 #include "CLUEstering/utils/cluster_centroid.hpp"
-#include "CLUEstering/utils/get_clusters.hpp"
-#include <algorithm>
+#include "CLUEstering/utils/detail/get_cluster_properties.hpp"
 #include <array>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace clue {
@@ -15,22 +17,24 @@ namespace clue {
   inline Centroid<Ndim> cluster_centroid(const PointsHost<Ndim>& points, std::size_t cluster_id) {
     assert(points.clustered());
     auto cluster_ids = points.clusterIndexes();
-    auto clusters = get_clusters(points);
-    // TODO: add error handling
-    Centroid<Ndim> centroid;
-    auto size = clusters.count(cluster_id);
-    for (auto dim = 0U; dim < Ndim; ++dim) {
-      auto coords = points.coords(dim);
-      std::for_each_n(nostd::zip(coords.begin(), cluster_ids.begin()),
-                      points.size(),
-                      [=, &centroid](auto&& tuple) -> void {
-                        const auto coord = std::get<0>(tuple);
-                        const auto point_cluster = std::get<1>(tuple);
-                        if (static_cast<std::size_t>(point_cluster) == cluster_id) {
-                          centroid[dim] += coord;
-                        }
-                      });
-      centroid[dim] /= static_cast<float>(size);
+    const auto& view = points.view();
+
+    Centroid<Ndim> centroid{};
+    std::size_t size = 0;
+    for (auto i = 0; i < points.size(); ++i) {
+      if (cluster_ids[i] < 0 || static_cast<std::size_t>(cluster_ids[i]) != cluster_id) {
+        continue;
+      }
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        centroid[dim] += view.coords[dim][i];
+      }
+      ++size;
+    }
+    if (size == 0) {
+      throw std::out_of_range("The cluster " + std::to_string(cluster_id) + " contains no points");
+    }
+    for (auto& coord : centroid) {
+      coord /= static_cast<float>(size);
     }
 
     return centroid;
@@ -40,25 +44,26 @@ namespace clue {
   inline Centroids<Ndim> cluster_centroids(const PointsHost<Ndim>& points) {
     assert(points.clustered());
     auto cluster_ids = points.clusterIndexes();
-    auto clusters = get_clusters(points);
-    const auto n_clusters = clusters.size();
+    const auto& view = points.view();
+    const auto n_clusters = static_cast<std::size_t>(detail::compute_nclusters(cluster_ids));
 
+    // accumulate all the coordinates of each point in a single pass
     Centroids<Ndim> centroids(n_clusters);
-    for (auto dim = 0u; dim < Ndim; ++dim) {
-      auto coords = points.coords(dim);
-      std::for_each_n(nostd::zip(coords.begin(), cluster_ids.begin()),
-                      points.size(),
-                      [=, &centroids](auto&& tuple) -> void {
-                        const auto coord = std::get<0>(tuple);
-                        const auto point_cluster = std::get<1>(tuple);
-                        if (point_cluster >= 0)
-                          centroids[point_cluster][dim] += coord;
-                      });
-      std::ranges::for_each(centroids, [&, dim, cl = 0](auto& centroid) mutable {
-        const auto size = clusters.count(cl);
-        centroid[dim] /= static_cast<float>(size);
-        ++cl;
-      });
+    std::vector<std::size_t> sizes(n_clusters, 0);
+    for (auto i = 0; i < points.size(); ++i) {
+      const auto cluster = cluster_ids[i];
+      if (cluster < 0) {
+        continue;
+      }
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        centroids[cluster][dim] += view.coords[dim][i];
+      }
+      ++sizes[cluster];
+    }
+    for (auto cluster = 0u; cluster < n_clusters; ++cluster) {
+      for (auto& coord : centroids[cluster]) {
+        coord /= static_cast<float>(sizes[cluster]);
+      }
     }
 
     return centroids;
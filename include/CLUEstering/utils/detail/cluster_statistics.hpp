@@ -0,0 +1,220 @@
+
+#pragma once
+
+#include "CLUEstering/data_structures/AssociationMap.hpp"
+#include "CLUEstering/data_structures/AssociationMapView.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+#include "CLUEstering/utils/cluster_statistics.hpp"
+#include "CLUEstering/utils/detail/get_cluster_properties.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <alpaka/alpaka.hpp>
+
+namespace clue {
+
+  namespace detail {
+
+    // Add a point to the statistics of a cluster.
+    // The weighted centroid and covariance are updated incrementally (West's algorithm),
+    // which avoids the cancellation of the single-pass sums of squares.
+    template <std::size_t Ndim>
+    ALPAKA_FN_HOST_ACC constexpr void accumulate(ClusterStatistics<Ndim>& statistics,
+                                                 const std::array<float, Ndim>& coords,
+                                                 float weight) {
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        const auto coord = coords[dim];
+        if (statistics.size == 0 || coord < statistics.min[dim]) {
+          statistics.min[dim] = coord;
+        }
+        if (statistics.size == 0 || coord > statistics.max[dim]) {
+          statistics.max[dim] = coord;
+        }
+      }
+      ++statistics.size;
+      if (!(weight > 0.f)) {
+        return;
+      }
+
+      statistics.weight += weight;
+      std::array<float, Ndim> delta;
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        delta[dim] = coords[dim] - statistics.centroid[dim];
+        statistics.centroid[dim] += weight / statistics.weight * delta[dim];
+      }
+      for (auto i = 0u; i < Ndim; ++i) {
+        for (auto j = 0u; j < Ndim; ++j) {
+          statistics.covariance[i * Ndim + j] +=
+              weight * delta[i] * (coords[j] - statistics.centroid[j]);
+        }
+      }
+    }
+
+    template <std::size_t Ndim>
+    ALPAKA_FN_HOST_ACC constexpr void normalize(ClusterStatistics<Ndim>& statistics) {
+      if (statistics.weight > 0.f) {
+        for (auto& moment : statistics.covariance) {
+          moment /= statistics.weight;
+        }
+      }
+    }
+
+    // Merge the statistics of two disjoint sets of points, before their normalization,
+    // combining the centroids and the co-moments as in the parallel algorithm of Chan et al.
+    template <std::size_t Ndim>
+    ALPAKA_FN_HOST_ACC constexpr void merge(ClusterStatistics<Ndim>& statistics,
+                                            const ClusterStatistics<Ndim>& other) {
+      if (other.size == 0) {
+        return;
+      }
+      if (statistics.size == 0) {
+        statistics = other;
+        return;
+      }
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        if (other.min[dim] < statistics.min[dim]) {
+          statistics.min[dim] = other.min[dim];
+        }
+        if (other.max[dim] > statistics.max[dim]) {
+          statistics.max[dim] = other.max[dim];
+        }
+      }
+      statistics.size += other.size;
+      if (!(other.weight > 0.f)) {
+        return;
+      }
+
+      const auto weight = statistics.weight + other.weight;
+      std::array<float, Ndim> delta;
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        delta[dim] = other.centroid[dim] - statistics.centroid[dim];
+        statistics.centroid[dim] += other.weight / weight * delta[dim];
+      }
+      const auto factor = statistics.weight * other.weight / weight;
+      for (auto i = 0u; i < Ndim; ++i) {
+        for (auto j = 0u; j < Ndim; ++j) {
+          statistics.covariance[i * Ndim + j] +=
+              other.covariance[i * Ndim + j] + factor * delta[i] * delta[j];
+        }
+      }
+      statistics.weight = weight;
+    }
+
+    // Each block reduces the clusters assigned to it, one at a time. The threads of the block
+    // accumulate interleaved subsets of the points of the cluster in their slot of the
+    // workspace, and the partial statistics are then merged with a tree reduction, so that
+    // the time spent on a cluster grows with its size divided by the threads of the block.
+    struct KernelClusterStatistics {
+      template <typename TAcc, std::size_t Ndim>
+      ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    PointsView<Ndim> points,
+                                    AssociationMapView clusters,
+                                    ClusterStatistics<Ndim>* statistics,
+                                    ClusterStatistics<Ndim>* workspace,
+                                    std::size_t workspace_size,
+                                    std::size_t n_clusters) const {
+        const auto n_threads = static_cast<std::size_t>(
+            acc.getExtentsOf(alpaka::onAcc::origin::block, alpaka::onAcc::unit::threads)[0]);
+        const auto thread = static_cast<std::size_t>(
+            acc.getIdxWithin(alpaka::onAcc::origin::block, alpaka::onAcc::unit::threads)[0]);
+        const auto block = static_cast<std::size_t>(
+            acc.getIdxWithin(alpaka::onAcc::origin::grid, alpaka::onAcc::unit::blocks)[0]);
+        auto* partials = workspace + block * n_threads;
+        ALPAKA_ASSERT_ACC((block + 1) * n_threads <= workspace_size);
+
+        for (auto [cluster] : alpaka::onAcc::makeIdxMap(
+                 acc, alpaka::onAcc::worker::blocksInGrid, alpaka::IdxRange{n_clusters})) {
+          const auto members = clusters[cluster];
+          ClusterStatistics<Ndim> partial{};
+          for (auto k = thread; k < members.size(); k += n_threads) {
+            const auto point = members[k];
+            std::array<float, Ndim> coords;
+            for (auto dim = 0u; dim < Ndim; ++dim) {
+              coords[dim] = points.coords[dim][point];
+            }
+            accumulate(partial, coords, points.weight[point]);
+          }
+          partials[thread] = partial;
+          alpaka::onAcc::syncBlockThreads(acc);
+
+          for (auto active = n_threads; active > 1;) {
+            const auto half = (active + 1) / 2;
+            if (thread < active - half) {
+              merge(partials[thread], partials[thread + half]);
+            }
+            alpaka::onAcc::syncBlockThreads(acc);
+            active = half;
+          }
+          if (thread == 0) {
+            auto cluster_statistics = partials[0];
+            normalize(cluster_statistics);
+            statistics[cluster] = cluster_statistics;
+          }
+          // the workspace is reused by the next cluster
+          alpaka::onAcc::syncBlockThreads(acc);
+        }
+      }
+    };
+
+  }  // namespace detail
+
+  template <std::size_t Ndim>
+  inline std::vector<ClusterStatistics<Ndim>> cluster_statistics(const PointsHost<Ndim>& points) {
+    assert(points.clustered());
+    auto cluster_ids = points.clusterIndexes();
+    std::vector<ClusterStatistics<Ndim>> statistics(detail::compute_nclusters(cluster_ids));
+
+    const auto& view = points.view();
+    for (auto i = 0; i < points.size(); ++i) {
+      if (cluster_ids[i] < 0) {
+        continue;
+      }
+      std::array<float, Ndim> coords;
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        coords[dim] = view.coords[dim][i];
+      }
+      detail::accumulate(statistics[cluster_ids[i]], coords, view.weight[i]);
+    }
+    for (auto& cluster_statistics : statistics) {
+      detail::normalize(cluster_statistics);
+    }
+    return statistics;
+  }
+
+  template <concepts::Queue TQueue, std::size_t Ndim>
+  inline auto cluster_statistics(TQueue& queue,
+                                 const PointsDevice<DevType<TQueue>, Ndim>& points,
+                                 const DevAssociationMap<DevType<TQueue>>& clusters) {
+    assert(points.clustered());
+    const auto n_clusters = clusters.size();
+    auto statistics =
+        make_device_buffer<ClusterStatistics<Ndim>>(queue, std::max<std::size_t>(n_clusters, 1));
+    if (n_clusters == 0) {
+      return statistics;
+    }
+
+    // a block per cluster, up to the number of blocks which keeps the workspace small
+    constexpr std::size_t block_size = 64;
+    constexpr std::size_t max_blocks = 256;
+    const auto grid_size = std::min(n_clusters, max_blocks);
+    const auto workspace_size = grid_size * block_size;
+    auto workspace = make_device_buffer<ClusterStatistics<Ndim>>(queue, workspace_size);
+    queue.enqueue(DevicePool::exec(),
+                  alpaka::onHost::FrameSpec{grid_size, block_size},
+                  detail::KernelClusterStatistics{},
+                  points.view(),
+                  clusters.view(),
+                  statistics.data(),
+                  workspace.data(),
+                  workspace_size,
+                  n_clusters);
+    return statistics;
+  }
+
+}  // namespace clue
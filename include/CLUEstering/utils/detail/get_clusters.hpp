@@ -27,7 +27,6 @@ namespace clue {
     inline auto get_clusters(TQueue& queue, std::span<const int> cluster_ids) {
       auto clustered_points = internal::algorithm::count_if(queue,
           cluster_ids.begin(), cluster_ids.end(), non_negative<int>{});
-      std::cout<<" points: "<<static_cast<int>(clustered_points)<<std::endl;
       return internal::make_associator(queue, cluster_ids, static_cast<int>(clustered_points));
     }
 
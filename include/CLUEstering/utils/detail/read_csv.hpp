@@ -3,88 +3,160 @@
 
 #include "CLUEstering/data_structures/PointsHost.hpp"
 #include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/io/MappedFile.hpp"
+#include "CLUEstering/internal/nostd/parallel_for.hpp"
 #include "CLUEstering/utils/read_csv.hpp"
 
 #include <algorithm>
-#include <fstream>
-#include <sstream>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
 
 namespace clue {
-  /// @brief Reads data from an input file
-  ///
-  /// @param dim The dimension of the points input
-  /// @param file_path
-  template <std::size_t NDim>
-  inline PointsHost<NDim> read_csv(const Dim<NDim> dim,const std::string& file_path) {
-    std::fstream file(file_path);
-    if (!file.is_open()) {
-      throw std::runtime_error("Could not open file: " + file_path);
-    }
-
-    auto n_points =
-        std::count(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), '\n') -
-        1;
 
-    PointsHost points(dim,n_points);
+  namespace detail {
 
-    file = std::fstream(file_path);
-    std::string buffer;
-    getline(file, buffer);  // discard header
+    // Files smaller than this are parsed by a single thread
+    inline constexpr std::size_t csv_block_bytes = 1 << 20;
 
-    auto point_id = 0;
-    while (getline(file, buffer)) {
-      std::stringstream buffer_stream(buffer);
-      std::string value;
+    // Split a text in blocks of similar size, all ending right after a newline
+    inline std::vector<std::string_view> split_lines(std::string_view text, std::size_t n_blocks) {
+      std::vector<std::string_view> blocks;
+      blocks.reserve(n_blocks);
+      const auto target_size = text.size() / n_blocks;
+      while (!text.empty()) {
+        auto end = blocks.size() + 1 == n_blocks ? std::string_view::npos
+                                                 : text.find('\n', target_size);
+        end = end == std::string_view::npos ? text.size() : end + 1;
+        blocks.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+      }
+      return blocks;
+    }
 
-      for (size_t dim = 0; dim < NDim; ++dim) {
-        getline(buffer_stream, value, ',');
-        points.coords(dim)[point_id] = std::stof(value);
+    // Call a function on each non-empty line of a block, without the line terminator
+    template <typename TFunc>
+    inline void for_each_line(std::string_view block, TFunc&& func) {
+      while (!block.empty()) {
+        const auto newline = block.find('\n');
+        auto line = block.substr(0, newline);
+        block.remove_prefix(newline == std::string_view::npos ? block.size() : newline + 1);
+        if (!line.empty() && line.back() == '\r') {
+          line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+          func(line);
+        }
       }
-      getline(buffer_stream, value);
-      points.weights()[point_id] = std::stof(value);
-      ++point_id;
     }
-    return points;
-  }
-  /// @brief Writes data from to an output file
-  ///
-  /// @param dim The dimension of the written points
-  /// @param file_path
-  template <std::size_t NDim>
-  inline PointsHost<NDim> read_output(Dim<NDim> /** unused **/, const std::string& file_path) {
-    std::fstream file(file_path);
-    if (!file.is_open()) {
-      throw std::runtime_error("Could not open file: " + file_path);
+
+    inline std::size_t count_lines(std::string_view block) {
+      std::size_t n_lines = 0;
+      for_each_line(block, [&](std::string_view) { ++n_lines; });
+      return n_lines;
     }
 
-    auto n_points =
-        std::count(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), '\n') -
-        1;
+    // Parse the next comma-separated field of a line, advancing past the separator
+    template <typename T>
+    inline bool parse_field(std::string_view& line, T& value) {
+      while (!line.empty() && (line.front() == ' ' || line.front() == '+')) {
+        line.remove_prefix(1);
+      }
+      const auto [ptr, error] = std::from_chars(line.data(), line.data() + line.size(), value);
+      if (error != std::errc{}) {
+        return false;
+      }
+      line.remove_prefix(static_cast<std::size_t>(ptr - line.data()));
+      while (!line.empty() && line.front() == ' ') {
+        line.remove_prefix(1);
+      }
+      if (!line.empty()) {
+        if (line.front() != ',') {
+          return false;
+        }
+        line.remove_prefix(1);
+      }
+      return true;
+    }
 
-    PointsHost<NDim> points(n_points);
-    points.mark_clustered();
+    // Read the points of a CSV file, whose rows contain the coordinates and the weight,
+    // optionally followed by the cluster index. Additional columns are ignored.
+    // The file is memory-mapped and split in blocks of lines, which are first counted
+    // and then parsed concurrently, writing the values directly in the columns of the points.
+    template <std::size_t NDim>
+    inline PointsHost<NDim> read_points(Dim<NDim> dim,
+                                        const std::string& file_path,
+                                        bool with_cluster_indexes) {
+      const internal::MappedFile file(file_path);
+      const auto text = file.text();
 
-    file = std::fstream(file_path);
-    std::string buffer;
-    getline(file, buffer);  // discard header
+      // the first line is the header
+      const auto header_end = std::min(text.find('\n'), text.size());
+      const auto n_columns =
+          static_cast<std::size_t>(std::ranges::count(text.substr(0, header_end), ',')) + 1;
+      const auto n_required = NDim + (with_cluster_indexes ? 2 : 1);
+      if (n_columns < n_required) {
+        throw std::invalid_argument("The file " + file_path + " has " + std::to_string(n_columns) +
+                                    " columns, while at least " + std::to_string(n_required) +
+                                    " are required.");
+      }
+      const auto body = text.substr(std::min(header_end + 1, text.size()));
 
-    auto point_id = 0;
-    while (getline(file, buffer)) {
-      std::stringstream buffer_stream(buffer);
-      std::string value;
+      const auto blocks = split_lines(body, nostd::host_concurrency(body.size(), csv_block_bytes));
+      std::vector<std::size_t> first_row(blocks.size() + 1, 0);
+      nostd::parallel_for(blocks.size(),
+                          [&](std::size_t block) { first_row[block + 1] = count_lines(blocks[block]); });
+      std::partial_sum(first_row.begin(), first_row.end(), first_row.begin());
 
-      for (size_t dim = 0; dim < NDim; ++dim) {
-        getline(buffer_stream, value, ',');
-        points.coords(dim)[point_id] = std::stof(value);
+      PointsHost<NDim> points(dim, static_cast<int32_t>(first_row.back()));
+      std::array<float*, NDim + 1> columns;
+      for (auto d = 0u; d < NDim; ++d) {
+        columns[d] = points.coords(d).data();
       }
-      getline(buffer_stream, value, ',');
-      points.weights()[point_id] = std::stof(value);
-      getline(buffer_stream, value, ',');
-      points.clusterIndexes()[point_id] = std::stoi(value);
+      columns[NDim] = points.weights().data();
+      auto* cluster_indexes = points.view().cluster_index;
 
-      ++point_id;
+      nostd::parallel_for(blocks.size(), [&](std::size_t block) {
+        auto row = first_row[block];
+        for_each_line(blocks[block], [&](std::string_view line) {
+          bool valid = true;
+          for (auto* column : columns) {
+            valid = valid && parse_field(line, column[row]);
+          }
+          if (with_cluster_indexes) {
+            // the cluster indexes might be written as floating point numbers
+            double cluster_index = -1.;
+            valid = valid && parse_field(line, cluster_index);
+            cluster_indexes[row] = static_cast<int>(cluster_index);
+          }
+          if (!valid) {
+            throw std::runtime_error("Could not parse row " + std::to_string(row + 1) +
+                                     " of file: " + file_path);
+          }
+          ++row;
+        });
+      });
+      return points;
     }
+
+  }  // namespace detail
+
+  template <std::size_t NDim>
+  inline PointsHost<NDim> read_csv(Dim<NDim> dim, const std::string& file_path) {
+    return detail::read_points(dim, file_path, false);
+  }
+
+  template <std::size_t NDim>
+  inline PointsHost<NDim> read_output(Dim<NDim> dim, const std::string& file_path) {
+    auto points = detail::read_points(dim, file_path, true);
+    points.mark_clustered();
     return points;
   }
+
 }  // namespace clue
@@ -2,100 +2,567 @@
 #pragma once
 
 #include "CLUEstering/data_structures/PointsHost.hpp"
-#include "CLUEstering/data_structures/AssociationMap.hpp"
+#include "CLUEstering/internal/nostd/parallel_for.hpp"
+#include "CLUEstering/utils/cluster_statistics.hpp"
+#include "CLUEstering/utils/detail/get_cluster_properties.hpp"
+#include "CLUEstering/utils/scores.hpp"
 #include <algorithm>
+#include <array>
+#include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <limits>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <numeric>
-#include <ranges>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace clue {
 
   namespace detail {
 
+    // Number of points whose distances are accumulated together, reusing each block of
+    // candidates while it's in cache
+    inline constexpr std::size_t silhouette_query_block = 32;
+    // Number of consecutive points of a cluster compared with the queries in the inner loop
+    inline constexpr std::size_t silhouette_candidate_block = 1024;
+
+    // Coordinates of the clustered points, stored contiguously for each cluster
+    template <std::size_t Ndim>
+    struct ClusteredCoordinates {
+      std::array<std::vector<float>, Ndim> coords;
+      // the points of cluster c are in the range [offsets[c], offsets[c + 1])
+      std::vector<std::size_t> offsets;
+      std::vector<int32_t> clusters;
+
+      std::size_t n_clusters() const { return offsets.size() - 1; }
+      std::size_t size() const { return offsets.back(); }
+      std::size_t count(int32_t cluster) const { return offsets[cluster + 1] - offsets[cluster]; }
+      std::array<float, Ndim> point(std::size_t position) const {
+        std::array<float, Ndim> point;
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          point[dim] = coords[dim][position];
+        }
+        return point;
+      }
+    };
+
+    // Counting sort of the clustered points by cluster index, dropping the outliers
     template <std::size_t Ndim>
-    using Point = typename PointsHost<Ndim>::Point;
+    inline ClusteredCoordinates<Ndim> sort_by_cluster(const PointsHost<Ndim>& points) {
+      const auto cluster_ids = points.clusterIndexes();
+      const auto n_clusters = static_cast<std::size_t>(compute_nclusters(cluster_ids));
+
+      ClusteredCoordinates<Ndim> sorted;
+      sorted.offsets.assign(n_clusters + 1, 0);
+      for (auto cluster : cluster_ids) {
+        if (cluster >= 0) {
+          ++sorted.offsets[cluster + 1];
+        }
+      }
+      std::partial_sum(sorted.offsets.begin(), sorted.offsets.end(), sorted.offsets.begin());
+
+      const auto n_clustered = sorted.offsets.back();
+      for (auto& coords : sorted.coords) {
+        coords.resize(n_clustered);
+      }
+      sorted.clusters.resize(n_clustered);
+      std::vector<std::size_t> next(sorted.offsets.begin(), sorted.offsets.end() - 1);
+      const auto& view = points.view();
+      for (auto i = 0u; i < cluster_ids.size(); ++i) {
+        const auto cluster = cluster_ids[i];
+        if (cluster < 0) {
+          continue;
+        }
+        const auto position = next[cluster]++;
+        for (auto dim = 0u; dim < Ndim; ++dim) {
+          sorted.coords[dim][position] = view.coords[dim][i];
+        }
+        sorted.clusters[position] = cluster;
+      }
+      return sorted;
+    }
 
+    // Compute the sum of the distances of each query point from all the points of each cluster.
+    // The candidates are compared in contiguous blocks, so that the inner loop can be vectorized,
+    // and the partial sums of each block are accumulated in double precision.
     template <std::size_t Ndim>
-    inline auto distance(const Point<Ndim>& lhs, const Point<Ndim>& rhs) {
-      auto dist = 0.f;
+    inline void distance_sums(const ClusteredCoordinates<Ndim>& sorted,
+                              std::span<const std::array<float, Ndim>> queries,
+                              std::span<double> sums) {
+      const auto n_clusters = sorted.n_clusters();
+      std::array<const float*, Ndim> columns;
       for (auto dim = 0u; dim < Ndim; ++dim) {
-        dist += (lhs[dim] - rhs[dim]) * (lhs[dim] - rhs[dim]);
+        columns[dim] = sorted.coords[dim].data();
+      }
+      std::ranges::fill(sums, 0.);
+      for (auto cluster = 0u; cluster < n_clusters; ++cluster) {
+        for (auto first = sorted.offsets[cluster]; first < sorted.offsets[cluster + 1];
+             first += silhouette_candidate_block) {
+          const auto last = std::min(first + silhouette_candidate_block, sorted.offsets[cluster + 1]);
+          for (auto query = 0u; query < queries.size(); ++query) {
+            const auto coords = queries[query];
+            auto partial = 0.f;
+            for (auto j = first; j < last; ++j) {
+              auto dist2 = 0.f;
+              for (auto dim = 0u; dim < Ndim; ++dim) {
+                const auto diff = columns[dim][j] - coords[dim];
+                dist2 += diff * diff;
+              }
+              partial += std::sqrt(dist2);
+            }
+            sums[query * n_clusters + cluster] += partial;
+          }
+        }
       }
-      return std::sqrt(dist);
     }
 
+    // Silhouette of a point of a given cluster, from the sums of its distances from each cluster.
+    // The distance of the point from itself is zero, so it doesn't contribute to its own cluster.
     template <std::size_t Ndim>
-    inline auto silhouette(const HostAssociationMap& clusters, //
-                           const PointsHost<Ndim>& points,
-                           int point) {
-      auto a = 0.f;
-      std::vector<float> b_values;
-      b_values.reserve(clusters.size() - 1);
-
-      a +=
-          std::accumulate(clusters.lower_bound(points[point].cluster_index()),
-                          clusters.upper_bound(points[point].cluster_index()),
-                          0.f,
-                          [&](float acc, int other_point) {
-                            if (other_point == point)
-                              return acc;
-                            return acc + detail::distance<Ndim>(points[point], points[other_point]);
-                          });
-      a /= static_cast<float>(clusters.count(points[point].cluster_index()) - 1);
-      for (auto cluster_idx = 0; cluster_idx < static_cast<int32_t>(clusters.size());
-           ++cluster_idx) {
-        if (cluster_idx == points[point].cluster_index())
-          continue;
-        auto b = 0.f;
-        b += std::accumulate(clusters.lower_bound(cluster_idx),
-                             clusters.upper_bound(cluster_idx),
-                             0.f,
-                             [&](float acc, int other_point) {
-                               return acc +
-                                      detail::distance<Ndim>(points[point], points[other_point]);
-                             });
-        b /= static_cast<float>(clusters.count(cluster_idx));
-        b_values.push_back(b);
+    inline float silhouette_from_sums(const ClusteredCoordinates<Ndim>& sorted,
+                                      std::span<const double> sums,
+                                      int32_t cluster) {
+      const auto a = sums[cluster] / static_cast<double>(sorted.count(cluster) - 1);
+      auto b = static_cast<double>(std::numeric_limits<float>::max());
+      for (auto other = 0u; other < sorted.n_clusters(); ++other) {
+        if (static_cast<int32_t>(other) != cluster && sorted.count(other) > 0) {
+          b = std::min(b, sums[other] / static_cast<double>(sorted.count(other)));
+        }
+      }
+      const auto max = std::max(a, b);
+      return max > 0. ? static_cast<float>((b - a) / max) : 0.f;
+    }
+
+    // Sum of the silhouettes of the points at the given sorted positions, computed concurrently
+    template <std::size_t Ndim>
+    inline double sum_silhouettes(const ClusteredCoordinates<Ndim>& sorted,
+                                  std::span<const std::size_t> positions) {
+      const auto n_clusters = sorted.n_clusters();
+      std::vector<double> partial_sums(
+          nostd::host_concurrency(positions.size(), silhouette_query_block), 0.);
+      nostd::parallel_for_blocks(
+          positions.size(),
+          [&](std::size_t block, std::size_t begin, std::size_t end) {
+            std::vector<double> sums(silhouette_query_block * n_clusters);
+            std::vector<std::array<float, Ndim>> queries(silhouette_query_block);
+            for (auto first = begin; first < end; first += silhouette_query_block) {
+              const auto n_queries = std::min(silhouette_query_block, end - first);
+              for (auto query = 0u; query < n_queries; ++query) {
+                queries[query] = sorted.point(positions[first + query]);
+              }
+              distance_sums<Ndim>(sorted,
+                                  std::span(queries).first(n_queries),
+                                  std::span(sums).first(n_queries * n_clusters));
+              for (auto query = 0u; query < n_queries; ++query) {
+                partial_sums[block] += silhouette_from_sums(
+                    sorted,
+                    std::span<const double>(sums).subspan(query * n_clusters, n_clusters),
+                    sorted.clusters[positions[first + query]]);
+              }
+            }
+          },
+          silhouette_query_block);
+      return std::reduce(partial_sums.begin(), partial_sums.end(), 0.);
+    }
+
+    // The sorted positions of the points whose silhouette is defined,
+    // which are those belonging to clusters with at least two points
+    template <std::size_t Ndim>
+    inline std::vector<std::size_t> scored_positions(const ClusteredCoordinates<Ndim>& sorted) {
+      std::vector<std::size_t> positions;
+      positions.reserve(sorted.size());
+      for (auto cluster = 0u; cluster < sorted.n_clusters(); ++cluster) {
+        if (sorted.count(cluster) >= 2) {
+          for (auto position = sorted.offsets[cluster]; position < sorted.offsets[cluster + 1];
+               ++position) {
+            positions.push_back(position);
+          }
+        }
       }
-      const auto b = std::reduce(b_values.begin(),
-                                 b_values.end(),
-                                 std::numeric_limits<float>::max(),
-                                 [](auto acc, auto val) { return std::min(acc, val); });
+      return positions;
+    }
+
+    inline constexpr std::size_t contingency_grain = 1 << 16;
+
+    // Non-empty cells of the contingency table of two labellings, with the sizes of the
+    // clusters in the rows and of the reference classes in the columns.
+    // The outliers are mapped to an additional row and column.
+    struct Contingency {
+      std::size_t n_rows;
+      std::size_t n_columns;
+      std::vector<std::pair<std::size_t, uint64_t>> cells;
+      std::vector<uint64_t> row_sizes;
+      std::vector<uint64_t> column_sizes;
+    };
+
+    inline Contingency contingency_table(std::span<const int> rows, std::span<const int> columns) {
+      Contingency table;
+      table.n_rows = static_cast<std::size_t>(compute_nclusters(rows)) + 1;
+      table.n_columns = static_cast<std::size_t>(compute_nclusters(columns)) + 1;
+      auto cell = [&](std::size_t i) -> std::size_t {
+        const auto row = rows[i] < 0 ? table.n_rows - 1 : static_cast<std::size_t>(rows[i]);
+        const auto column =
+            columns[i] < 0 ? table.n_columns - 1 : static_cast<std::size_t>(columns[i]);
+        return row * table.n_columns + column;
+      };
+
+      const auto n_cells = table.n_rows * table.n_columns;
+      const auto n_blocks = nostd::host_concurrency(rows.size(), contingency_grain);
+      // The table is filled densely by each thread only if it has no more cells than the
+      // points counted by the thread, so that the scratch never outgrows the labels
+      if (n_cells <= rows.size() / n_blocks) {
+        std::vector<std::vector<uint64_t>> counts(n_blocks);
+        nostd::parallel_for_blocks(
+            rows.size(),
+            [&](std::size_t block, std::size_t begin, std::size_t end) {
+              counts[block].assign(n_cells, 0);
+              for (auto i = begin; i < end; ++i) {
+                ++counts[block][cell(i)];
+              }
+            },
+            contingency_grain);
+        for (auto block = 1u; block < n_blocks; ++block) {
+          std::ranges::transform(counts[0], counts[block], counts[0].begin(), std::plus{});
+        }
+        for (auto index = 0u; index < n_cells; ++index) {
+          if (counts[0][index] > 0) {
+            table.cells.emplace_back(index, counts[0][index]);
+          }
+        }
+      } else {
+        std::vector<std::unordered_map<std::size_t, uint64_t>> counts(n_blocks);
+        nostd::parallel_for_blocks(
+            rows.size(),
+            [&](std::size_t block, std::size_t begin, std::size_t end) {
+              for (auto i = begin; i < end; ++i) {
+                ++counts[block][cell(i)];
+              }
+            },
+            contingency_grain);
+        for (auto block = 1u; block < n_blocks; ++block) {
+          for (const auto& [index, count] : counts[block]) {
+            counts[0][index] += count;
+          }
+        }
+        table.cells.assign(counts[0].begin(), counts[0].end());
+      }
+
+      table.row_sizes.assign(table.n_rows, 0);
+      table.column_sizes.assign(table.n_columns, 0);
+      for (const auto& [index, count] : table.cells) {
+        table.row_sizes[index / table.n_columns] += count;
+        table.column_sizes[index % table.n_columns] += count;
+      }
+      return table;
+    }
+
+    inline double entropy(std::span<const uint64_t> sizes, double n) {
+      auto entropy = 0.;
+      for (auto size : sizes) {
+        if (size > 0) {
+          const auto p = static_cast<double>(size) / n;
+          entropy -= p * std::log(p);
+        }
+      }
+      return entropy;
+    }
+
+    // Sums of the distances and of the squared distances of the points of each cluster
+    // from its centroid, accumulated concurrently by blocks of points
+    struct Dispersion {
+      std::vector<uint64_t> sizes;
+      std::vector<double> weights;
+      std::vector<double> distances;
+      std::vector<double> squared_distances;
+      std::vector<double> weighted_squared_distances;
+    };
+
+    template <std::size_t Ndim>
+    inline Dispersion dispersion(const PointsHost<Ndim>& points,
+                                 std::span<const ClusterStatistics<Ndim>> statistics) {
+      const auto cluster_ids = points.clusterIndexes();
+      const auto n_clusters = statistics.size();
+      if (n_clusters < 2) {
+        throw std::invalid_argument("The score is only defined for at least two clusters");
+      }
+      if (static_cast<std::size_t>(compute_nclusters(cluster_ids)) > n_clusters) {
+        throw std::invalid_argument("The statistics don't contain all the clusters of the points");
+      }
+
+      const auto& view = points.view();
+      const auto n_points = static_cast<std::size_t>(points.size());
+      std::vector<Dispersion> partials(nostd::host_concurrency(n_points, contingency_grain));
+      nostd::parallel_for_blocks(
+          n_points,
+          [&](std::size_t block, std::size_t begin, std::size_t end) {
+            auto& partial = partials[block];
+            partial.sizes.assign(n_clusters, 0);
+            partial.weights.assign(n_clusters, 0.);
+            partial.distances.assign(n_clusters, 0.);
+            partial.squared_distances.assign(n_clusters, 0.);
+            partial.weighted_squared_distances.assign(n_clusters, 0.);
+            for (auto i = begin; i < end; ++i) {
+              const auto cluster = cluster_ids[i];
+              if (cluster < 0) {
+                continue;
+              }
+              auto dist2 = 0.f;
+              for (auto dim = 0u; dim < Ndim; ++dim) {
+                const auto diff = view.coords[dim][i] - statistics[cluster].centroid[dim];
+                dist2 += diff * diff;
+              }
+              ++partial.sizes[cluster];
+              partial.weights[cluster] += view.weight[i];
+              partial.distances[cluster] += std::sqrt(dist2);
+              partial.squared_distances[cluster] += dist2;
+              partial.weighted_squared_distances[cluster] += view.weight[i] * dist2;
+            }
+          },
+          contingency_grain);
+
+      auto& total = partials[0];
+      for (auto block = 1u; block < partials.size(); ++block) {
+        for (auto cluster = 0u; cluster < n_clusters; ++cluster) {
+          total.sizes[cluster] += partials[block].sizes[cluster];
+          total.weights[cluster] += partials[block].weights[cluster];
+          total.distances[cluster] += partials[block].distances[cluster];
+          total.squared_distances[cluster] += partials[block].squared_distances[cluster];
+          total.weighted_squared_distances[cluster] +=
+              partials[block].weighted_squared_distances[cluster];
+        }
+      }
+      return std::move(total);
+    }
 
-      return (b - a) / std::max(a, b);
+    template <std::size_t Ndim>
+    inline double squared_distance(const std::array<float, Ndim>& lhs,
+                                   const std::array<float, Ndim>& rhs) {
+      auto dist2 = 0.;
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        const auto diff = static_cast<double>(lhs[dim]) - rhs[dim];
+        dist2 += diff * diff;
+      }
+      return dist2;
     }
 
   }  // namespace detail
 
   template <std::size_t Ndim>
   inline auto silhouette(const PointsHost<Ndim>& points, int point) {
-    const auto clusters = get_clusters(points);
+    assert(points.clustered());
+    const auto sorted = detail::sort_by_cluster(points);
+    const auto cluster = points.clusterIndexes()[point];
+    if (cluster < 0 || sorted.count(cluster) < 2) {
+      throw std::invalid_argument(
+          "The silhouette is only defined for points belonging to clusters with at least two "
+          "points");
+    }
 
-    return detail::silhouette<Ndim>(clusters, points, point);
+    std::array<std::array<float, Ndim>, 1> query;
+    for (auto dim = 0u; dim < Ndim; ++dim) {
+      query[0][dim] = points.coords(dim)[point];
+    }
+    std::vector<double> sums(sorted.n_clusters());
+    detail::distance_sums<Ndim>(sorted, query, sums);
+    return detail::silhouette_from_sums(sorted, sums, cluster);
   }
 
   template <std::size_t Ndim>
   inline auto silhouette(const PointsHost<Ndim>& points) {
-    const auto clusters = get_clusters(points);
-    std::vector<float> scores;
-    auto valid_point = [&](int point) -> bool { return points[point].cluster_index() != -1; };
-    auto valid_cluster = [&](int point) -> bool {
-      return clusters.count(points[point].cluster_index()) >= 2;
-    };
-    auto compute_silhouette = [&](std::size_t point) -> float {
-      return detail::silhouette(clusters, points, point);
-    };
-    std::ranges::copy(std::views::iota(0) | std::views::take(points.size()) |
-                          std::views::filter(valid_point) | std::views::filter(valid_cluster) |
-                          std::views::transform(compute_silhouette),
-                      std::back_inserter(scores));
+    assert(points.clustered());
+    const auto sorted = detail::sort_by_cluster(points);
+    const auto positions = detail::scored_positions(sorted);
+
+    return static_cast<float>(detail::sum_silhouettes(sorted, std::span(positions)) /
+                              static_cast<double>(positions.size()));
+  }
+
+  template <std::size_t Ndim>
+  inline SilhouetteEstimate sampled_silhouette(const PointsHost<Ndim>& points,
+                                               std::size_t samples,
+                                               float confidence,
+                                               uint64_t seed) {
+    assert(points.clustered());
+    if (samples == 0 || !(confidence > 0.f && confidence < 1.f)) {
+      throw std::invalid_argument(
+          "The number of samples must be positive and the confidence level in (0, 1)");
+    }
+    const auto sorted = detail::sort_by_cluster(points);
+    auto positions = detail::scored_positions(sorted);
+    if (samples >= positions.size()) {
+      const auto score = detail::sum_silhouettes(sorted, std::span(positions)) /
+                         static_cast<double>(positions.size());
+      return {static_cast<float>(score), 0.f, confidence, positions.size()};
+    }
+
+    std::vector<std::size_t> sampled;
+    sampled.reserve(samples);
+    std::ranges::sample(positions, std::back_inserter(sampled), samples, std::mt19937_64{seed});
+    const auto score =
+        detail::sum_silhouettes(sorted, std::span(sampled)) / static_cast<double>(samples);
+
+    // Hoeffding's inequality for values in [-1, 1], which also holds when sampling
+    // without replacement
+    const auto error =
+        std::sqrt(2. * std::log(2. / (1. - static_cast<double>(confidence))) / samples);
+    return {static_cast<float>(score), static_cast<float>(error), confidence, samples};
+  }
+
+  inline ExternalScores external_scores(std::span<const int> cluster_indexes,
+                                        std::span<const int> truth) {
+    if (cluster_indexes.size() != truth.size() || cluster_indexes.empty()) {
+      throw std::invalid_argument(
+          "The labellings must be non-empty and contain a label for each point");
+    }
+    const auto table = detail::contingency_table(cluster_indexes, truth);
+    const auto n = static_cast<double>(cluster_indexes.size());
+    auto pairs = [](double size) { return size * (size - 1.) / 2.; };
+
+    auto index = 0., mutual_information = 0.;
+    std::vector<uint64_t> row_maxima(table.n_rows, 0);
+    for (const auto& [cell, count] : table.cells) {
+      const auto row = cell / table.n_columns;
+      const auto column = cell % table.n_columns;
+      const auto size = static_cast<double>(count);
+      index += pairs(size);
+      mutual_information +=
+          size / n *
+          std::log(n * size /
+                   (static_cast<double>(table.row_sizes[row]) * table.column_sizes[column]));
+      row_maxima[row] = std::max(row_maxima[row], count);
+    }
+    auto row_pairs = 0., column_pairs = 0.;
+    for (auto size : table.row_sizes) {
+      row_pairs += pairs(static_cast<double>(size));
+    }
+    for (auto size : table.column_sizes) {
+      column_pairs += pairs(static_cast<double>(size));
+    }
+    const auto expected_index = n > 1. ? row_pairs * column_pairs / pairs(n) : 0.;
+    const auto max_index = (row_pairs + column_pairs) / 2.;
+
+    const auto cluster_entropy = detail::entropy(table.row_sizes, n);
+    const auto truth_entropy = detail::entropy(table.column_sizes, n);
+    const auto entropies = cluster_entropy + truth_entropy;
+    const auto purity = std::reduce(row_maxima.begin(), row_maxima.end(), uint64_t{0});
+
+    ExternalScores scores;
+    scores.adjusted_rand_index =
+        max_index == expected_index
+            ? 1.f
+            : static_cast<float>((index - expected_index) / (max_index - expected_index));
+    scores.normalized_mutual_information =
+        entropies > 0. ? static_cast<float>(2. * mutual_information / entropies) : 1.f;
+    scores.homogeneity =
+        truth_entropy > 0. ? static_cast<float>(mutual_information / truth_entropy) : 1.f;
+    scores.completeness =
+        cluster_entropy > 0. ? static_cast<float>(mutual_information / cluster_entropy) : 1.f;
+    scores.purity = static_cast<float>(static_cast<double>(purity) / n);
+    return scores;
+  }
 
-    return std::reduce(scores.begin(), scores.end(), 0.f) / static_cast<float>(scores.size());
+  template <std::size_t Ndim>
+  inline ExternalScores external_scores(const PointsHost<Ndim>& points,
+                                        const PointsHost<Ndim>& truth) {
+    assert(points.clustered() && truth.clustered());
+    return external_scores(points.clusterIndexes(), truth.clusterIndexes());
+  }
+
+  template <std::size_t Ndim>
+  inline float davies_bouldin(const PointsHost<Ndim>& points,
+                              std::span<const ClusterStatistics<Ndim>> statistics) {
+    assert(points.clustered());
+    const auto dispersion = detail::dispersion(points, statistics);
+    const auto n_clusters = statistics.size();
+    std::vector<double> scatter(n_clusters, 0.);
+    for (auto cluster = 0u; cluster < n_clusters; ++cluster) {
+      if (dispersion.sizes[cluster] > 0) {
+        scatter[cluster] = dispersion.distances[cluster] / dispersion.sizes[cluster];
+      }
+    }
+
+    std::vector<double> partials(nostd::host_concurrency(n_clusters, 64), 0.);
+    nostd::parallel_for_blocks(
+        n_clusters,
+        [&](std::size_t block, std::size_t begin, std::size_t end) {
+          for (auto i = begin; i < end; ++i) {
+            auto max_ratio = 0.;
+            for (auto j = 0u; j < n_clusters; ++j) {
+              if (j == i) {
+                continue;
+              }
+              const auto separation = std::sqrt(
+                  detail::squared_distance<Ndim>(statistics[i].centroid, statistics[j].centroid));
+              // clusters with coincident centroids don't contribute, as in scikit-learn
+              if (!(separation > 0.)) {
+                continue;
+              }
+              max_ratio = std::max(max_ratio, (scatter[i] + scatter[j]) / separation);
+            }
+            partials[block] += max_ratio;
+          }
+        },
+        64);
+    return static_cast<float>(std::reduce(partials.begin(), partials.end(), 0.) /
+                              static_cast<double>(n_clusters));
+  }
+
+  template <std::size_t Ndim>
+  inline float davies_bouldin(const PointsHost<Ndim>& points) {
+    const auto statistics = cluster_statistics(points);
+    return davies_bouldin(points, std::span<const ClusterStatistics<Ndim>>(statistics));
+  }
+
+  template <std::size_t Ndim>
+  inline float calinski_harabasz(const PointsHost<Ndim>& points,
+                                 std::span<const ClusterStatistics<Ndim>> statistics) {
+    assert(points.clustered());
+    const auto dispersion = detail::dispersion(points, statistics);
+    const auto n_clusters = statistics.size();
+
+    // the dispersions are weighted by the weights of the points, as the centroids, while the
+    // degrees of freedom are given by the number of points
+    const auto n = static_cast<double>(
+        std::reduce(dispersion.sizes.begin(), dispersion.sizes.end(), uint64_t{0}));
+    const auto total_weight =
+        std::reduce(dispersion.weights.begin(), dispersion.weights.end(), 0.);
+
+    // the weighted centroid of all the clustered points
+    std::array<double, Ndim> center{};
+    for (auto cluster = 0u; cluster < n_clusters; ++cluster) {
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        center[dim] +=
+            dispersion.weights[cluster] * statistics[cluster].centroid[dim] / total_weight;
+      }
+    }
+    std::array<float, Ndim> center_coords;
+    std::ranges::transform(center, center_coords.begin(), [](double coord) {
+      return static_cast<float>(coord);
+    });
+
+    auto between = 0., within = 0.;
+    for (auto cluster = 0u; cluster < n_clusters; ++cluster) {
+      between += dispersion.weights[cluster] *
+                 detail::squared_distance<Ndim>(statistics[cluster].centroid, center_coords);
+      within += dispersion.weighted_squared_distances[cluster];
+    }
+    if (within == 0.) {
+      return 1.f;
+    }
+    return static_cast<float>(between * (n - n_clusters) / (within * (n_clusters - 1.)));
+  }
+
+  template <std::size_t Ndim>
+  inline float calinski_harabasz(const PointsHost<Ndim>& points) {
+    const auto statistics = cluster_statistics(points);
+    return calinski_harabasz(points, std::span<const ClusterStatistics<Ndim>>(statistics));
   }
 
 }  // namespace clue
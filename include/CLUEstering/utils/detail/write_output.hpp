@@ -0,0 +1,200 @@
+
+#pragma once
+
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/internal/nostd/parallel_for.hpp"
+#include "CLUEstering/utils/write_output.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace clue {
+
+  namespace detail {
+
+    // Number of lines formatted by each thread before the buffers are written to the file
+    inline constexpr std::size_t csv_lines_per_block = 1 << 16;
+
+    // A named column of the file, containing either floating point or integer values,
+    // or the bits of a bitset written as integers
+    struct CsvColumn {
+      std::string name;
+      const float* floats = nullptr;
+      const int* ints = nullptr;
+      const uint32_t* bits = nullptr;
+    };
+
+    struct CsvBuffer {
+      std::unique_ptr<char[]> data;
+      std::size_t capacity = 0;
+      std::size_t size = 0;
+
+      void reserve(std::size_t bytes) {
+        if (bytes > capacity) {
+          data = std::make_unique_for_overwrite<char[]>(bytes);
+          capacity = bytes;
+        }
+        size = 0;
+      }
+    };
+
+    // Upper bound to the number of characters of a formatted value, including the separator
+    inline constexpr std::size_t csv_float_chars = 16;
+    inline constexpr std::size_t csv_int_chars = 12;
+
+    inline void format_lines(CsvBuffer& buffer,
+                             std::span<const CsvColumn> columns,
+                             std::size_t begin,
+                             std::size_t end) {
+      std::size_t line_chars = 0;
+      for (const auto& column : columns) {
+        line_chars += column.floats != nullptr ? csv_float_chars : csv_int_chars;
+      }
+      buffer.reserve((end - begin) * line_chars);
+
+      auto* it = buffer.data.get();
+      auto* const last = it + buffer.capacity;
+      for (auto i = begin; i < end; ++i) {
+        for (auto c = 0u; c < columns.size(); ++c) {
+          const auto& column = columns[c];
+          if (column.floats != nullptr) {
+            it = std::to_chars(it, last, column.floats[i]).ptr;
+          } else if (column.ints != nullptr) {
+            it = std::to_chars(it, last, column.ints[i]).ptr;
+          } else {
+            *it++ = ((column.bits[i / 32] >> (i % 32)) & 1u) ? '1' : '0';
+          }
+          *it++ = c + 1 == columns.size() ? '\n' : ',';
+        }
+      }
+      buffer.size = static_cast<std::size_t>(it - buffer.data.get());
+    }
+
+    // Write a set of columns to a CSV file.
+    // The lines are split in rounds, in which each thread formats a block of lines in its own
+    // buffer. The buffers of a round are written to the file by a separate thread, while the
+    // lines of the following round are being formatted in a second set of buffers.
+    // An exception thrown by the writer is rethrown when it's joined.
+    inline void write_csv_columns(const std::string& file_path,
+                                  std::span<const CsvColumn> columns,
+                                  std::size_t n_lines) {
+      std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+      if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + file_path);
+      }
+      std::string header;
+      for (const auto& column : columns) {
+        header += (header.empty() ? "" : ",") + column.name;
+      }
+      header += '\n';
+      file.write(header.data(), header.size());
+
+      const auto n_threads = nostd::host_concurrency(n_lines, csv_lines_per_block);
+      const auto lines_per_round = n_threads * csv_lines_per_block;
+      std::array<std::vector<CsvBuffer>, 2> buffers{std::vector<CsvBuffer>(n_threads),
+                                                    std::vector<CsvBuffer>(n_threads)};
+      std::thread writer;
+      std::exception_ptr write_error;
+      const auto join_writer = [&] {
+        if (writer.joinable()) {
+          writer.join();
+        }
+        if (write_error) {
+          std::rethrow_exception(std::exchange(write_error, nullptr));
+        }
+      };
+      try {
+        for (std::size_t first = 0, round = 0; first < n_lines;
+             first += lines_per_round, ++round) {
+          auto& round_buffers = buffers[round % 2];
+          nostd::parallel_for(n_threads, [&](std::size_t thread) {
+            const auto begin = std::min(first + thread * csv_lines_per_block, n_lines);
+            const auto end = std::min(begin + csv_lines_per_block, n_lines);
+            format_lines(round_buffers[thread], columns, begin, end);
+          });
+
+          join_writer();
+          writer = std::thread([&file, &round_buffers, &write_error] {
+            try {
+              for (const auto& buffer : round_buffers) {
+                file.write(buffer.data.get(), buffer.size);
+              }
+            } catch (...) {
+              write_error = std::current_exception();
+            }
+          });
+        }
+      } catch (...) {
+        // the writer still uses the buffers and the file, and must be joined anyway
+        if (writer.joinable()) {
+          writer.join();
+        }
+        throw;
+      }
+      join_writer();
+
+      file.flush();
+      if (!file) {
+        throw std::runtime_error("Could not write file: " + file_path);
+      }
+    }
+
+    inline void check_output_column(std::size_t column_size, std::size_t n_points) {
+      if (column_size != 0 && column_size != n_points) {
+        throw std::invalid_argument(
+            "The optional output columns must contain a value for each point.");
+      }
+    }
+
+    inline void check_seed_column(std::size_t words, std::size_t n_points) {
+      if (words != 0 && words != (n_points + 31) / 32) {
+        throw std::invalid_argument("The bitset of the seeds must contain a bit for each point.");
+      }
+    }
+
+  }  // namespace detail
+
+  template <std::size_t NDim>
+  inline void write_output(const PointsHost<NDim>& points,
+                           const std::string& file_path,
+                           const OutputColumns& columns) {
+    if (!points.clustered()) {
+      throw std::invalid_argument("The points must be clustered before writing the output.");
+    }
+    const auto n_points = static_cast<std::size_t>(points.size());
+    detail::check_output_column(columns.rho.size(), n_points);
+    detail::check_output_column(columns.delta.size(), n_points);
+    detail::check_seed_column(columns.is_seed.size(), n_points);
+
+    std::vector<detail::CsvColumn> csv_columns;
+    for (auto dim = 0u; dim < NDim; ++dim) {
+      csv_columns.push_back({"x" + std::to_string(dim), points.coords(dim).data()});
+    }
+    csv_columns.push_back({"weight", points.weights().data()});
+    csv_columns.push_back({"cluster_ids", nullptr, points.clusterIndexes().data()});
+    if (!columns.rho.empty()) {
+      csv_columns.push_back({"rho", columns.rho.data()});
+    }
+    if (!columns.delta.empty()) {
+      csv_columns.push_back({"delta", columns.delta.data()});
+    }
+    if (!columns.is_seed.empty()) {
+      csv_columns.push_back({"is_seed", nullptr, nullptr, columns.is_seed.data()});
+    }
+    detail::write_csv_columns(file_path, csv_columns, n_points);
+  }
+
+}  // namespace clue
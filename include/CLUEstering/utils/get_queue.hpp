@@ -6,21 +6,40 @@
 
 #include "CLUEstering/detail/concepts.hpp"
 #include <concepts>
-#include <queue>
+#include <deque>
 #include <alpaka/alpaka.hpp>
 
 namespace clue {
-  /// @brief Get a static alpaka queue created from a corresponding device (default is a blocking queue)
+  /// @brief Get the alpaka queue of the calling thread for a given device (default is a blocking queue)
+  ///
+  /// Each thread owns one queue per device and queue kind, created on first use and reused by
+  /// the following calls. Work submitted from different threads is therefore never serialized
+  /// on a shared queue, which allows clustering concurrently from several host threads.
+  ///
+  /// @param device The device the queue is associated to
+  /// @param kind The kind of queue, either blocking or non-blocking
+  /// @return A reference to the queue, valid until the calling thread exits
   template <alpaka::onHost::concepts::Device T_Device,
             alpaka::concepts::QueueKind T_Kind = alpaka::queueKind::Blocking>
   inline auto& get_queue(T_Device& device, T_Kind kind = T_Kind{}) {
-    static auto queue = device.makeQueue(kind);
-    return queue;
+    using queue_type = ALPAKA_TYPEOF(device.makeQueue(kind));
+    // a deque is used so that references to the queues remain valid when new ones are added
+    thread_local std::deque<queue_type> queues;
+    for (auto& queue : queues) {
+      if (queue.getDevice() == device) {
+        return queue;
+      }
+    }
+    return queues.emplace_back(device.makeQueue(kind));
   }
-  /// @brief Get a static alpaka queue created from a corresponding device (default is a blocking queue)
+  /// @brief Get the alpaka queue of the calling thread for the device with a given index (default is a blocking queue)
+  ///
+  /// @param Id The index of the device in the device pool
+  /// @param kind The kind of queue, either blocking or non-blocking
+  /// @return A reference to the queue, valid until the calling thread exits
   template <std::integral T_Id, alpaka::concepts::QueueKind T_Kind = alpaka::queueKind::Blocking>
   inline auto& get_queue(T_Id Id, T_Kind kind = T_Kind{}) {
-    return get_queue(DevicePool::deviceAt(Id));
+    return get_queue(DevicePool::deviceAt(Id), kind);
   }
   template <alpaka::onHost::concepts::Device T_Device,
             alpaka::concepts::QueueKind T_Kind = alpaka::queueKind::Blocking>
@@ -13,23 +13,28 @@ namespace clue {
 
   /// @brief Read points from a CSV file into a PointsHost object
   ///
+  /// The file is expected to have a header line, followed by one line per point
+  /// containing its coordinates and its weight. Additional columns are ignored.
+  /// The file is memory-mapped and its lines are parsed concurrently.
+  ///
   /// @tparam NDim The number of dimensions of the points
-  /// @tparam TQueue The type of the queue to use for reading the file
-  /// @param queue The queue to use for reading the file
+  /// @param dim The dimension of the points
   /// @param file_path The path to the CSV file to read
   /// @return A PointsHost object containing the points read from the file
-  template <std::size_t NDim, concepts::Queue TQueue>
-  inline PointsHost<NDim> read_csv(TQueue& queue, const std::string& file_path);
+  template <std::size_t NDim>
+  inline PointsHost<NDim> read_csv(Dim<NDim> dim, const std::string& file_path);
 
   /// @brief Read output points from a CSV file into a PointsHost object
   ///
+  /// The lines of the file contain the coordinates, the weight and the cluster index
+  /// of each point. Additional columns are ignored.
+  ///
   /// @tparam NDim The number of dimensions of the points
-  /// @tparam TQueue The type of the queue to use for reading the file
-  /// @param queue The queue to use for reading the file
+  /// @param dim The dimension of the points
   /// @param file_path The path to the CSV file to read
   /// @return A PointsHost object containing the output points read from the file
-  template <std::size_t NDim, concepts::Queue TQueue>
-  inline PointsHost<NDim> read_output(TQueue& queue, const std::string& file_path);
+  template <std::size_t NDim>
+  inline PointsHost<NDim> read_output(Dim<NDim> dim, const std::string& file_path);
 
 }  // namespace clue
 
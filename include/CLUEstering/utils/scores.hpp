@@ -5,21 +5,43 @@
 #pragma once
 
 #include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/utils/cluster_statistics.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
 
 namespace clue {
 
+  /// @brief Estimate of the average silhouette score, obtained from a sample of the points
+  struct SilhouetteEstimate {
+    /// @brief The average silhouette score of the sampled points
+    float score;
+    /// @brief The maximum distance of the estimate from the exact score, with probability
+    /// at least equal to the confidence level
+    float error;
+    /// @brief The confidence level of the error bound
+    float confidence;
+    /// @brief The number of sampled points
+    std::size_t samples;
+  };
+
   /// @brief Compute the silhouette score for a specific point in the dataset.
   ///
   /// @tparam Ndim The number of dimensions of the points
   /// @param points The dataset containing the points
   /// @param point The index of the point for which to compute the silhouette score
   /// @return The silhouette score of the specified point
+  /// @throws std::invalid_argument if the point doesn't belong to a cluster with at least two points
   /// @note This function currently only works for points with non-periodic coordinates.
   template <std::size_t Ndim>
-  auto silhouette(const PointsHost<Ndim>& points, std::size_t point);
+  auto silhouette(const PointsHost<Ndim>& points, int point);
 
   /// @brief Compute the average silhouette score for the entire dataset.
   ///
+  /// The exact score is computed concurrently on the host threads, comparing each point with
+  /// contiguous blocks of the points of each cluster. The cost grows quadratically with the
+  /// number of points, so for large datasets consider using sampled_silhouette.
+  ///
   /// @tparam Ndim The number of dimensions of the points
   /// @param points The dataset containing the points
   /// @return The average silhouette score of the dataset
@@ -27,6 +49,119 @@ namespace clue {
   template <std::size_t Ndim>
   auto silhouette(const PointsHost<Ndim>& points);
 
+  /// @brief Estimate the average silhouette score from a random sample of the points.
+  ///
+  /// The exact silhouette of each sampled point is computed against the whole dataset,
+  /// so the cost grows linearly with the number of points. The error bound is obtained from
+  /// Hoeffding's inequality and only depends on the number of samples and the confidence level.
+  ///
+  /// @tparam Ndim The number of dimensions of the points
+  /// @param points The dataset containing the points
+  /// @param samples The number of points to sample. If it's not smaller than the number of
+  /// scored points, the exact score is computed
+  /// @param confidence The probability with which the error bound holds
+  /// @param seed The seed of the random generator used for the sampling
+  /// @return The estimate of the average silhouette score, with its error bound
+  /// @note This function currently only works for points with non-periodic coordinates.
+  template <std::size_t Ndim>
+  SilhouetteEstimate sampled_silhouette(const PointsHost<Ndim>& points,
+                                        std::size_t samples,
+                                        float confidence = 0.95f,
+                                        uint64_t seed = 0);
+
+  /// @brief Scores measuring the agreement between a clustering and a reference labelling
+  struct ExternalScores {
+    /// @brief The Rand index adjusted for chance, equal to one for identical labellings
+    float adjusted_rand_index;
+    /// @brief The mutual information normalized by the arithmetic mean of the entropies
+    float normalized_mutual_information;
+    /// @brief The fraction of the reference entropy explained by the clusters,
+    /// equal to one if each cluster only contains points of a single reference class
+    float homogeneity;
+    /// @brief The fraction of the cluster entropy explained by the reference classes,
+    /// equal to one if all the points of each reference class are in the same cluster
+    float completeness;
+    /// @brief The fraction of points belonging to the most frequent reference class of their cluster
+    float purity;
+  };
+
+  /// @brief Compare a clustering with a reference labelling.
+  ///
+  /// The scores are computed from the contingency table of the two labellings,
+  /// which is filled concurrently on the host threads.
+  /// The outliers, which have a negative index, are treated as a class of their own.
+  ///
+  /// @param cluster_indexes The cluster index of each point
+  /// @param truth The reference label of each point
+  /// @return The external validation scores
+  /// @throws std::invalid_argument if the two labellings have different sizes
+  inline ExternalScores external_scores(std::span<const int> cluster_indexes,
+                                        std::span<const int> truth);
+
+  /// @brief Compare the clustering of a dataset with a reference clustering.
+  ///
+  /// @tparam Ndim The number of dimensions of the points
+  /// @param points The clustered points
+  /// @param truth The points with the reference cluster indexes, for instance read with read_output
+  /// @return The external validation scores
+  template <std::size_t Ndim>
+  ExternalScores external_scores(const PointsHost<Ndim>& points, const PointsHost<Ndim>& truth);
+
+  /// @brief Compute the Davies-Bouldin index of the clustering.
+  ///
+  /// Lower values correspond to more compact and better separated clusters.
+  /// Pairs of clusters with coincident centroids are skipped instead of dividing by zero.
+  ///
+  /// @tparam Ndim The number of dimensions of the points
+  /// @param points The clustered points
+  /// @param statistics The statistics of the clusters, whose centroids are reused,
+  /// for instance copied from those computed on device
+  /// @return The Davies-Bouldin index
+  /// @throws std::invalid_argument if there are less than two clusters
+  template <std::size_t Ndim>
+  float davies_bouldin(const PointsHost<Ndim>& points,
+                       std::span<const ClusterStatistics<Ndim>> statistics);
+
+  /// @brief Compute the Davies-Bouldin index of the clustering.
+  ///
+  /// The centroids of the clusters are computed with cluster_statistics,
+  /// so they are weighted by the weights of the points.
+  ///
+  /// @tparam Ndim The number of dimensions of the points
+  /// @param points The clustered points
+  /// @return The Davies-Bouldin index
+  /// @throws std::invalid_argument if there are less than two clusters
+  template <std::size_t Ndim>
+  float davies_bouldin(const PointsHost<Ndim>& points);
+
+  /// @brief Compute the Calinski-Harabasz index of the clustering.
+  ///
+  /// Higher values correspond to denser and better separated clusters.
+  /// The dispersions between and within the clusters are weighted by the weights of the
+  /// points, so that with unit weights the index is the usual one.
+  ///
+  /// @tparam Ndim The number of dimensions of the points
+  /// @param points The clustered points
+  /// @param statistics The statistics of the clusters, whose centroids are reused,
+  /// for instance copied from those computed on device
+  /// @return The Calinski-Harabasz index
+  /// @throws std::invalid_argument if there are less than two clusters
+  template <std::size_t Ndim>
+  float calinski_harabasz(const PointsHost<Ndim>& points,
+                          std::span<const ClusterStatistics<Ndim>> statistics);
+
+  /// @brief Compute the Calinski-Harabasz index of the clustering.
+  ///
+  /// The centroids of the clusters are computed with cluster_statistics,
+  /// so they are weighted by the weights of the points.
+  ///
+  /// @tparam Ndim The number of dimensions of the points
+  /// @param points The clustered points
+  /// @return The Calinski-Harabasz index
+  /// @throws std::invalid_argument if there are less than two clusters
+  template <std::size_t Ndim>
+  float calinski_harabasz(const PointsHost<Ndim>& points);
+
 }  // namespace clue
 
 #include "CLUEstering/utils/detail/scores.hpp"
@@ -0,0 +1,51 @@
+/// @file write_output.hpp
+/// @brief Provides functions to write the results of the clustering to a CSV file
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/data_structures/PointsHost.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace clue {
+
+  /// @brief Optional per-point quantities written together with the results of the clustering
+  ///
+  /// Each quantity is written only if the corresponding span is not empty, in which case
+  /// it must contain a value for each point, or a bit for each point for the seeds.
+  struct OutputColumns {
+    /// @brief The local density of the points
+    std::span<const float> rho;
+    /// @brief The distance of the points from their nearest higher
+    std::span<const float> delta;
+    /// @brief The bitset of the seeds, as returned by PointsDevice::isSeed, where the bit
+    /// i % 32 of the word i / 32 is set if the point i is a seed. The seeds are written as
+    /// 1 and the other points as 0
+    std::span<const uint32_t> is_seed;
+  };
+
+  /// @brief Write the results of the clustering to a CSV file
+  ///
+  /// The file contains a header line followed by a line per point, with its coordinates,
+  /// weight and cluster index, followed by the optional columns, if provided.
+  /// The lines are formatted concurrently in per-thread buffers, which are written
+  /// to the file in large sequential chunks while the next lines are being formatted.
+  ///
+  /// @tparam NDim The number of dimensions of the points
+  /// @param points The clustered points to write
+  /// @param file_path The path to the CSV file to write
+  /// @param columns The optional columns to write
+  /// @throw std::invalid_argument if the points have not been clustered or if the size of the
+  /// optional columns doesn't match the number of points
+  template <std::size_t NDim>
+  inline void write_output(const PointsHost<NDim>& points,
+                           const std::string& file_path,
+                           const OutputColumns& columns = {});
+
+}  // namespace clue
+
+#include "CLUEstering/utils/detail/write_output.hpp"
@@ -0,0 +1,76 @@
+#include "CLUEstering/CLUEstering.hpp"
+#include "CLUEstering/data_structures/internal/Arena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+TEST_CASE("Test the arena of the temporary buffers") {
+  auto device = clue::DevicePool::deviceAt(0u);
+  auto& queue = clue::get_queue(device);
+  using Arena = clue::internal::Arena<clue::DevType<std::decay_t<decltype(queue)>>>;
+  constexpr auto alignment = clue::internal::arena_alignment;
+
+  Arena arena;
+  CHECK(arena.capacity() == 0);
+  CHECK(arena.used() == 0);
+
+  SUBCASE("The buffers overflowing the slab are allocated separately") {
+    // the slab is empty before the first clustering
+    auto* first = arena.allocate<float>(queue, 100);
+    auto* second = arena.allocate<int32_t>(queue, 1000);
+    CHECK(first != nullptr);
+    CHECK(second != nullptr);
+    CHECK(arena.capacity() == 0);
+    // the sizes are rounded to the alignment
+    CHECK(arena.used() == 2 * alignment + 16 * alignment);
+  }
+
+  SUBCASE("The slab is regrown to the largest memory used") {
+    arena.allocate<float>(queue, 100);
+    arena.allocate<int32_t>(queue, 1000);
+    const auto high_water_mark = arena.used();
+    arena.reset();
+    CHECK(arena.used() == 0);
+    CHECK(arena.capacity() == 0);
+
+    // the following clustering of the same size is served by the slab alone
+    auto* first = reinterpret_cast<std::byte*>(arena.allocate<float>(queue, 100));
+    CHECK(arena.capacity() == high_water_mark);
+    auto* second = reinterpret_cast<std::byte*>(arena.allocate<int32_t>(queue, 1000));
+    CHECK(second - first == 2 * alignment);
+    CHECK(arena.used() == high_water_mark);
+    CHECK(arena.capacity() == high_water_mark);
+
+    // a larger clustering overflows again, and the slab is regrown after the reset
+    arena.allocate<double>(queue, 64);
+    CHECK(arena.capacity() == high_water_mark);
+    CHECK(arena.used() == high_water_mark + 2 * alignment);
+    arena.reset();
+    arena.allocate<std::byte>(queue, 1);
+    CHECK(arena.capacity() == high_water_mark + 2 * alignment);
+    CHECK(arena.used() == alignment);
+
+    // a smaller clustering doesn't shrink the slab
+    arena.reset();
+    arena.allocate<std::byte>(queue, 1);
+    CHECK(arena.capacity() == high_water_mark + 2 * alignment);
+  }
+
+  SUBCASE("The arena is reset when a clustering throws") {
+    try {
+      clue::internal::ArenaGuard guard{arena, queue};
+      auto* buffer = arena.allocate<float>(queue, 1 << 20);
+      CHECK(arena.used() == (1 << 22));
+      // the buffer is still being written when the clustering throws
+      alpaka::onHost::memset(queue, alpaka::makeView(queue, buffer, clue::Vec1D{1u << 20}), 0);
+      throw std::runtime_error("clustering failed");
+    } catch (const std::runtime_error&) {
+    }
+    CHECK(arena.used() == 0);
+  }
+}
@@ -0,0 +1,157 @@
+#include "CLUEstering/CLUEstering.hpp"
+#include "CLUEstering/internal/alpaka/caching_allocator/caching_allocator.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+using Device = std::decay_t<decltype(clue::DevicePool::deviceAt(0u))>;
+using Queue = std::decay_t<decltype(clue::get_queue(clue::DevicePool::deviceAt(0u)))>;
+using Allocator = clue::CachingAllocator<Device, Queue>;
+
+namespace {
+
+  // an allocator without limits on the cached memory, so that every freed block is cached
+  auto make_allocator(Device& device) {
+    return std::make_unique<Allocator>(device,
+                                       clue::get_queue(device),
+                                       2,       // binGrowth
+                                       8,       // minBin
+                                       24,      // maxBin
+                                       0,       // maxCachedBytes
+                                       0.,      // maxCachedFraction
+                                       true,    // reuseSameQueueAllocations
+                                       false);  // debug
+  }
+
+}  // namespace
+
+TEST_CASE("Test concurrent allocations with the caching allocator") {
+  auto& device = clue::DevicePool::deviceAt(0u);
+  auto allocator = make_allocator(device);
+
+  constexpr int n_threads = 8;
+  constexpr int n_iterations = 2000;
+  std::mutex mutex;
+  // the blocks handed out and not yet freed, and all the blocks ever allocated
+  std::map<void*, std::size_t> live;
+  std::map<void*, std::size_t> allocated;
+  std::atomic<int> duplicates{0};
+
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t] {
+      auto& queue = clue::get_queue(device);
+      std::mt19937 generator(t);
+      // mostly small blocks, served by the magazines and the lock-free lists,
+      // and some larger ones, served by the cache protected by the lock
+      std::uniform_int_distribution<std::size_t> small(1, 1 << 14);
+      std::uniform_int_distribution<std::size_t> large((1 << 20) + 1, 1 << 21);
+      std::vector<Allocator::Block*> held;
+      for (auto i = 0; i < n_iterations; ++i) {
+        const auto bytes = (i % 16 == 0) ? large(generator) : small(generator);
+        auto* block = allocator->allocate(bytes, queue);
+        {
+          std::scoped_lock lock(mutex);
+          if (not live.emplace(block->data(), block->bytes).second) {
+            ++duplicates;
+          }
+          allocated.emplace(block->data(), block->bytes);
+        }
+        held.push_back(block);
+        // free the blocks in a different order from the allocations
+        if (held.size() > 4 or i == n_iterations - 1) {
+          while (not held.empty()) {
+            auto* freed = held[generator() % held.size()];
+            std::erase(held, freed);
+            {
+              std::scoped_lock lock(mutex);
+              live.erase(freed->data());
+            }
+            allocator->free(freed);
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  CHECK(duplicates == 0);
+  CHECK(live.empty());
+
+  // every block is cached, including the ones in the magazines of the terminated threads
+  auto stats = allocator->stats();
+  std::size_t allocated_bytes = 0;
+  for (const auto& [data, bytes] : allocated) {
+    allocated_bytes += bytes;
+  }
+  CHECK(stats.liveBlocks == 0);
+  CHECK(stats.liveBytes == 0);
+  CHECK(stats.requestedBytes == 0);
+  CHECK(stats.misses == allocated.size());
+  CHECK(stats.hits + stats.misses == static_cast<std::size_t>(n_threads * n_iterations));
+  CHECK(stats.cachedBytes == allocated_bytes);
+
+  // the blocks released by the terminated threads are reused
+  auto& queue = clue::get_queue(device);
+  auto* block = allocator->allocate(256, queue);
+  CHECK(allocator->stats().hits == stats.hits + 1);
+  CHECK(allocated.contains(block->data()));
+  allocator->free(block);
+}
+
+TEST_CASE("Test the destruction of the caching allocator before the threads using it") {
+  auto& device = clue::DevicePool::deviceAt(0u);
+  auto allocator = make_allocator(device);
+
+  std::atomic<bool> cached{false};
+  std::atomic<bool> destroyed{false};
+  std::thread thread([&] {
+    auto& queue = clue::get_queue(device);
+    // the block is kept in the magazine of the thread
+    allocator->free(allocator->allocate(1024, queue));
+    cached = true;
+    while (not destroyed) {
+      std::this_thread::yield();
+    }
+    // the thread terminates after the allocator, which has detached its magazine
+  });
+
+  while (not cached) {
+    std::this_thread::yield();
+  }
+  CHECK(allocator->stats().cachedBytes == 1024);
+  allocator.reset();
+  destroyed = true;
+  thread.join();
+}
+
+TEST_CASE("Test a thread using many caching allocators one after the other") {
+  auto& device = clue::DevicePool::deviceAt(0u);
+  auto& queue = clue::get_queue(device);
+
+  // the ids of the destroyed allocators are reused, and each new allocator gets a new magazine
+  // instead of the one left in the thread by the previous allocator with the same id
+  for (auto i = 0; i < 100; ++i) {
+    auto allocator = make_allocator(device);
+    auto* block = allocator->allocate(1024, queue);
+    CHECK(allocator->stats().misses == 1);
+    allocator->free(block);
+    CHECK(allocator->stats().cachedBytes == 1024);
+
+    block = allocator->allocate(1024, queue);
+    CHECK(allocator->stats().hits == 1);
+    allocator->free(block);
+  }
+}
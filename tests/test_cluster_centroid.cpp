@@ -53,3 +53,59 @@ TEST_CASE("Test computation of all cluster centroids") {
   auto clusters = get_clusters(h_points);
   CHECK(centroids.size() == clusters.size());
 }
+
+TEST_CASE("Test computation of the cluster statistics") {
+  auto device = clue::DevicePool::deviceAt(0u);
+  auto queue = clue::get_queue(device);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  auto dim = ::clue::Dim<2>{};
+  clue::PointsHost h_points = read_csv(dim, test_file_path);
+  const auto n_points = h_points.size();
+
+  clue::PointsDevice d_points{device, dim, n_points};
+
+  const float dc{21.f}, rhoc{10.f}, outlier{21.f};
+  clue::Clusterer algo(queue, dim, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points, d_points);
+
+  const auto centroids = cluster_centroids(h_points);
+  const auto statistics = clue::cluster_statistics(h_points);
+  REQUIRE(statistics.size() == centroids.size());
+  for (auto cluster = 0u; cluster < statistics.size(); ++cluster) {
+    const auto& cluster_statistics = statistics[cluster];
+    CHECK(cluster_statistics.weight == doctest::Approx(cluster_statistics.size));
+    for (auto d = 0u; d < 2; ++d) {
+      CHECK(cluster_statistics.centroid[d] == doctest::Approx(centroids[cluster][d]).epsilon(1e-4));
+      CHECK(cluster_statistics.min[d] <= cluster_statistics.centroid[d]);
+      CHECK(cluster_statistics.max[d] >= cluster_statistics.centroid[d]);
+      CHECK(cluster_statistics.cov(d, d) >= 0.f);
+    }
+  }
+
+  SUBCASE("Compute the statistics on device") {
+    const auto& clusters = algo.getClusters(queue, d_points);
+    auto d_statistics = clue::cluster_statistics(queue, d_points, clusters);
+    std::vector<clue::ClusterStatistics<2>> device_statistics(clusters.size());
+    alpaka::onHost::memcpy(
+        queue,
+        alpaka::makeView(alpaka::api::host,
+                         device_statistics.data(),
+                         clue::Vec1D{static_cast<uint32_t>(device_statistics.size())}),
+        alpaka::makeView(device,
+                         d_statistics.data(),
+                         clue::Vec1D{static_cast<uint32_t>(device_statistics.size())}));
+    alpaka::onHost::wait(queue);
+
+    REQUIRE(device_statistics.size() == statistics.size());
+    for (auto cluster = 0u; cluster < statistics.size(); ++cluster) {
+      CHECK(device_statistics[cluster].size == statistics[cluster].size);
+      for (auto d = 0u; d < 2; ++d) {
+        CHECK(device_statistics[cluster].centroid[d] ==
+              doctest::Approx(statistics[cluster].centroid[d]).epsilon(1e-4));
+        CHECK(device_statistics[cluster].min[d] == statistics[cluster].min[d]);
+        CHECK(device_statistics[cluster].max[d] == statistics[cluster].max[d]);
+      }
+    }
+  }
+}
@@ -2,9 +2,18 @@
 #include "CLUEstering/CLUEstering.hpp"
 #include "CLUEstering/utils/validation.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <numbers>
+#include <optional>
+#include <random>
 #include <ranges>
 #include <span>
+#include <string>
+#include <utility>
 #include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
@@ -42,6 +51,352 @@ TEST_CASE("Test make_cluster interfaces") {
 
     CHECK(clue::silhouette(h_points) >= 0.9f);
   }
+  SUBCASE("Clustering from device points matches clustering from host points") {
+    algo.make_clusters(queue, h_points);
+    const auto host_indexes = std::vector<int>(h_points.clusterIndexes().begin(),
+                                               h_points.clusterIndexes().end());
+
+    clue::copyToDevice(queue, d_points, h_points);
+    algo.make_clusters(queue, d_points);
+    clue::copyToHost(queue, h_points, d_points);
+
+    const auto scores = clue::external_scores(h_points.clusterIndexes(), host_indexes);
+    CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+  }
+  SUBCASE("The options of the tiles and of the spatial index don't change the clusters") {
+    algo.make_clusters(queue, h_points);
+    const auto reference = std::vector<int>(h_points.clusterIndexes().begin(),
+                                            h_points.clusterIndexes().end());
+
+    std::array<std::array<float, 2>, 2> bounds;
+    for (auto d = 0u; d < 2; ++d) {
+      const auto [min, max] = std::ranges::minmax(h_points.coords(d));
+      bounds[d] = {min, max};
+    }
+    using Clusterer = decltype(algo);
+    const std::vector<std::pair<std::string, std::function<void(Clusterer&)>>> options{
+        {"fixed domain", [&](Clusterer& clusterer) { clusterer.setDomain(bounds); }},
+        {"quantile boundaries",
+         [](Clusterer& clusterer) { clusterer.setTileBoundaries(clue::TileBoundaries::Quantile); }},
+        {"Morton order",
+         [](Clusterer& clusterer) { clusterer.setTileOrder(clue::TileOrder::Morton); }},
+        {"Hilbert order",
+         [](Clusterer& clusterer) { clusterer.setTileOrder(clue::TileOrder::Hilbert); }},
+        {"sparse tiles",
+         [](Clusterer& clusterer) {
+           clusterer.setSparseTiles(true);
+           clusterer.setTileOrder(clue::TileOrder::Hilbert);
+         }},
+        {"k-d tree",
+         [](Clusterer& clusterer) { clusterer.setSpatialIndex(clue::SpatialIndex::KdTree); }}};
+
+    for (const auto& [name, configure] : options) {
+      INFO("option: ", name);
+      Clusterer clusterer(queue, dim, dc, rhoc, outlier);
+      configure(clusterer);
+      // the second clustering reuses the buffers and the geometry of the first one
+      for (auto event = 0; event < 2; ++event) {
+        clusterer.make_clusters(queue, h_points);
+        const auto scores = clue::external_scores(h_points.clusterIndexes(), reference);
+        CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+      }
+
+      clue::copyToDevice(queue, d_points, h_points);
+      clusterer.make_clusters(queue, d_points);
+      clue::copyToHost(queue, h_points, d_points);
+      const auto scores = clue::external_scores(h_points.clusterIndexes(), reference);
+      CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+    }
+  }
+  SUBCASE("Run clustering with a fixed domain and number of tiles") {
+    std::array<std::array<float, 2>, 2> bounds;
+    for (auto d = 0u; d < 2; ++d) {
+      const auto [min, max] = std::ranges::minmax(h_points.coords(d));
+      bounds[d] = {min, max};
+    }
+    algo.setDomain(bounds, 16);
+    algo.make_clusters(queue, h_points);
+    CHECK(clue::silhouette(h_points) >= 0.9f);
+
+    CHECK_THROWS(algo.setDomain({{{1.f, 0.f}, {0.f, 1.f}}}));
+    CHECK_THROWS(algo.setDomain(bounds, 0));
+    algo.resetDomain();
+  }
+  SUBCASE("Store the data of the decision graph") {
+    algo.setDecisionGraph(true);
+    algo.make_clusters(queue, h_points);
+    REQUIRE(h_points.rho().size() == static_cast<std::size_t>(n_points));
+    REQUIRE(h_points.delta().size() == static_cast<std::size_t>(n_points));
+
+    const auto cluster_indexes = h_points.clusterIndexes();
+    const auto n_clusters = *std::ranges::max_element(cluster_indexes) + 1;
+    auto n_seeds = 0;
+    for (auto i = 0; i < n_points; ++i) {
+      n_seeds += (h_points.delta()[i] > dc && h_points.rho()[i] >= rhoc);
+    }
+    CHECK(n_seeds == n_clusters);
+
+    algo.setDecisionGraph(false);
+    algo.make_clusters(queue, h_points);
+    CHECK(h_points.rho().empty());
+    CHECK(h_points.delta().empty());
+  }
+  SUBCASE("The bitset of the seeds marks a seed for each cluster") {
+    clue::copyToDevice(queue, d_points, h_points);
+    algo.make_clusters(queue, d_points);
+    clue::copyToHost(queue, h_points, d_points);
+
+    auto d_seeds = d_points.isSeed();
+    std::vector<uint32_t> seeds(d_seeds.size());
+    alpaka::onHost::memcpy(
+        queue,
+        alpaka::makeView(alpaka::api::host, seeds.data(), clue::Vec1D{static_cast<uint32_t>(seeds.size())}),
+        alpaka::makeView(queue, d_seeds.data(), clue::Vec1D{static_cast<uint32_t>(d_seeds.size())}));
+    alpaka::onHost::wait(queue);
+
+    const auto cluster_indexes = h_points.clusterIndexes();
+    const auto n_clusters = *std::ranges::max_element(cluster_indexes) + 1;
+    std::vector<int> seed_of_cluster(n_clusters, 0);
+    auto n_seeds = 0;
+    for (auto i = 0; i < n_points; ++i) {
+      if ((seeds[i / 32] >> (i % 32)) & 1u) {
+        ++n_seeds;
+        ++seed_of_cluster[cluster_indexes[i]];
+      }
+    }
+    CHECK(n_seeds == n_clusters);
+    CHECK(std::ranges::all_of(seed_of_cluster, [](int count) { return count == 1; }));
+  }
+}
+
+TEST_CASE("Test the k-d tree spatial index against the tiles") {
+  auto device = clue::DevicePool::deviceAt(0U);
+  auto queue = clue::get_queue(device);
+
+  SUBCASE("Clustering of points with many dimensions") {
+    clue::Dim<10> dim{};
+    clue::PointsHost h_points =
+        clue::read_csv(dim, std::string(TEST_DATA_DIR) + "/data_dim_10.csv");
+    clue::PointsDevice d_points{device, dim, h_points.size()};
+
+    // with a single point in each leaf the tree is as deep as the dataset allows
+    for (auto points_per_leaf : {128, 1}) {
+      INFO("points per leaf: ", points_per_leaf);
+      clue::Clusterer algo(queue, dim, 3.f, 5.f, 3.f, points_per_leaf);
+      algo.make_clusters(queue, h_points);
+      const auto reference = std::vector<int>(h_points.clusterIndexes().begin(),
+                                              h_points.clusterIndexes().end());
+      REQUIRE(*std::ranges::max_element(reference) > 0);
+
+      algo.setSpatialIndex(clue::SpatialIndex::KdTree);
+      algo.make_clusters(queue, h_points);
+      auto scores = clue::external_scores(h_points.clusterIndexes(), reference);
+      CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+
+      clue::copyToDevice(queue, d_points, h_points);
+      algo.make_clusters(queue, d_points);
+      clue::copyToHost(queue, h_points, d_points);
+      scores = clue::external_scores(h_points.clusterIndexes(), reference);
+      CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+    }
+  }
+  SUBCASE("Clustering of points across the boundary of a periodic coordinate") {
+    clue::Dim<2> dim{};
+    clue::PointsHost h_points =
+        clue::read_csv(dim, std::string(TEST_DATA_DIR) + "/opposite_angles.csv");
+    clue::PointsDevice d_points{device, dim, h_points.size()};
+    const auto [min_angle, max_angle] = std::ranges::minmax(h_points.coords(1));
+    REQUIRE(min_angle < -3.f);
+    REQUIRE(max_angle > 3.f);
+    const auto metric = clue::metrics::PeriodicEuclidean<2>(
+        std::array<float, 2>{0.f, 2.f * std::numbers::pi_v<float>});
+
+    // small leaves, so that the tree splits the angles on both sides of the boundary
+    clue::Clusterer algo(queue, dim, .2f, 5.f, .2f, 4);
+    algo.setWrappedCoordinates(0, 1);
+    algo.make_clusters(queue, h_points, metric);
+    const auto reference = std::vector<int>(h_points.clusterIndexes().begin(),
+                                            h_points.clusterIndexes().end());
+
+    algo.setSpatialIndex(clue::SpatialIndex::KdTree);
+    algo.make_clusters(queue, h_points, metric);
+    CHECK(h_points.n_clusters() == 1);
+    auto scores = clue::external_scores(h_points.clusterIndexes(), reference);
+    CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+
+    clue::copyToDevice(queue, d_points, h_points);
+    algo.make_clusters(queue, d_points, metric);
+    clue::copyToHost(queue, h_points, d_points);
+    scores = clue::external_scores(h_points.clusterIndexes(), reference);
+    CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+  }
+}
+
+TEST_CASE("Test the tiles with a fixed domain") {
+  auto device = clue::DevicePool::deviceAt(0U);
+  auto queue = clue::get_queue(device);
+  using Device = clue::DevType<std::decay_t<decltype(queue)>>;
+
+  clue::Dim<2> dim{};
+  clue::PointsHost h_points = clue::read_csv(dim, std::string(TEST_DATA_DIR) + "/data_32768.csv");
+  const auto n_points = h_points.size();
+  clue::PointsDevice d_points{device, dim, n_points};
+  clue::copyToDevice(queue, d_points, h_points);
+
+  // the domain covers only the central part of the points, so it differs from their extremes
+  clue::internal::TilingOptions<2> options;
+  clue::internal::CoordinateExtremes<2> domain;
+  for (auto d = 0u; d < 2; ++d) {
+    const auto [min, max] = std::ranges::minmax(h_points.coords(d));
+    domain.min(d) = min + (max - min) / 4;
+    domain.max(d) = max - (max - min) / 4;
+  }
+  options.domain = domain;
+  options.n_per_dim = 16;
+  const std::array<uint8_t, 2> wrapped{};
+  clue::internal::Arena<Device> arena;
+
+  std::optional<clue::internal::Tiles<2, Device>> tiles;
+  clue::detail::setup_tiles(queue, tiles, d_points, 128, wrapped, options);
+  tiles->fill(queue, arena, d_points, n_points);
+  clue::internal::CoordinateExtremes<2> extremes;
+  std::array<float, 2> tile_sizes;
+  std::vector<int32_t> offsets(tiles->size() + 1);
+  const auto extent = clue::Vec1D{static_cast<uint32_t>(offsets.size())};
+  alpaka::onHost::memcpy(queue,
+                         alpaka::makeView(alpaka::api::host, &extremes, clue::Vec1D{1u}),
+                         alpaka::makeView(queue, tiles->m_minmax.data(), clue::Vec1D{1u}));
+  alpaka::onHost::memcpy(queue,
+                         alpaka::makeView(alpaka::api::host, tile_sizes.data(), clue::Vec1D{2u}),
+                         alpaka::makeView(queue, tiles->m_tilesizes.data(), clue::Vec1D{2u}));
+  alpaka::onHost::memcpy(queue,
+                         alpaka::makeView(alpaka::api::host, offsets.data(), extent),
+                         alpaka::makeView(queue, tiles->view().offsets, extent));
+  alpaka::onHost::wait(queue);
+  arena.reset();
+
+  CHECK(tiles->nPerDim() == 16);
+  for (auto d = 0u; d < 2; ++d) {
+    CHECK(extremes.min(d) == domain.min(d));
+    CHECK(extremes.max(d) == domain.max(d));
+    CHECK(tile_sizes[d] == doctest::Approx(domain.range(d) / 16));
+  }
+  // the points outside of the domain are assigned to the tiles on its border
+  CHECK(offsets.back() == n_points);
+  auto below_domain = 0;
+  for (auto i = 0; i < n_points; ++i) {
+    below_domain += h_points.coords(0)[i] < domain.min(0) && h_points.coords(1)[i] < domain.min(1);
+  }
+  REQUIRE(below_domain > 0);
+  CHECK(offsets[1] - offsets[0] >= below_domain);
+}
+
+TEST_CASE("Test the occupancy of the tiles with quantile boundaries") {
+  auto device = clue::DevicePool::deviceAt(0U);
+  auto queue = clue::get_queue(device);
+  using Device = clue::DevType<std::decay_t<decltype(queue)>>;
+
+  // the Cauchy distribution has heavy tails, so uniform tiles spanning the extremes
+  // of the coordinates put most of the points in the few tiles around the mode
+  constexpr int32_t n_points = 1 << 14;
+  clue::Dim<2> dim{};
+  clue::PointsHost h_points(dim, n_points);
+  std::mt19937 generator(42);
+  std::cauchy_distribution<float> cauchy(0.f, 1.f);
+  for (auto d = 0u; d < 2; ++d) {
+    for (auto& coord : h_points.coords(d)) {
+      coord = cauchy(generator);
+    }
+  }
+  std::ranges::fill(h_points.weights(), 1.f);
+  clue::PointsDevice d_points{device, dim, n_points};
+  clue::copyToDevice(queue, d_points, h_points);
+  const std::array<uint8_t, 2> wrapped{};
+  clue::internal::Arena<Device> arena;
+
+  auto max_occupancy = [&](clue::TileBoundaries boundaries) {
+    clue::internal::TilingOptions<2> options;
+    options.boundaries = boundaries;
+    std::optional<clue::internal::Tiles<2, Device>> tiles;
+    clue::detail::setup_tiles(queue, tiles, d_points, 128, wrapped, options);
+    tiles->fill(queue, arena, d_points, n_points);
+    std::vector<int32_t> offsets(tiles->size() + 1);
+    const auto extent = clue::Vec1D{static_cast<uint32_t>(offsets.size())};
+    alpaka::onHost::memcpy(queue,
+                           alpaka::makeView(alpaka::api::host, offsets.data(), extent),
+                           alpaka::makeView(queue, tiles->view().offsets, extent));
+    alpaka::onHost::wait(queue);
+    arena.reset();
+    REQUIRE(offsets.back() == n_points);
+
+    auto occupancy = 0;
+    for (auto tile = 0; tile < tiles->size(); ++tile) {
+      occupancy = std::max(occupancy, offsets[tile + 1] - offsets[tile]);
+    }
+    return std::make_pair(occupancy, tiles->size());
+  };
+
+  const auto [uniform, n_tiles] = max_occupancy(clue::TileBoundaries::Uniform);
+  const auto [quantile, quantile_tiles] = max_occupancy(clue::TileBoundaries::Quantile);
+  REQUIRE(quantile_tiles == n_tiles);
+  // with the quantile boundaries the densest tile holds a few times the average of the tiles
+  CHECK(quantile * 10 < uniform);
+  CHECK(quantile < 4 * n_points / n_tiles);
+}
+
+TEST_CASE("Test the sparse storage of the tiles") {
+  auto device = clue::DevicePool::deviceAt(0U);
+  auto queue = clue::get_queue(device);
+  using Device = clue::DevType<std::decay_t<decltype(queue)>>;
+
+  clue::Dim<3> dim{};
+  clue::PointsHost h_points = clue::read_csv(dim, std::string(TEST_DATA_DIR) + "/data_dim_3.csv");
+  const auto n_points = h_points.size();
+  clue::PointsDevice d_points{device, dim, n_points};
+  clue::copyToDevice(queue, d_points, h_points);
+
+  // the domain is three times as large as the points along each dimension,
+  // so that most of the tiles are empty
+  clue::internal::TilingOptions<3> options;
+  clue::internal::CoordinateExtremes<3> domain;
+  for (auto d = 0u; d < 3; ++d) {
+    const auto [min, max] = std::ranges::minmax(h_points.coords(d));
+    domain.min(d) = min - (max - min);
+    domain.max(d) = max + (max - min);
+  }
+  options.domain = domain;
+  options.n_per_dim = 16;
+  const std::array<uint8_t, 3> wrapped{};
+  clue::internal::Arena<Device> arena;
+
+  // the occupied tiles are counted from the offsets of the dense tiles
+  std::optional<clue::internal::Tiles<3, Device>> dense;
+  clue::detail::setup_tiles(queue, dense, d_points, 128, wrapped, options);
+  dense->fill(queue, arena, d_points, n_points);
+  const auto n_tiles = dense->size();
+  std::vector<int32_t> offsets(n_tiles + 1);
+  const auto extent = clue::Vec1D{static_cast<uint32_t>(offsets.size())};
+  alpaka::onHost::memcpy(queue,
+                         alpaka::makeView(alpaka::api::host, offsets.data(), extent),
+                         alpaka::makeView(queue, dense->view().offsets, extent));
+  alpaka::onHost::wait(queue);
+  arena.reset();
+  REQUIRE(offsets.back() == n_points);
+  auto occupied = 0;
+  for (auto tile = 0; tile < n_tiles; ++tile) {
+    occupied += offsets[tile + 1] > offsets[tile];
+  }
+
+  // only the occupied tiles are stored as keys of the sparse tiles
+  options.sparse = true;
+  std::optional<clue::internal::Tiles<3, Device>> sparse;
+  clue::detail::setup_tiles(queue, sparse, d_points, 128, wrapped, options);
+  sparse->fill(queue, arena, d_points, n_points);
+  alpaka::onHost::wait(queue);
+  arena.reset();
+  CHECK(sparse->size() == n_tiles);
+  CHECK(sparse->extents().keys == static_cast<std::size_t>(occupied));
+  CHECK(sparse->extents().keys < static_cast<std::size_t>(n_tiles));
 }
 
 TEST_CASE("Test Clusterer constructors with invalid parameters") {
@@ -52,3 +407,98 @@ TEST_CASE("Test Clusterer constructors with invalid parameters") {
     CHECK_THROWS(clue::Clusterer(queue,dim, 1.f, -10.f));
   }
 }
+
+TEST_CASE("Test the ordering of the tiles along space-filling curves") {
+  auto morton = [](const auto& cell, int32_t bits) {
+    return clue::internal::mortonKey<2>(cell, bits);
+  };
+  auto hilbert = [](const auto& cell, int32_t bits) {
+    return clue::internal::hilbertKey<2>(cell, bits);
+  };
+  auto is_permutation = [](const std::vector<int32_t>& ranks) {
+    auto sorted = ranks;
+    std::ranges::sort(sorted);
+    for (auto i = 0u; i < sorted.size(); ++i) {
+      if (sorted[i] != static_cast<int32_t>(i)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  SUBCASE("The ranks are a permutation of the tiles") {
+    for (auto n_per_dim : {1, 3, 5, 8, 13}) {
+      std::vector<int32_t> ranks(n_per_dim * n_per_dim);
+      clue::internal::curve_ranks<2>(n_per_dim, n_per_dim * n_per_dim, ranks.data(), morton);
+      CHECK(is_permutation(ranks));
+      clue::internal::curve_ranks<2>(n_per_dim, n_per_dim * n_per_dim, ranks.data(), hilbert);
+      CHECK(is_permutation(ranks));
+
+      std::vector<int32_t> ranks3d(n_per_dim * n_per_dim * n_per_dim);
+      clue::internal::curve_ranks<3>(
+          n_per_dim,
+          static_cast<int32_t>(ranks3d.size()),
+          ranks3d.data(),
+          [](const auto& cell, int32_t bits) { return clue::internal::hilbertKey<3>(cell, bits); });
+      CHECK(is_permutation(ranks3d));
+    }
+  }
+  SUBCASE("The ranks follow the curves on a power of two grid") {
+    constexpr int32_t n_per_dim = 8;
+    constexpr int32_t n_cells = n_per_dim * n_per_dim;
+    std::vector<int32_t> ranks(n_cells);
+    // cell with each rank along the curve, as (row, column)
+    std::vector<std::array<int32_t, 2>> cells(n_cells);
+
+    clue::internal::curve_ranks<2>(n_per_dim, n_cells, ranks.data(), morton);
+    for (auto i = 0; i < n_cells; ++i) {
+      cells[ranks[i]] = {i / n_per_dim, i % n_per_dim};
+    }
+    // the first quadrant of the Z-order curve
+    CHECK(cells[0] == std::array<int32_t, 2>{0, 0});
+    CHECK(cells[1] == std::array<int32_t, 2>{0, 1});
+    CHECK(cells[2] == std::array<int32_t, 2>{1, 0});
+    CHECK(cells[3] == std::array<int32_t, 2>{1, 1});
+
+    clue::internal::curve_ranks<2>(n_per_dim, n_cells, ranks.data(), hilbert);
+    for (auto i = 0; i < n_cells; ++i) {
+      cells[ranks[i]] = {i / n_per_dim, i % n_per_dim};
+    }
+    // consecutive cells along the Hilbert curve are neighbours when the grid is not padded
+    for (auto rank = 1; rank < n_cells; ++rank) {
+      const auto distance = std::abs(cells[rank][0] - cells[rank - 1][0]) +
+                            std::abs(cells[rank][1] - cells[rank - 1][1]);
+      CHECK(distance == 1);
+    }
+    CHECK(cells.front() == std::array<int32_t, 2>{0, 0});
+  }
+  SUBCASE("The tiles store the ranks along the curve on the device") {
+    auto device = clue::DevicePool::deviceAt(0U);
+    auto queue = clue::get_queue(device);
+    using Device = clue::DevType<std::decay_t<decltype(queue)>>;
+    constexpr int32_t n_per_dim = 6;
+    constexpr int32_t n_cells = n_per_dim * n_per_dim;
+
+    clue::internal::Tiles<2, Device> tiles(queue, 1, n_cells);
+    tiles.reset(1, n_cells, n_per_dim);
+    std::vector<int32_t> expected(n_cells);
+    std::vector<int32_t> ranks(n_cells);
+    const auto extent = clue::Vec1D{static_cast<uint32_t>(n_cells)};
+    for (auto order : {clue::TileOrder::Morton, clue::TileOrder::Hilbert}) {
+      if (order == clue::TileOrder::Morton) {
+        clue::internal::curve_ranks<2>(n_per_dim, n_cells, expected.data(), morton);
+      } else {
+        clue::internal::curve_ranks<2>(n_per_dim, n_cells, expected.data(), hilbert);
+      }
+      tiles.setOrder(queue, order);
+      REQUIRE(tiles.view().order != nullptr);
+      alpaka::onHost::memcpy(queue,
+                             alpaka::makeView(alpaka::api::host, ranks.data(), extent),
+                             alpaka::makeView(queue, tiles.view().order, extent));
+      alpaka::onHost::wait(queue);
+      CHECK(ranks == expected);
+    }
+    tiles.setOrder(queue, clue::TileOrder::RowMajor);
+    CHECK(tiles.view().order == nullptr);
+  }
+}
@@ -118,3 +118,20 @@ def test_clusterer_properties(dataset, backend):
         assert cluster_size == len(cluster_points[i])
     output_df = c.output_df
     assert output_df.shape == (999, 1)
+    assert c.rho is None
+    assert c.delta is None
+
+def test_decision_graph(dataset, backend):
+    '''
+    Test the data of the decision graph
+    '''
+    c = clue.clusterer(21., 10., 21.)
+    c.read_data(dataset)
+    c.run_clue(backend=backend, decision_graph=True)
+
+    assert c.rho.shape == (999,)
+    assert c.delta.shape == (999,)
+    assert (c.rho > 0.).all()
+    # the seeds are the points far from their nearest higher and with enough density
+    seeds = (c.delta > 21.) & (c.rho >= 10.)
+    assert np.count_nonzero(seeds) == c.n_clusters
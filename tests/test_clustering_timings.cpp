@@ -0,0 +1,71 @@
+#define CLUE_ENABLE_TIMING
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <chrono>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+TEST_CASE("Test the sum of the timings of the clusterings") {
+  using namespace std::chrono_literals;
+  clue::ClusteringTimings first;
+  first.localDensity = 3ms;
+  first.copyToHost = 1ms;
+  first.clusterings = 1;
+  clue::ClusteringTimings second;
+  second.localDensity = 2ms;
+  second.seeds = 4ms;
+  second.clusterings = 1;
+
+  const auto sum = first + second;
+  CHECK(sum.localDensity == 5ms);
+  CHECK(sum.seeds == 4ms);
+  CHECK(sum.copyToHost == 1ms);
+  CHECK(sum.total() == 10ms);
+  CHECK(sum.clusterings == 2);
+}
+
+TEST_CASE("Test the timings of the stages of the clustering") {
+  auto device = clue::DevicePool::deviceAt(0U);
+  auto queue = clue::get_queue(device);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  clue::Dim<2> dim{};
+  clue::PointsHost h_points = clue::read_csv(dim, test_file_path);
+  clue::PointsDevice d_points{device, dim, h_points.size()};
+
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer algo(queue, dim, dc, rhoc, outlier);
+  CHECK(algo.timings().clusterings == 0);
+
+  SUBCASE("Timings of a clustering from host points") {
+    algo.make_clusters(queue, h_points);
+    const auto& timings = algo.timings();
+    CHECK(timings.clusterings == 1);
+    CHECK(timings.localDensity.count() > 0);
+    CHECK(timings.nearestHighers.count() > 0);
+    CHECK(timings.copyToDevice.count() > 0);
+    CHECK(timings.copyToHost.count() > 0);
+    CHECK(timings.total() >= timings.localDensity + timings.nearestHighers);
+  }
+  SUBCASE("Timings summed over several clusterings") {
+    algo.make_clusters(queue, h_points);
+    const auto first = algo.timings();
+    clue::copyToDevice(queue, d_points, h_points);
+    algo.make_clusters(queue, d_points);
+    const auto second = algo.timings();
+    // the points are already on the device
+    CHECK(second.copyToDevice.count() == 0);
+    CHECK(second.copyToHost.count() == 0);
+
+    const auto& total = algo.totalTimings();
+    CHECK(total.clusterings == 2);
+    CHECK(total.total() == first.total() + second.total());
+
+    algo.resetTimings();
+    CHECK(algo.totalTimings().clusterings == 0);
+    CHECK(algo.totalTimings().total().count() == 0);
+    CHECK(algo.timings().clusterings == 1);
+  }
+}
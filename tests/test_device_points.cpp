@@ -1,6 +1,7 @@
 
 #include "CLUEstering/CLUEstering.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <ranges>
 #include <span>
@@ -35,15 +36,22 @@ ALPAKA_FN_HOST bool compareDevicePoints(T_Queue &queue,
                                         TRange&& h_weights,
                                         clue::PointsDevice<T_Dev,Ndim>& d_points,
                                         uint32_t size) {
+  // the columns of the points are padded, so the input is first gathered contiguously
+  std::vector<float> h_input((Ndim + 1) * size);
+  std::ranges::copy(h_coords, h_input.begin());
+  std::ranges::copy(h_weights, h_input.begin() + Ndim * size);
+
   auto h_points = clue::PointsHost(clue::Dim<Ndim>{},size);
-  std::ranges::copy(h_coords, h_points.coords(0).begin());
+  for (auto dim = 0u; dim < Ndim; ++dim) {
+    std::copy_n(h_input.begin() + dim * size, size, h_points.coords(dim).begin());
+  }
   std::ranges::copy(h_weights, h_points.weights().begin());
   clue::copyToDevice(queue, d_points, h_points);
 
   // define buffers for comparison
   auto d_input = clue::make_device_buffer<float>(queue, (Ndim + 1) * size);
   alpaka::onHost::memcpy(
-      queue, d_input, alpaka::makeView(alpaka::api::host,h_points.coords(0).data(), clue::Vec1D{(Ndim + 1) * size}));
+      queue, d_input, alpaka::makeView(alpaka::api::host,h_input.data(), clue::Vec1D{(Ndim + 1) * size}));
 
   auto d_comparison_result = clue::make_device_buffer<int>(queue,clue::Vec1D{1u});
   const auto blocksize = 512u;
@@ -1,6 +1,12 @@
 
 #include "CLUEstering/CLUEstering.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
 #include <numeric>
 #include <ranges>
 #include <span>
@@ -395,7 +401,8 @@ TEST_CASE("Test point accessor") {
   const uint32_t size = 1000;
   auto dim = clue::Dim<2>{};
   clue::PointsHost points(dim, size);
-  std::iota(points.coords(0).begin(), points.coords(1).end(), 0.f);
+  std::iota(points.coords(0).begin(), points.coords(0).end(), 0.f);
+  std::iota(points.coords(1).begin(), points.coords(1).end(), 1000.f);
   std::fill(points.weights().begin(), points.weights().end(), 1.f);
 
   SUBCASE("Test point methods") {
@@ -411,6 +418,50 @@ TEST_CASE("Test point accessor") {
   }
 }
 
+TEST_CASE("Test alignment of the columns of the points") {
+  // a number of points which is not a multiple of the padding
+  const uint32_t size = 1001;
+  auto dim = clue::Dim<3>{};
+  std::vector<std::byte> buffer(clue::soa::host::computeSoASize(dim, size));
+  clue::PointsHost points(dim, size, std::span(buffer.data(), buffer.size()));
+  auto view = points.view();
+
+  const auto stride = clue::computeAlignSoASize(size);
+  CHECK(stride >= static_cast<int32_t>(size));
+  CHECK(stride * sizeof(float) % clue::soa_alignment == 0);
+  auto offset = [&](const void* column) {
+    return static_cast<const std::byte*>(column) - buffer.data();
+  };
+  for (auto d = 0u; d < 3; ++d) {
+    CHECK(offset(view.coords[d]) % clue::soa_alignment == 0);
+  }
+  CHECK(offset(view.weight) % clue::soa_alignment == 0);
+  CHECK(offset(view.cluster_index) % clue::soa_alignment == 0);
+  CHECK(offset(view.cluster_index) + size * sizeof(int) <= buffer.size());
+}
+
+TEST_CASE("Test the first touch of the columns of the points") {
+  SUBCASE("Small and large structures are zeroed") {
+    // below and above the size touched by the workers of the host backends
+    for (const std::size_t n_elements : {std::size_t{100}, std::size_t{1} << 20}) {
+      std::vector<float> columns(3 * n_elements, 1.f);
+      clue::internal::first_touch_host_columns(columns.data(), n_elements, 3);
+      CHECK(std::ranges::all_of(columns, [](float value) { return value == 0.f; }));
+    }
+  }
+  SUBCASE("The columns of large points are zeroed") {
+    const int32_t size = 1 << 20;
+    auto dim = clue::Dim<2>{};
+    clue::PointsHost points(dim, size);
+    auto view = points.view();
+    auto is_zero = [](auto value) { return value == 0; };
+    CHECK(std::all_of(view.coords[0], view.coords[0] + size, is_zero));
+    CHECK(std::all_of(view.coords[1], view.coords[1] + size, is_zero));
+    CHECK(std::all_of(view.weight, view.weight + size, is_zero));
+    CHECK(std::all_of(view.cluster_index, view.cluster_index + size, is_zero));
+  }
+}
+
 TEST_CASE("Test constructor throwing conditions") {
   auto dim = clue::Dim<2>{};
   CHECK_THROWS(clue::PointsHost(dim,0));
@@ -462,3 +513,65 @@ TEST_CASE("Test cluster properties accessors") {
     CHECK(cached_cluster_sizes.size() == cluster_sizes.size());
   }
 }
+
+TEST_CASE("Test host points backed by a binary file") {
+  auto queue = clue::get_queue(0u);
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  const auto binary_file_path =
+      (std::filesystem::temp_directory_path() / "clue_test_host_points.bin").string();
+  auto dim = clue::Dim<2>{};
+  clue::PointsHost h_points = clue::read_csv(dim, test_file_path);
+
+  SUBCASE("Unclustered points") {
+    clue::write_binary(h_points, binary_file_path);
+    clue::PointsHost<2> mapped_points(dim, std::filesystem::path{binary_file_path});
+    CHECK(mapped_points.size() == h_points.size());
+    CHECK(!mapped_points.clustered());
+    CHECK(std::ranges::equal(mapped_points.coords(0), h_points.coords(0)));
+    CHECK(std::ranges::equal(mapped_points.coords(1), h_points.coords(1)));
+    CHECK(std::ranges::equal(mapped_points.weights(), h_points.weights()));
+
+    // the mapped points can be clustered without modifying the file
+    const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+    clue::Clusterer algo(queue, dim, dc, rhoc, outlier);
+    algo.make_clusters(queue, mapped_points);
+    CHECK(mapped_points.clustered());
+    CHECK(!clue::read_binary(dim, binary_file_path).clustered());
+  }
+  SUBCASE("Clustered points") {
+    const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+    clue::Clusterer algo(queue, dim, dc, rhoc, outlier);
+    algo.make_clusters(queue, h_points);
+    clue::write_binary(h_points, binary_file_path);
+
+    auto mapped_points = clue::read_binary(dim, binary_file_path);
+    CHECK(mapped_points.clustered());
+    CHECK(std::ranges::equal(mapped_points.coords(0), h_points.coords(0)));
+    CHECK(std::ranges::equal(mapped_points.clusterIndexes(), h_points.clusterIndexes()));
+  }
+  SUBCASE("Wrong number of dimensions") {
+    clue::write_binary(h_points, binary_file_path);
+    CHECK_THROWS_AS(clue::read_binary(clue::Dim<3>{}, binary_file_path), std::invalid_argument);
+  }
+  SUBCASE("Corrupted header") {
+    clue::write_binary(h_points, binary_file_path);
+    // overwrite a field of the header, or of the descriptor of the first column
+    auto corrupt = [&](std::streamoff position, uint64_t value) {
+      std::fstream file(binary_file_path, std::ios::in | std::ios::out | std::ios::binary);
+      file.seekp(position);
+      file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    constexpr std::streamoff n_points_position = 16;
+    constexpr std::streamoff first_offset_position = 32 + 8;
+
+    // the size of the columns overflows to zero
+    corrupt(n_points_position, uint64_t{1} << 62);
+    CHECK_THROWS_AS(clue::read_binary(dim, binary_file_path), std::runtime_error);
+    corrupt(n_points_position, static_cast<uint64_t>(h_points.size()));
+    CHECK(clue::read_binary(dim, binary_file_path).size() == h_points.size());
+    // the end of the first column overflows to the beginning of the file
+    corrupt(first_offset_position, std::numeric_limits<uint64_t>::max() - 3);
+    CHECK_THROWS_AS(clue::read_binary(dim, binary_file_path), std::runtime_error);
+  }
+  std::filesystem::remove(binary_file_path);
+}
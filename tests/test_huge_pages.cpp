@@ -0,0 +1,74 @@
+#include "CLUEstering/CLUEstering.hpp"
+#include "CLUEstering/internal/alpaka/caching_allocator/cached_buf_alloc.hpp"
+#include "CLUEstering/internal/nostd/huge_pages.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+TEST_CASE("Test the range of the huge pages advised for a buffer") {
+  constexpr auto page = clue::nostd::huge_page_bytes;
+  constexpr std::uintptr_t aligned = 64 * page;
+
+  SUBCASE("Buffer starting at the beginning of a huge page") {
+    const auto range = clue::nostd::huge_page_range(aligned, 3 * page);
+    CHECK(range.begin == aligned);
+    CHECK(range.end == aligned + 3 * page);
+
+    // the last huge page is only partially covered, so it keeps the base pages
+    const auto partial = clue::nostd::huge_page_range(aligned, 3 * page + page / 2);
+    CHECK(partial.begin == aligned);
+    CHECK(partial.end == aligned + 3 * page);
+  }
+  SUBCASE("Buffer with an unaligned start") {
+    const auto range = clue::nostd::huge_page_range(aligned + 100, 3 * page);
+    CHECK(range.begin == aligned + page);
+    CHECK(range.end == aligned + 3 * page);
+    CHECK(range.begin % page == 0);
+    CHECK(range.end % page == 0);
+  }
+  SUBCASE("Buffer smaller than a huge page") {
+    CHECK(clue::nostd::huge_page_range(aligned, page / 2).empty());
+    CHECK(clue::nostd::huge_page_range(aligned + 100, page - 100).empty());
+    // a buffer as large as a huge page but straddling two of them contains none
+    CHECK(clue::nostd::huge_page_range(aligned + page - 10, page).empty());
+    CHECK_FALSE(clue::nostd::huge_page_range(aligned, page).empty());
+
+    char buffer[64];
+    CHECK_FALSE(clue::nostd::advise_huge_pages(buffer, sizeof(buffer)));
+  }
+}
+
+TEST_CASE("Test the choice of the host buffers backed by huge pages") {
+  constexpr auto page = clue::nostd::huge_page_bytes;
+
+  SUBCASE("Threshold set in the configuration") {
+    clue::AllocatorConfig config;
+    // huge pages are disabled by default
+    CHECK_FALSE(clue::detail::use_huge_pages(64 * page, config));
+
+    config.hugePageThreshold = 4 * page;
+    CHECK_FALSE(clue::detail::use_huge_pages(4 * page - 1, config));
+    CHECK(clue::detail::use_huge_pages(4 * page, config));
+
+    // buffers smaller than a huge page can't use them, whatever the threshold
+    config.hugePageThreshold = 1024;
+    CHECK_FALSE(clue::detail::use_huge_pages(page - 1, config));
+    CHECK(clue::detail::use_huge_pages(page, config));
+  }
+  SUBCASE("Threshold set through the environment") {
+    ::setenv("CLUE_ALLOCATOR_HUGE_PAGE_THRESHOLD", "8388608", 1);
+    const auto config = clue::detail::allocator_config_from_env();
+    CHECK(config.hugePageThreshold == 4 * page);
+    CHECK_FALSE(clue::detail::use_huge_pages(2 * page, config));
+    CHECK(clue::detail::use_huge_pages(4 * page, config));
+
+    ::setenv("CLUE_ALLOCATOR_HUGE_PAGE_THRESHOLD", "2MB", 1);
+    CHECK_THROWS_AS(clue::detail::allocator_config_from_env(), std::invalid_argument);
+    ::unsetenv("CLUE_ALLOCATOR_HUGE_PAGE_THRESHOLD");
+  }
+}
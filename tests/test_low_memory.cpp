@@ -0,0 +1,106 @@
+// the nearest highers share the column of the cluster indexes
+#define CLUE_LOW_MEMORY
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+namespace {
+
+  // Serial clustering of the points comparing all the pairs, following the definitions used
+  // by the kernels with the flat kernel: the result of the default mode, which doesn't depend
+  // on the layout of the device points
+  std::vector<int> reference_clustering(
+      const clue::PointsHost<2>& points, float dc, float rhoc, float dm, float flat) {
+    const auto n = points.size();
+    const auto x = points.coords(0);
+    const auto y = points.coords(1);
+    const auto weights = points.weights();
+    auto distance = [&](int i, int j) {
+      return std::sqrt((x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]));
+    };
+
+    std::vector<float> rho(n, 0.f);
+    for (auto i = 0; i < n; ++i) {
+      for (auto j = 0; j < n; ++j) {
+        if (distance(i, j) <= dc) {
+          rho[i] += (i == j ? 1.f : flat) * weights[j];
+        }
+      }
+    }
+
+    std::vector<int> nearest_higher(n, -1);
+    for (auto i = 0; i < n; ++i) {
+      auto delta = std::numeric_limits<float>::max();
+      for (auto j = 0; j < n; ++j) {
+        const bool higher = rho[j] > rho[i] || (rho[j] == rho[i] && rho[j] > 0.f && j > i);
+        const auto d = distance(i, j);
+        if (higher && d <= dm && d < delta) {
+          delta = d;
+          nearest_higher[i] = j;
+        }
+      }
+    }
+
+    // the points without a nearest higher are seeds if they are dense enough, and outliers
+    // otherwise, together with all their followers
+    std::vector<int> cluster_indexes(n, -1);
+    std::vector<std::vector<int>> followers(n);
+    std::vector<int> seeds;
+    for (auto i = 0; i < n; ++i) {
+      if (nearest_higher[i] == -1) {
+        if (rho[i] >= rhoc) {
+          seeds.push_back(i);
+        }
+      } else {
+        followers[nearest_higher[i]].push_back(i);
+      }
+    }
+    for (auto cluster = 0u; cluster < seeds.size(); ++cluster) {
+      std::vector<int> stack{seeds[cluster]};
+      while (!stack.empty()) {
+        const auto point = stack.back();
+        stack.pop_back();
+        cluster_indexes[point] = static_cast<int>(cluster);
+        stack.insert(stack.end(), followers[point].begin(), followers[point].end());
+      }
+    }
+    return cluster_indexes;
+  }
+
+}  // namespace
+
+TEST_CASE("Test the clustering storing the nearest highers in the cluster indexes") {
+  auto device = clue::DevicePool::deviceAt(0u);
+  auto queue = clue::get_queue(device);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_4096.csv";
+  clue::Dim<2> dim{};
+  clue::PointsHost h_points = clue::read_csv(dim, test_file_path);
+  clue::PointsDevice d_points(device, dim, h_points.size());
+  // the device points have no separate column for the nearest highers
+  CHECK(d_points.view().nearest_higher == d_points.view().cluster_index);
+
+  const float dc{1.5f}, rhoc{10.f}, outlier{1.5f};
+  clue::Clusterer algo(queue, dim, dc, rhoc, outlier);
+  const auto reference = reference_clustering(h_points, dc, rhoc, outlier, .5f);
+
+  SUBCASE("Clustering of host points") {
+    algo.make_clusters(queue, h_points);
+    const auto scores = clue::external_scores(h_points.clusterIndexes(), reference);
+    CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+  }
+  SUBCASE("Clustering of device points") {
+    clue::copyToDevice(queue, d_points, h_points);
+    algo.make_clusters(queue, d_points);
+    clue::copyToHost(queue, h_points, d_points);
+    const auto scores = clue::external_scores(h_points.clusterIndexes(), reference);
+    CHECK(scores.adjusted_rand_index == doctest::Approx(1.f));
+  }
+}
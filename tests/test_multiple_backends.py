@@ -129,6 +129,46 @@ def test_toydet_clustering(toy_det):
         assert silhouette_score(c.coords.T[mask], c.cluster_ids[mask]) > 0.8
 
 
+def test_automatic_backend_selection(blobs):
+    '''
+    Checks that the automatic selection follows the crossover table and
+    that the clustering runs with the selected backend
+    '''
+
+    assert clue.select_backend(1) in clue.backends
+    for backend in clue.backends:
+        threshold = clue.backend_crossover[backend]
+        if threshold is not None:
+            assert clue.select_backend(threshold + 1) in clue.backends
+
+    c = clue.clusterer(1., 5, 2.)
+    c.read_data(blobs)
+    c.run_clue(backend="auto")
+
+    mask = c.cluster_ids != -1
+    assert silhouette_score(c.coords.T[mask], c.cluster_ids[mask]) > 0.8
+
+
+def test_backend_calibration():
+    '''
+    Checks that the calibration assigns to every backend either a size
+    or None, when the backend is never the fastest one
+    '''
+
+    defaults = dict(clue.backend_crossover)
+    try:
+        sizes = [500, 2_000]
+        timings = clue.calibrate_backends(sizes=sizes, repeats=1)
+        assert set(timings) == set(sizes)
+        for backend in clue.backends:
+            threshold = clue.backend_crossover[backend]
+            assert threshold is None or threshold in sizes + [0]
+        assert any(clue.backend_crossover[backend] is not None for backend in clue.backends)
+        assert clue.select_backend(1) in clue.backends
+    finally:
+        clue.backend_crossover.update(defaults)
+
+
 if __name__ == "__main__":
     c = clue.clusterer(1., 5, 2.)
     c.read_data("../data/blob.csv")
@@ -1,9 +1,18 @@
 
 #include "CLUEstering/CLUEstering.hpp"
+#include "CLUEstering/internal/alpaka/caching_allocator/caching_allocator.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <ranges>
 #include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
@@ -55,8 +64,78 @@ TEST_CASE("Test clue::get_queue utility") {
     auto d_points1 = clue::PointsDevice(device,dim, points1.size());
     CHECK(1);
   }
+
+  SUBCASE("Each thread gets its own queue") {
+    auto device = clue::DevicePool::deviceAt(0u);
+
+    auto& queue = clue::get_queue(device);
+    CHECK(&queue == &clue::get_queue(device));
+    CHECK(&queue == &clue::get_queue(0u));
+
+    const auto* other_thread_queue = &queue;
+    std::thread worker([&] {
+      auto& worker_queue = clue::get_queue(device);
+      CHECK(worker_queue.getDevice() == device);
+      other_thread_queue = &worker_queue;
+    });
+    worker.join();
+    CHECK(other_thread_queue != &queue);
+  }
 }
 
+namespace {
+
+  // Check that each cluster of a map contains exactly the points with its cluster index
+  void check_cluster_members(std::span<const int32_t> offsets,
+                             std::span<const int32_t> indexes,
+                             std::span<const int> cluster_indexes) {
+    const auto n_clusters = offsets.size() - 1;
+    std::vector<std::vector<int32_t>> expected(n_clusters);
+    for (auto i = 0u; i < cluster_indexes.size(); ++i) {
+      if (cluster_indexes[i] > -1) {
+        REQUIRE(static_cast<std::size_t>(cluster_indexes[i]) < n_clusters);
+        expected[cluster_indexes[i]].push_back(static_cast<int32_t>(i));
+      }
+    }
+    for (auto cluster = 0u; cluster < n_clusters; ++cluster) {
+      std::vector<int32_t> members(indexes.begin() + offsets[cluster],
+                                   indexes.begin() + offsets[cluster + 1]);
+      std::ranges::sort(members);
+      CHECK(members == expected[cluster]);
+    }
+  }
+
+  // Copy the offsets and indexes of a device map to the host and check its clusters
+  template <typename TQueue, typename TMap>
+  void check_device_cluster_members(TQueue& queue,
+                                    const TMap& clusters,
+                                    std::span<const int> cluster_indexes) {
+    const auto extents = clusters.extents();
+    const auto containers = clusters.extract();
+    std::vector<int32_t> offsets(extents.keys + 1);
+    std::vector<int32_t> indexes(extents.values);
+    alpaka::onHost::memcpy(
+        queue,
+        alpaka::makeView(alpaka::api::host,
+                         offsets.data(),
+                         clue::Vec1D{static_cast<uint32_t>(offsets.size())}),
+        alpaka::makeView(queue.getDevice(),
+                         containers.keys.data(),
+                         clue::Vec1D{static_cast<uint32_t>(offsets.size())}));
+    alpaka::onHost::memcpy(
+        queue,
+        alpaka::makeView(alpaka::api::host,
+                         indexes.data(),
+                         clue::Vec1D{static_cast<uint32_t>(indexes.size())}),
+        alpaka::makeView(queue.getDevice(),
+                         containers.values.data(),
+                         clue::Vec1D{static_cast<uint32_t>(indexes.size())}));
+    alpaka::onHost::wait(queue);
+    check_cluster_members(offsets, std::span{indexes}.first(offsets.back()), cluster_indexes);
+  }
+
+}  // namespace
+
 TEST_CASE("Test get_clusters host function") {
   auto device = clue::DevicePool::deviceAt(0u);
   auto queue=device.makeQueue();
@@ -72,6 +151,14 @@ TEST_CASE("Test get_clusters host function") {
   clue::Clusterer algo(queue,dim, dc, rhoc, outlier);
   algo.make_clusters(queue, h_points, d_points);
   auto clusters = get_clusters(h_points);
+
+  const auto containers = clusters.extract();
+  const auto n_clusters = clusters.size();
+  CHECK(n_clusters == h_points.n_clusters());
+  check_cluster_members(std::span<const int32_t>{containers.keys.data(), n_clusters + 1},
+                        std::span<const int32_t>{containers.values.data(),
+                                                 static_cast<std::size_t>(containers.keys[n_clusters])},
+                        h_points.clusterIndexes());
 }
 
 TEST_CASE("Test get_clusters device function") {
@@ -89,4 +176,159 @@ TEST_CASE("Test get_clusters device function") {
   clue::Clusterer algo(queue,dim, dc, rhoc, outlier);
   algo.make_clusters(queue, h_points, d_points);
   auto clusters = clue::get_clusters(queue, d_points);
+
+  const auto host_clusters = clue::get_clusters(h_points);
+  const auto& device_clusters = algo.getClusters(queue, d_points);
+  alpaka::onHost::wait(queue);
+  CHECK(device_clusters.size() == host_clusters.size());
+  CHECK(clusters.size() == host_clusters.size());
+
+  // the clusters contain the same points as the cluster indexes
+  check_device_cluster_members(queue, device_clusters, h_points.clusterIndexes());
+  check_device_cluster_members(queue, clusters, h_points.clusterIndexes());
+}
+
+TEST_CASE("Test reading points from CSV files") {
+  auto dim = ::clue::Dim<2>{};
+
+  SUBCASE("Read input file") {
+    const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+    clue::PointsHost h_points = clue::read_csv(dim, test_file_path);
+    CHECK(h_points.size() == 32768);
+    CHECK(h_points.coords(0)[0] == doctest::Approx(8.87491503783483f));
+    CHECK(h_points.coords(1)[0] == doctest::Approx(41.05707680625997f));
+    CHECK(std::ranges::all_of(h_points.weights(), [](auto weight) { return weight == 1.f; }));
+  }
+
+  SUBCASE("Read output file") {
+    const auto test_file_path = std::string(TEST_DATA_DIR) + "/truth_files/data_1024_truth.csv";
+    clue::PointsHost h_points = clue::read_output(dim, test_file_path);
+    CHECK(h_points.size() == 1024);
+    CHECK(h_points.clustered());
+    CHECK(h_points.coords(0)[1] == doctest::Approx(9.414788f));
+    CHECK(h_points.clusterIndexes()[1] == 0);
+    CHECK(std::ranges::all_of(h_points.clusterIndexes(), [](auto index) { return index >= -1; }));
+  }
+
+  SUBCASE("Missing columns") {
+    const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+    CHECK_THROWS_AS(clue::read_csv(::clue::Dim<3>{}, test_file_path), std::invalid_argument);
+  }
+}
+
+TEST_CASE("Test writing the clustering output") {
+  auto queue = clue::get_queue(0u);
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  const auto output_file_path =
+      (std::filesystem::temp_directory_path() / "clue_test_output.csv").string();
+  auto dim = ::clue::Dim<2>{};
+  clue::PointsHost h_points = clue::read_csv(dim, test_file_path);
+
+  CHECK_THROWS_AS(clue::write_output(h_points, output_file_path), std::invalid_argument);
+
+  const float dc{1.5f}, rhoc{10.f}, outlier{1.5f};
+  clue::Clusterer algo(queue, dim, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points);
+
+  SUBCASE("Write coordinates, weights and cluster indexes") {
+    clue::write_output(h_points, output_file_path);
+    auto read_points = clue::read_output(dim, output_file_path);
+    CHECK(read_points.size() == h_points.size());
+    CHECK(std::ranges::equal(read_points.coords(0), h_points.coords(0)));
+    CHECK(std::ranges::equal(read_points.coords(1), h_points.coords(1)));
+    CHECK(std::ranges::equal(read_points.weights(), h_points.weights()));
+    CHECK(std::ranges::equal(read_points.clusterIndexes(), h_points.clusterIndexes()));
+  }
+  SUBCASE("Write optional columns") {
+    // the bitset of the seeds, with the points 0, 33 and 34 marked as seeds
+    std::vector<uint32_t> is_seed((h_points.size() + 31) / 32, 0u);
+    is_seed[0] = 1u;
+    is_seed[1] = 0b110u;
+    clue::write_output(h_points, output_file_path, {.is_seed = is_seed});
+    std::ifstream file(output_file_path);
+    std::string line;
+    std::getline(file, line);
+    CHECK(line == "x0,x1,weight,cluster_ids,is_seed");
+    std::vector<char> seeds;
+    while (std::getline(file, line)) {
+      seeds.push_back(line.back());
+    }
+    REQUIRE(seeds.size() == static_cast<std::size_t>(h_points.size()));
+    CHECK(seeds[0] == '1');
+    CHECK(seeds[33] == '1');
+    CHECK(seeds[34] == '1');
+    CHECK(std::ranges::count(seeds, '1') == 3);
+
+    std::vector<uint32_t> wrong_size(10, 0u);
+    CHECK_THROWS_AS(clue::write_output(h_points, output_file_path, {.is_seed = wrong_size}),
+                    std::invalid_argument);
+  }
+  std::filesystem::remove(output_file_path);
+}
+
+TEST_CASE("Test the configuration and statistics of the caching allocator") {
+  SUBCASE("Invalid configurations are rejected") {
+    auto config = clue::getAllocatorConfig();
+    config.binGrowth = 1;
+    CHECK_THROWS_AS(clue::setAllocatorConfig(config), std::invalid_argument);
+    config = clue::getAllocatorConfig();
+    config.minBin = config.maxBin + 1;
+    CHECK_THROWS_AS(clue::setAllocatorConfig(config), std::invalid_argument);
+    config = clue::getAllocatorConfig();
+    config.maxCachedFraction = 2.;
+    CHECK_THROWS_AS(clue::setAllocatorConfig(config), std::invalid_argument);
+  }
+
+  SUBCASE("The statistics follow the allocations") {
+    // the allocator is constructed directly, because the host buffers don't use the
+    // caching allocators of the devices
+    auto device = clue::DevicePool::deviceAt(0u);
+    auto& queue = clue::get_queue(device);
+    using Allocator = clue::CachingAllocator<std::decay_t<decltype(device)>,
+                                             std::decay_t<decltype(queue)>>;
+    const auto config = clue::getAllocatorConfig();
+    Allocator allocator(device,
+                        queue,
+                        config.binGrowth,
+                        config.minBin,
+                        config.maxBin,
+                        config.maxCachedBytes,
+                        config.maxCachedFraction,
+                        true,
+                        false);
+    const auto bin_bytes = std::size_t{1} << config.minBin;
+    const auto requested = bin_bytes - 24;
+
+    auto* block = allocator.allocate(requested, queue);
+    auto stats = allocator.stats();
+    CHECK(stats.misses == 1);
+    CHECK(stats.hits == 0);
+    CHECK(stats.liveBlocks == 1);
+    CHECK(stats.liveBytes == bin_bytes);
+    CHECK(stats.requestedBytes == requested);
+    CHECK(stats.fragmentation() == doctest::Approx(24. / bin_bytes));
+
+    allocator.free(block);
+    stats = allocator.stats();
+    CHECK(stats.liveBlocks == 0);
+    CHECK(stats.liveBytes == 0);
+    CHECK(stats.requestedBytes == 0);
+    CHECK(stats.cachedBytes == bin_bytes);
+    CHECK(stats.fragmentation() == 0.);
+
+    allocator.free(allocator.allocate(requested, queue));
+    stats = allocator.stats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.hitRate() == doctest::Approx(0.5));
+    CHECK(stats.cachedBytes == bin_bytes);
+  }
+
+  SUBCASE("The configuration is fixed once it has been used") {
+    auto config = clue::getAllocatorConfig();
+    // the placement of the large host buffers depends on the configuration
+    auto buffer = clue::make_host_buffer<std::byte>(4 << 20);
+    CHECK(buffer.data() != nullptr);
+    CHECK_THROWS_AS(clue::setAllocatorConfig(config), std::logic_error);
+  }
 }
@@ -1,6 +1,11 @@
 
 #include "CLUEstering/CLUEstering.hpp"
 
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 using TestApis =
@@ -28,4 +33,85 @@ DOCTEST_TEST_CASE_TEMPLATE("Test validation scores on toy detector dataset",Api,
     CHECK(silhouette >= -1.f);
     CHECK(silhouette <= 1.f);
   }
+  SUBCASE("Test estimation of silhouette score from a sample of points") {
+    const auto silhouette = clue::silhouette(points);
+    const auto estimate = clue::sampled_silhouette(points, 200, 0.99f, 42);
+    CHECK(estimate.samples == 200);
+    CHECK(estimate.error > 0.f);
+    CHECK(std::abs(estimate.score - silhouette) <= estimate.error);
+
+    const auto exact = clue::sampled_silhouette(points, points.size());
+    CHECK(exact.error == 0.f);
+    CHECK(exact.score == doctest::Approx(silhouette));
+  }
+}
+
+TEST_CASE("Test validation scores against the truth labels") {
+  auto device = clue::DevicePool::deviceAt(0u);
+  auto queue = clue::get_queue(device);
+
+  auto dim = clue::Dim<2>{};
+  clue::PointsHost points = clue::read_csv(dim, std::string(TEST_DATA_DIR) + "/data_1024.csv");
+  clue::PointsHost truth =
+      clue::read_output(dim, std::string(TEST_DATA_DIR) + "/truth_files/data_1024_truth.csv");
+  clue::Clusterer clusterer(queue, dim, 1.5f, 10.f, 1.5f);
+  clusterer.make_clusters(queue, points);
+
+  SUBCASE("Test external scores") {
+    const auto self = clue::external_scores(truth, truth);
+    CHECK(self.adjusted_rand_index == doctest::Approx(1.f));
+    CHECK(self.normalized_mutual_information == doctest::Approx(1.f));
+    CHECK(self.purity == doctest::Approx(1.f));
+
+    const auto scores = clue::external_scores(points, truth);
+    CHECK(scores.adjusted_rand_index >= 0.9f);
+    CHECK(scores.normalized_mutual_information >= 0.9f);
+    CHECK(scores.homogeneity >= 0.9f);
+    CHECK(scores.completeness >= 0.9f);
+    CHECK(scores.purity >= 0.9f);
+  }
+  SUBCASE("Test internal scores") {
+    const auto statistics = clue::cluster_statistics(points);
+    const auto davies_bouldin = clue::davies_bouldin(points);
+    CHECK(davies_bouldin > 0.f);
+    CHECK(davies_bouldin ==
+          doctest::Approx(clue::davies_bouldin(
+              points, std::span<const clue::ClusterStatistics<2>>(statistics))));
+    CHECK(clue::calinski_harabasz(points) > 1.f);
+  }
+  SUBCASE("Test Davies-Bouldin index with coincident centroids") {
+    auto statistics = clue::cluster_statistics(points);
+    REQUIRE(statistics.size() >= 2);
+    statistics[1].centroid = statistics[0].centroid;
+    const auto davies_bouldin = clue::davies_bouldin(
+        points, std::span<const clue::ClusterStatistics<2>>(statistics));
+    CHECK(std::isfinite(davies_bouldin));
+    CHECK(davies_bouldin > 0.f);
+  }
+}
+
+TEST_CASE("Test Calinski-Harabasz index with non-uniform weights") {
+  const auto file_path =
+      (std::filesystem::temp_directory_path() / "clue_test_weighted_scores.csv").string();
+  auto write_points = [&](float scale) {
+    std::ofstream file(file_path);
+    file << "x0,x1,weight,cluster_ids\n";
+    file << "0,0," << 1.f * scale << ",0\n";
+    file << "2,0," << 3.f * scale << ",0\n";
+    file << "10,0," << 1.f * scale << ",1\n";
+    file << "10,4," << 1.f * scale << ",1\n";
+  };
+  auto dim = clue::Dim<2>{};
+
+  // the weighted centroids are (1.5, 0) and (10, 2), and the weighted center is (13/3, 2/3),
+  // so the dispersion between the clusters is 915/9 and the one within them is 11
+  write_points(1.f);
+  const auto points = clue::read_output(dim, file_path);
+  const auto index = clue::calinski_harabasz(points);
+  CHECK(index == doctest::Approx(915. / 9. / 11. * (4. - 2.) / (2. - 1.)));
+
+  // scaling all the weights doesn't change the index
+  write_points(2.f);
+  CHECK(clue::calinski_harabasz(clue::read_output(dim, file_path)) == doctest::Approx(index));
+  std::filesystem::remove(file_path);
 }